@@ -0,0 +1,53 @@
+﻿// BattleClock.cpp
+// 战斗时钟实现
+
+#include "BattleClock.h"
+#include <cmath>
+
+BattleClock* BattleClock::_instance = nullptr;
+
+BattleClock* BattleClock::getInstance() {
+    if (!_instance) {
+        _instance = new BattleClock();
+    }
+    return _instance;
+}
+
+void BattleClock::destroyInstance() {
+    if (_instance) {
+        delete _instance;
+        _instance = nullptr;
+    }
+}
+
+void BattleClock::reset() {
+    _tick = 0;
+    _accumulator = 0.0f;
+    _ticksThisFrame = 0;
+}
+
+void BattleClock::accumulate(float frameDelta) {
+    if (frameDelta > 0.0f) {
+        _accumulator += frameDelta;
+    }
+    _ticksThisFrame = 0;
+}
+
+bool BattleClock::consumeTick() {
+    if (_accumulator < TICK_SECONDS) return false;
+
+    // 本帧补帧已达上限：丢弃剩余的整 tick 时间，只保留不足一个 tick 的部分
+    if (_ticksThisFrame >= MAX_TICKS_PER_FRAME) {
+        _accumulator = std::fmod(_accumulator, TICK_SECONDS);
+        return false;
+    }
+
+    _accumulator -= TICK_SECONDS;
+    _ticksThisFrame++;
+    _tick++;
+    return true;
+}
+
+int BattleClock::secondsToTicks(float seconds) {
+    return static_cast<int>(std::lround(seconds * TICK_RATE));
+}
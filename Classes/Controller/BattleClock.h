@@ -0,0 +1,61 @@
+﻿// BattleClock.h
+// 战斗时钟声明：把不定长的帧时间累积为固定步长的逻辑 tick，战斗逻辑和回放都以 tick 计时
+
+#ifndef __BATTLE_CLOCK_H__
+#define __BATTLE_CLOCK_H__
+
+/**
+ * @brief 战斗时钟（单例）
+ *
+ * 每帧调用 accumulate(dt) 累积帧时间，再用 while (consumeTick()) 推进逻辑：
+ * 每次消耗 TICK_SECONDS，累积不足一个 tick 的时间留到下一帧。
+ * 防御冷却、陷阱计时、回放事件都按 tick 计算，与帧率和卡顿无关。
+ *
+ * 卡顿后一帧最多补 MAX_TICKS_PER_FRAME 个 tick，多余的时间直接丢弃
+ * （战斗暂时变慢，而不是越追越卡）。
+ *
+ * 渲染插值：getInterpolationAlpha() 返回累积时间在当前 tick 中的比例 [0, 1)，
+ * 单位精灵每帧按它在上一 tick 和当前 tick 的位置之间插值显示。
+ */
+class BattleClock {
+public:
+    static const int TICK_RATE = 30;
+    static constexpr float TICK_SECONDS = 1.0f / TICK_RATE;
+    static const int MAX_TICKS_PER_FRAME = 5;
+
+    static BattleClock* getInstance();
+    static void destroyInstance();
+
+    // 归零（进入准备/战斗阶段时调用）
+    void reset();
+
+    // 累积一帧的时间
+    void accumulate(float frameDelta);
+
+    // 累积时间够一个 tick 时推进 tick 计数并返回 true
+    bool consumeTick();
+
+    // 已推进的 tick 数（consumeTick 返回 true 后即包含当前 tick）
+    int getTick() const { return _tick; }
+
+    // 已推进的战斗时间（秒）
+    float getElapsedSeconds() const { return _tick * TICK_SECONDS; }
+
+    // 渲染插值比例
+    float getInterpolationAlpha() const { return _accumulator / TICK_SECONDS; }
+
+    // 秒与 tick 换算（四舍五入到最近的 tick）
+    static int secondsToTicks(float seconds);
+
+private:
+    BattleClock() = default;
+    ~BattleClock() = default;
+
+    static BattleClock* _instance;
+
+    int _tick = 0;
+    float _accumulator = 0.0f;
+    int _ticksThisFrame = 0;
+};
+
+#endif // __BATTLE_CLOCK_H__
@@ -4,31 +4,29 @@
 #include "BattleProcessController.h"
 #include "../Layer/BattleTroopLayer.h"
 #include "../Manager/VillageDataManager.h"
+#include "../Manager/BattleNodePool.h"
 #include "../Model/BuildingConfig.h"
+#include "../Model/BattleBuildingState.h"
 #include "../Util/GridMapUtils.h"
 #include "../Util/FindPathUtil.h"
-#include "2d/CCParticleExamples.h"
+#include "../Util/AsyncPathfinder.h"
+#include "../Util/PathPlanningQueue.h"
+#include "../Util/PathSmoothing.h"
+#include <algorithm>
+#include <climits>
 #include <cmath>
-#include <set>
+#include <thread>
 #include "../Sprite/BuildingSprite.h"
 #include "../Component/DefenseBuildingAnimation.h"
-#include "DestructionTracker.h"
 #include "TrapSystem.h"
 #include "TargetFinder.h"
+#include "BattleClock.h"
 
 USING_NS_CC;
 
 BattleProcessController* BattleProcessController::_instance = nullptr;
 
-// 计算路径总长度
-static float calculatePathLength(const std::vector<Vec2>& path) {
-    if (path.size() < 2) return 0.0f;
-    float totalDist = 0.0f;
-    for (size_t i = 0; i < path.size() - 1; ++i) {
-        totalDist += path[i].distance(path[i + 1]);
-    }
-    return totalDist;
-}
+const char* const BattleProcessController::PLANNING_MODE_KEY = "battle_planning_mode";
 
 // 根据兵种类型获取伤害值
 static int getDamageByUnitType(UnitTypeID typeID) {
@@ -67,6 +65,18 @@ static int getAttackRangeByUnitType(UnitTypeID typeID) {
     }
 }
 
+// 根据兵种类型获取溅射半径（格子单位），0 表示单体攻击
+static float getSplashRadiusByUnitType(UnitTypeID typeID) {
+    switch (typeID) {
+        case UnitTypeID::WALL_BREAKER:
+            return TroopConfig::getInstance()->getTroopById(1005).splashRadius;
+        case UnitTypeID::BALLOON:
+            return TroopConfig::getInstance()->getTroopById(1006).splashRadius;
+        default:
+            return 0.0f;
+    }
+}
+
 BattleProcessController* BattleProcessController::getInstance() {
     if (!_instance) {
         _instance = new BattleProcessController();
@@ -81,6 +91,26 @@ void BattleProcessController::destroyInstance() {
     }
 }
 
+BattleProcessController::BattleProcessController()
+    : _planningMode(chooseDefaultPlanningMode())
+    , _nextUnitSerial(0)
+    , _recordingPlans(false)
+    , _replayingPlans(false) {
+}
+
+BattleProcessController::PlanningMode BattleProcessController::chooseDefaultPlanningMode() {
+    std::string setting = UserDefault::getInstance()->getStringForKey(PLANNING_MODE_KEY, "");
+    if (setting == "sync") return PlanningMode::SYNC;
+    if (setting == "async") return PlanningMode::ASYNC;
+    if (setting == "time_sliced") return PlanningMode::TIME_SLICED;
+
+    // 没有空闲硬件线程时工作线程会和主线程抢核心，改在主线程按预算分帧搜索
+    PlanningMode mode = AsyncPathfinder::isSupported() ? PlanningMode::ASYNC : PlanningMode::TIME_SLICED;
+    CCLOG("BattleProcessController: Planning mode %s (hardware threads: %u)",
+          mode == PlanningMode::ASYNC ? "ASYNC" : "TIME_SLICED", std::thread::hardware_concurrency());
+    return mode;
+}
+
 void BattleProcessController::resetBattleState() {
     auto dataManager = VillageDataManager::getInstance();
     auto& buildings = const_cast<std::vector<BuildingInstance>&>(dataManager->getAllBuildings());
@@ -95,460 +125,623 @@ void BattleProcessController::resetBattleState() {
             building.isDestroyed = false;
             restoredCount++;
         }
-
-        // 清除防御建筑的锁定目标
-        building.lockedTarget = nullptr;
-
-        // 重置攻击冷却
-        building.attackCooldown = 0.0f;
     }
 
+    // 血量已恢复，战斗建筑状态（含冷却和锁定目标）下次使用时重建
+    BattleBuildingState::getInstance()->invalidate();
+
     // 清理陷阱触发状态
     TrapSystem::getInstance()->reset();
 
+    // 建筑全部恢复，目标索引需要重建
+    TargetFinder::getInstance()->invalidateIndex();
+
+    // 丢弃尚未返回的异步路线和上一场的单位状态
+    cancelPendingPlans();
+    _agents.clear();
+    _nextUnitSerial = 0;
+    _recordingPlans = false;
+    _recordedPlans.clear();
+    _replayingPlans = false;
+    _replayPlans.clear();
+
     dataManager->saveToFile("village.json");
 }
 
-void BattleProcessController::executeAttack(
-    BattleUnitSprite* unit,
-    BattleTroopLayer* troopLayer,
-    int targetID,
-    bool isForcedTarget,
-    const std::function<void()>& onTargetDestroyed,
-    const std::function<void()>& onContinueAttack
-) {
-    auto dm = VillageDataManager::getInstance();
-    BuildingInstance* liveTarget = dm->getBuildingById(targetID);
+// ===================================================================================
+// 单位登记与状态机
+// ===================================================================================
 
-    // 防止重复处理
-    if (unit->isChangingTarget()) {
+void BattleProcessController::registerUnit(BattleUnitSprite* unit) {
+    if (!unit || unit->getHandle().isNull()) {
         return;
     }
 
-    // 目标已摧毁
-    if (!liveTarget || liveTarget->isDestroyed || liveTarget->currentHP <= 0) {
-        unit->setChangingTarget(true);
-        onTargetDestroyed();
-        
-        unit->runAction(Sequence::create(
-            DelayTime::create(0.1f),
-            CallFunc::create([unit]() {
-                unit->setChangingTarget(false);
-            }),
-            nullptr
-        ));
-        return;
+    TroopHandle handle = unit->getHandle();
+    if (handle.index >= _agents.size()) {
+        _agents.resize(handle.index + 1);
     }
 
-    // 炸弹兵自爆特判
-    if (unit->getUnitTypeID() == UnitTypeID::WALL_BREAKER) {
-        CCLOG("BattleProcessController: Wall Breaker executing suicide attack");
+    // 槽位可能被已移除的单位用过，整体重置
+    TroopAgent& agent = _agents[handle.index];
+    if (agent.planRequestId != 0) {
+        cancelPlanRequest(agent.planRequestId);
+    }
+    agent = TroopAgent();
+    agent.handle = handle;
+    agent.serial = ++_nextUnitSerial;
+    agent.state = TroopState::IDLE;
+    agent.position = unit->getPosition();
+    agent.prevPosition = agent.position;
+}
+
+BattleProcessController::TroopAgent* BattleProcessController::findAgent(const TroopHandle& handle) {
+    if (handle.isNull() || handle.index >= _agents.size()) return nullptr;
+
+    TroopAgent& agent = _agents[handle.index];
+    return agent.handle == handle ? &agent : nullptr;
+}
 
-        performWallBreakerSuicideAttack(unit, liveTarget, troopLayer, [onTargetDestroyed]() {
-            if (onTargetDestroyed) {
-                onTargetDestroyed();
+TroopState BattleProcessController::getTroopState(const TroopHandle& handle) const {
+    if (handle.isNull() || handle.index >= _agents.size()) return TroopState::DEAD;
+
+    const TroopAgent& agent = _agents[handle.index];
+    return agent.handle == handle ? agent.state : TroopState::DEAD;
+}
+
+void BattleProcessController::enterState(TroopAgent& agent, BattleUnitSprite* unit, TroopState state) {
+    if (agent.state == TroopState::PLANNING && state != TroopState::PLANNING && agent.planRequestId != 0) {
+        cancelPlanRequest(agent.planRequestId);
+        agent.planRequestId = 0;
+    }
+    agent.planReady = false;
+    agent.state = state;
+
+    switch (state) {
+        case TroopState::IDLE:
+            // 立即决策；待机动画在找不到目标时才播放，避免切换目标时闪一下
+            agent.cooldown = 0.0f;
+            agent.waypoints.clear();
+            agent.nextWaypoint = 0;
+            break;
+
+        case TroopState::PLANNING:
+            // 等待路线期间保持当前动作：还有路就继续走，否则原地待机
+            if (agent.nextWaypoint >= agent.waypoints.size()) {
+                unit->playIdleAnimation();
             }
-        });
+            break;
 
-        return;
-    }
+        case TroopState::ATTACKING: {
+            agent.waypoints.clear();
+            agent.nextWaypoint = 0;
+            agent.cooldown = ATTACK_INTERVAL;
 
-    // 计算伤害
-    int dps = getDamageByUnitType(unit->getUnitTypeID());
-    
-    // 二次检查
-    if (liveTarget->isDestroyed || liveTarget->currentHP <= 0) {
-        onTargetDestroyed();
-        return;
+            const BuildingInstance* target = findLiveBuilding(agent.targetId);
+            if (target) {
+                unit->playAttackToward(GridMapUtils::gridToPixelCenter(target->gridX, target->gridY));
+            }
+            break;
+        }
+
+        case TroopState::DEAD:
+            agent.waypoints.clear();
+            agent.nextWaypoint = 0;
+            break;
+
+        case TroopState::MOVING:
+            break;
     }
+}
 
-    liveTarget->currentHP -= dps;
+void BattleProcessController::updateTroops(BattleTroopLayer* troopLayer) {
+    if (!troopLayer) return;
 
-    // 目标被摧毁
-    if (liveTarget->currentHP <= 0) {
-        liveTarget->isDestroyed = true;
-        liveTarget->currentHP = 0;
-        
-        FindPathUtil::getInstance()->updatePathfindingMap();
-        
-        // 发送建筑摧毁事件
-        Director::getInstance()->getEventDispatcher()->dispatchCustomEvent(
-            "EVENT_BUILDING_DESTROYED", 
-            static_cast<void*>(liveTarget)
-        );
+    const float dt = BattleClock::TICK_SECONDS;
+    const int tick = BattleClock::getInstance()->getTick();
 
-        // 更新摧毁进度
-        DestructionTracker::getInstance()->updateProgress();
+    for (auto& agent : _agents) {
+        if (agent.handle.isNull()) continue;
 
-        onTargetDestroyed();
-    }
-    else {
-        onContinueAttack();
+        BattleUnitSprite* unit = troopLayer->resolveUnit(agent.handle);
+        if (!unit) {
+            // 单位已从兵种层移除，槽位空出
+            if (agent.planRequestId != 0) {
+                cancelPlanRequest(agent.planRequestId);
+            }
+            agent = TroopAgent();
+            continue;
+        }
+
+        if (agent.state == TroopState::DEAD) continue;
+
+        agent.prevPosition = agent.position;
+
+        // 被防御建筑或陷阱击杀（死亡动画和移除由击杀方负责）
+        if (unit->isDead()) {
+            enterState(agent, unit, TroopState::DEAD);
+            continue;
+        }
+
+        switch (agent.state) {
+            case TroopState::PLANNING:
+                // 回放时录制的路线要等到录制时生效的 tick
+                if (agent.planReady && tick >= agent.planDueTick) {
+                    FindPathUtil::WallBreakPlan plan;
+                    plan.path.swap(agent.plan.path);
+                    plan.totalCost = agent.plan.totalCost;
+                    plan.wallBuildingId = agent.plan.wallBuildingId;
+                    plan.wallGridX = agent.plan.wallGridX;
+                    plan.wallGridY = agent.plan.wallGridY;
+                    bool found = agent.planFound;
+
+                    agent.planRequestId = 0;
+                    agent.planReady = false;
+                    commitPlan(agent, unit, found, plan);
+                } else if (agent.nextWaypoint < agent.waypoints.size()) {
+                    // 等待期间保持当前动作
+                    if (advanceAlongPath(agent, unit, dt)) {
+                        unit->playIdleAnimation();
+                    }
+                }
+                break;
+
+            case TroopState::MOVING:
+                if (advanceAlongPath(agent, unit, dt)) {
+                    onArrived(agent, unit);
+                }
+                break;
+
+            case TroopState::ATTACKING:
+                updateAttack(agent, unit, troopLayer, dt);
+                break;
+
+            default:
+                break;
+        }
+
+        // 目标丢失或摧毁后同一 tick 内重新决策
+        if (agent.state == TroopState::IDLE) {
+            agent.cooldown -= dt;
+            if (agent.cooldown <= 0.0f) {
+                decide(agent, unit);
+            }
+        }
+
+        // 地面单位进入新格子时才检查陷阱（气球兵飞行，不会触发）
+        if (agent.state != TroopState::DEAD && unit->takeCellChange() &&
+            unit->getUnitTypeID() != UnitTypeID::BALLOON) {
+            TrapSystem::getInstance()->onUnitEnteredCell(unit->getCellX(), unit->getCellY());
+        }
+
+        agent.position = unit->getPosition();
     }
 }
 
-bool BattleProcessController::shouldAbandonWallForBetterPath(BattleUnitSprite* unit, int currentWallID) {
-    Vec2 unitPos = unit->getPosition();
-    Vec2 unitGridPos = GridMapUtils::pixelToGrid(unitPos);
-    
-    CCLOG("--- shouldAbandonWallForBetterPath DEBUG ---");
-    CCLOG("  Unit at pixel(%.1f, %.1f), grid(%.1f, %.1f)", 
-          unitPos.x, unitPos.y, unitGridPos.x, unitGridPos.y);
-    CCLOG("  Current wall ID: %d", currentWallID);
-    
-    const BuildingInstance* bestTarget = nullptr;
-    // 使用TargetFinder查找最佳目标
-    bestTarget = TargetFinder::getInstance()->findTarget(unitPos, unit->getUnitTypeID());
-    
-    if (!bestTarget) {
-        CCLOG("  No best target found, keep attacking wall");
-        return false;
-    }
-    
-    CCLOG("  Best target: ID=%d, Type=%d at grid(%d, %d)",
-          bestTarget->id, bestTarget->type, bestTarget->gridX, bestTarget->gridY);
-    
-    Vec2 targetCenter = GridMapUtils::gridToPixelCenter(bestTarget->gridX, bestTarget->gridY);
-    
-    auto pathfinder = FindPathUtil::getInstance();
-    int attackRange = getAttackRangeByUnitType(unit->getUnitTypeID());
-    std::vector<Vec2> pathAround = pathfinder->findPathToAttackBuilding(unitPos, *bestTarget, attackRange);
-    
-    if (pathAround.empty()) {
-        CCLOG("  No path around found, keep attacking wall");
-        return false;
-    }
-    
-    float pathLength = calculatePathLength(pathAround);
-    float directDist = unitPos.distance(targetCenter);
-    float detourCost = pathLength - directDist;
-    
-    CCLOG("  Path analysis:");
-    CCLOG("    Path length: %.1f", pathLength);
-    CCLOG("    Direct distance: %.1f", directDist);
-    CCLOG("    Detour cost: %.1f (threshold: %.1f)", detourCost, PIXEL_DETOUR_THRESHOLD);
-    CCLOG("    Path/Direct ratio: %.2f (max allowed: 2.0)", pathLength / directDist);
-    
-    if (detourCost <= PIXEL_DETOUR_THRESHOLD && pathLength <= directDist * 2.0f) {
-        CCLOG("  ✓ ABANDON WALL - better path found!");
-        return true;
+void BattleProcessController::restoreTickPositions(BattleTroopLayer* troopLayer) {
+    if (!troopLayer) return;
+
+    for (const auto& agent : _agents) {
+        if (agent.handle.isNull() || agent.state == TroopState::DEAD) continue;
+
+        BattleUnitSprite* unit = troopLayer->resolveUnit(agent.handle);
+        if (unit && !unit->isDead()) {
+            unit->setPosition(agent.position);
+        }
     }
-    
-    CCLOG("  ✗ Keep attacking wall - no better path");
-    CCLOG("--- END shouldAbandonWallForBetterPath ---");
-    return false;
 }
 
-void BattleProcessController::startUnitAI(BattleUnitSprite* unit, BattleTroopLayer* troopLayer) {
-    if (!unit) {
-        return;
+void BattleProcessController::interpolatePositions(BattleTroopLayer* troopLayer, float alpha) {
+    if (!troopLayer) return;
+
+    for (const auto& agent : _agents) {
+        if (agent.handle.isNull() || agent.state == TroopState::DEAD) continue;
+
+        // 本 tick 阵亡的单位停在逻辑位置播放死亡动画
+        BattleUnitSprite* unit = troopLayer->resolveUnit(agent.handle);
+        if (unit && !unit->isDead()) {
+            unit->setPosition(agent.prevPosition.lerp(agent.position, alpha));
+        }
     }
+}
+
+// ===================================================================================
+// 决策与路线
+// ===================================================================================
 
+void BattleProcessController::decide(TroopAgent& agent, BattleUnitSprite* unit) {
     Vec2 unitPos = unit->getPosition();
-    Vec2 unitGridPos = GridMapUtils::pixelToGrid(unitPos);
-    
-    CCLOG("========== START UNIT AI DEBUG ==========");
-    CCLOG("Unit: %s at pixel(%.1f, %.1f), grid(%.1f, %.1f)",
-          unit->getUnitType().c_str(), unitPos.x, unitPos.y, unitGridPos.x, unitGridPos.y);
-    
+    UnitTypeID typeID = unit->getUnitTypeID();
+
     const BuildingInstance* target = nullptr;
-    
-    // 炸弹兵特殊处理：只攻击城墙
     auto targetFinder = TargetFinder::getInstance();
-    
-    if (unit->getUnitTypeID() == UnitTypeID::WALL_BREAKER) {
+
+    // 炸弹兵特殊处理：只攻击城墙
+    if (typeID == UnitTypeID::WALL_BREAKER) {
         target = targetFinder->findNearestWall(unitPos);
-        if (!target) {
-            CCLOG("Wall Breaker: No walls found, standing idle");
-            unit->playIdleAnimation();
-            return;  // 没有城墙则原地待机
-        }
     }
     else {
-        // 使用TargetFinder的通用入口
-        target = targetFinder->findTarget(unitPos, unit->getUnitTypeID());
+        target = targetFinder->findTarget(unitPos, typeID);
     }
 
     if (!target) {
-        CCLOG("No target found, playing idle animation");
-        unit->playIdleAnimation();
+        // 原地待机，稍后再找（已在待机时不重复切换动画）
+        if (agent.targetId != 0 || !unit->isAnimating()) {
+            unit->playIdleAnimation();
+        }
+        agent.targetId = 0;
+        agent.cooldown = RETHINK_INTERVAL;
         return;
     }
 
-    CCLOG("Target selected: ID=%d, Type=%d at grid(%d, %d)",
-          target->id, target->type, target->gridX, target->gridY);
+    CCLOG("BattleProcessController: %s targets building ID=%d, Type=%d at grid(%d, %d)",
+          unit->getUnitType().c_str(), target->id, target->type, target->gridX, target->gridY);
 
     // 发送目标锁定事件
     EventCustom event("EVENT_UNIT_TARGET_LOCKED");
     event.setUserData(reinterpret_cast<void*>(static_cast<intptr_t>(target->id)));
     Director::getInstance()->getEventDispatcher()->dispatchEvent(&event);
 
-    auto pathfinder = FindPathUtil::getInstance();
-    Vec2 targetCenter = GridMapUtils::gridToPixelCenter(target->gridX, target->gridY);
+    agent.targetId = target->id;
+    agent.wallTarget = false;
 
-    int attackRange = getAttackRangeByUnitType(unit->getUnitTypeID());
-    CCLOG("Attack range: %d grids", attackRange);
-    
-    // 气球兵飞行单位特殊处理
-    if (unit->getUnitTypeID() == UnitTypeID::BALLOON) {
-        // 计算建筑边缘攻击位置
+    int attackRange = getAttackRangeByUnitType(typeID);
+
+    // 气球兵飞行单位特殊处理：直线飞到建筑边缘
+    if (typeID == UnitTypeID::BALLOON) {
         auto config = BuildingConfig::getInstance()->getConfig(target->type);
         int buildingWidth = config ? config->gridWidth : 2;
         int buildingHeight = config ? config->gridHeight : 2;
-        
+
         // 计算建筑中心
         float buildingCenterX = target->gridX + buildingWidth / 2.0f;
         float buildingCenterY = target->gridY + buildingHeight / 2.0f;
         Vec2 buildingCenter = GridMapUtils::gridToPixelCenter(
-            static_cast<int>(buildingCenterX), 
+            static_cast<int>(buildingCenterX),
             static_cast<int>(buildingCenterY)
         );
-        
+
         // 计算从气球到建筑中心的方向
         Vec2 direction = buildingCenter - unitPos;
         direction.normalize();
-        
+
         // 计算建筑边缘攻击点
         float attackDistancePixels = (attackRange + buildingWidth / 2.0f) * 32.0f;
         Vec2 attackPosition = buildingCenter - direction * attackDistancePixels;
-        
+
         // 如果攻击位置更远，直接飞到建筑中心
         if (unitPos.distance(attackPosition) > unitPos.distance(buildingCenter)) {
             attackPosition = buildingCenter;
         }
-        
-        std::vector<Vec2> directPath = { attackPosition };
-        unit->followPath(directPath, 100.0f, [this, unit, troopLayer]() {
-            startCombatLoop(unit, troopLayer);
-        });
+
+        startMoving(agent, unit, std::vector<Vec2>(1, attackPosition));
         return;
     }
-    
-    std::vector<Vec2> pathAround = pathfinder->findPathToAttackBuilding(unitPos, *target, attackRange);
-    float distAround = calculatePathLength(pathAround);
-    float distDirect = unitPos.distance(targetCenter);
-
-    CCLOG("Path finding result: pathAround.size()=%zu, distAround=%.1f, distDirect=%.1f",
-          pathAround.size(), distAround, distDirect);
-
-    if (!pathAround.empty()) {
-        float detourCost = distAround - distDirect;
-        
-        CCLOG("Detour cost: %.1f (threshold=%.1f)", detourCost, PIXEL_DETOUR_THRESHOLD);
-        
-        if (detourCost <= PIXEL_DETOUR_THRESHOLD && distAround <= distDirect * 2.0f) {
-            CCLOG("✓ Using path around (detour acceptable)");
-            unit->followPath(pathAround, 100.0f, [this, unit, troopLayer]() {
-                startCombatLoop(unit, troopLayer);
-            });
-            return;
-        } else {
-            CCLOG("✗ Path around too long, will check for wall to break");
-        }
+
+    // 炸弹兵的目标本身就是城墙，直接锁定
+    if (typeID == UnitTypeID::WALL_BREAKER) {
+        agent.wallTarget = true;
+        onArrived(agent, unit);
+        return;
+    }
+
+    // 城墙按打穿所需时间折算为通行代价，一次搜索同时比较绕路和破墙
+    requestAttackPlan(agent, unit, target, attackRange);
+}
+
+void BattleProcessController::setPlanningMode(PlanningMode mode) {
+    if (_planningMode == mode) return;
+    cancelPendingPlans();
+    _planningMode = mode;
+}
+
+void BattleProcessController::requestAttackPlan(TroopAgent& agent, BattleUnitSprite* unit,
+                                                const BuildingInstance* target, int attackRange) {
+    agent.planSeq++;
+    if (_replayingPlans) {
+        requestReplayPlan(agent, unit);
+        return;
+    }
+
+    Vec2 unitPos = unit->getPosition();
+    int damagePerHit = getDamageByUnitType(unit->getUnitTypeID());
+
+    if (_planningMode == PlanningMode::SYNC) {
+        FindPathUtil::WallBreakPlan plan;
+        bool found = FindPathUtil::getInstance()->planPathWithWallBreaking(unitPos, *target, attackRange, damagePerHit, plan);
+        commitPlan(agent, unit, found, plan);
+        return;
+    }
+
+    // 回调只按句柄记录结果，单位阵亡或移除后请求会被取消
+    TroopHandle handle = agent.handle;
+    FindPathUtil::AttackPlanCallback callback =
+        [this, handle](bool found, const FindPathUtil::WallBreakPlan& plan) {
+            onPlanReady(handle, found, plan);
+        };
+
+    int requestId = 0;
+    if (_planningMode == PlanningMode::TIME_SLICED) {
+        requestId = PathPlanningQueue::getInstance()->enqueueAttackPlan(unitPos, *target, attackRange, damagePerHit, callback);
     } else {
-        CCLOG("No valid path around found, will check for wall to break");
+        requestId = AsyncPathfinder::getInstance()->requestAttackPlan(unitPos, *target, attackRange, damagePerHit, callback);
     }
 
-    const BuildingInstance* wallToBreak = getFirstWallInLine(unitPos, targetCenter);
+    if (requestId == 0) {
+        commitPlan(agent, unit, false, FindPathUtil::WallBreakPlan());
+        return;
+    }
 
-    if (wallToBreak && unit->getUnitTypeID() != UnitTypeID::BALLOON) {
-        CCLOG("Wall to break found: ID=%d at grid(%d, %d)", 
-              wallToBreak->id, wallToBreak->gridX, wallToBreak->gridY);
-        
-        std::vector<Vec2> pathToWall = pathfinder->findPathToAttackBuilding(unitPos, *wallToBreak, attackRange);
-        CCLOG("Path to wall: size=%zu", pathToWall.size());
+    enterState(agent, unit, TroopState::PLANNING);
+    agent.planRequestId = requestId;
+    agent.planDueTick = 0;
+}
 
-        if (pathToWall.empty()) {
-            CCLOG("No path to wall, starting forced combat directly");
-            startCombatLoopWithForcedTarget(unit, troopLayer, wallToBreak);
-        }
-        else {
-            CCLOG("Following path to wall");
-            unit->followPath(pathToWall, 100.0f, [this, unit, troopLayer, wallToBreak]() {
-                startCombatLoopWithForcedTarget(unit, troopLayer, wallToBreak);
-            });
+void BattleProcessController::requestReplayPlan(TroopAgent& agent, BattleUnitSprite* unit) {
+    enterState(agent, unit, TroopState::PLANNING);
+
+    auto it = _replayPlans.find(std::make_pair(agent.serial, agent.planSeq));
+    if (it == _replayPlans.end()) {
+        // 录制时这条路线没有生效（单位在等待中阵亡或战斗结束），同样一直等待
+        agent.planDueTick = INT_MAX;
+        return;
+    }
+
+    const AttackPlanEvent& event = it->second;
+    FindPathUtil::WallBreakPlan plan;
+    plan.totalCost = event.totalCost;
+    plan.wallBuildingId = event.wallBuildingId;
+    plan.wallGridX = event.wallGridX;
+    plan.wallGridY = event.wallGridY;
+    for (size_t k = 0; k + 1 < event.pathCells.size(); k += 2) {
+        plan.path.push_back(GridMapUtils::gridToPixelCenter(event.pathCells[k], event.pathCells[k + 1]));
+    }
+
+    // 录制时同步规划的路线在请求的 tick 当即生效
+    if (event.tick <= BattleClock::getInstance()->getTick()) {
+        commitPlan(agent, unit, event.found, plan);
+        return;
+    }
+
+    agent.planReady = true;
+    agent.planFound = event.found;
+    agent.plan = plan;
+    agent.planDueTick = event.tick;
+}
+
+void BattleProcessController::commitPlan(TroopAgent& agent, BattleUnitSprite* unit,
+                                         bool planned, const FindPathUtil::WallBreakPlan& plan) {
+    if (_recordingPlans) {
+        AttackPlanEvent event;
+        event.tick = BattleClock::getInstance()->getTick();
+        event.unitSerial = agent.serial;
+        event.planSeq = agent.planSeq;
+        event.found = planned;
+        event.totalCost = plan.totalCost;
+        event.wallBuildingId = plan.wallBuildingId;
+        event.wallGridX = plan.wallGridX;
+        event.wallGridY = plan.wallGridY;
+
+        // 路径点都在格子中心，按格记录可以无损还原
+        for (const Vec2& waypoint : plan.path) {
+            Vec2 gridPos = GridMapUtils::pixelToGrid(waypoint);
+            event.pathCells.push_back(static_cast<int>(std::floor(gridPos.x)));
+            event.pathCells.push_back(static_cast<int>(std::floor(gridPos.y)));
         }
+        _recordedPlans.push_back(event);
     }
-    else {
-        CCLOG("⚠️ NO WALL FOUND in line! Going direct to target (may pass through walls!)");
-        CCLOG("  Unit pos: (%.1f, %.1f)", unitPos.x, unitPos.y);
-        CCLOG("  Target center: (%.1f, %.1f)", targetCenter.x, targetCenter.y);
-        
-        std::vector<Vec2> directPath = { targetCenter };
-        unit->followPath(directPath, 100.0f, [this, unit, troopLayer]() {
-            startCombatLoop(unit, troopLayer);
-        });
+
+    applyAttackPlan(agent, unit, planned, plan);
+}
+
+void BattleProcessController::beginPlanRecording() {
+    _nextUnitSerial = 0;
+    _recordingPlans = true;
+    _recordedPlans.clear();
+    _replayingPlans = false;
+    _replayPlans.clear();
+}
+
+void BattleProcessController::endPlanRecording(std::vector<AttackPlanEvent>& outEvents) {
+    _recordingPlans = false;
+    outEvents.swap(_recordedPlans);
+    _recordedPlans.clear();
+}
+
+void BattleProcessController::beginPlanReplay(const std::vector<AttackPlanEvent>& events) {
+    _nextUnitSerial = 0;
+    _recordingPlans = false;
+    _recordedPlans.clear();
+    _replayPlans.clear();
+    for (const auto& event : events) {
+        _replayPlans[std::make_pair(event.unitSerial, event.planSeq)] = event;
     }
-    
-    CCLOG("========== END UNIT AI DEBUG ==========\n");
+
+    // 旧回放没有路线记录，仍按当前规划方式重新规划
+    _replayingPlans = !_replayPlans.empty();
+    CCLOG("BattleProcessController: Replaying %zu recorded plans", _replayPlans.size());
 }
 
-const BuildingInstance* BattleProcessController::getFirstWallInLine(const Vec2& startPixel, const Vec2& endPixel) {
-    auto dataManager = VillageDataManager::getInstance();
-    auto pathfinder = FindPathUtil::getInstance();
+void BattleProcessController::onPlanReady(const TroopHandle& handle, bool found, const FindPathUtil::WallBreakPlan& plan) {
+    TroopAgent* agent = findAgent(handle);
+    if (!agent || agent->state != TroopState::PLANNING) return;
 
-    CCLOG("--- getFirstWallInLine DEBUG ---");
-    CCLOG("  Start pixel: (%.1f, %.1f)", startPixel.x, startPixel.y);
-    CCLOG("  End pixel: (%.1f, %.1f)", endPixel.x, endPixel.y);
-    
-    Vec2 startGridF = GridMapUtils::pixelToGrid(startPixel);
-    Vec2 endGridF = GridMapUtils::pixelToGrid(endPixel);
-    CCLOG("  Start grid: (%.1f, %.1f)", startGridF.x, startGridF.y);
-    CCLOG("  End grid: (%.1f, %.1f)", endGridF.x, endGridF.y);
-
-    // 方法1：使用寻路器找穿墙路径
-    std::vector<Vec2> throughPath = pathfinder->findPathIgnoringWalls(startPixel, endPixel);
-    CCLOG("  findPathIgnoringWalls returned %zu points", throughPath.size());
-    
-    if (!throughPath.empty()) {
-        for (size_t i = 0; i < throughPath.size(); ++i) {
-            const auto& worldPt = throughPath[i];
-            Vec2 gridF = GridMapUtils::pixelToGrid(worldPt);
-            int gx = static_cast<int>(std::floor(gridF.x + 0.5f));
-            int gy = static_cast<int>(std::floor(gridF.y + 0.5f));
-
-            BuildingInstance* b = dataManager->getBuildingAtGrid(gx, gy);
-            if (b) {
-                CCLOG("    Path point %zu: grid(%d, %d) has building ID=%d, type=%d, destroyed=%s",
-                      i, gx, gy, b->id, b->type, b->isDestroyed ? "true" : "false");
-                      
-                if (b->type == 303 && !b->isDestroyed && b->currentHP > 0) {
-                    CCLOG("  ✓ Found wall at grid(%d, %d)!", gx, gy);
-                    return b;
-                }
-            }
+    agent->planReady = true;
+    agent->planFound = found;
+    agent->plan = plan;
+}
+
+void BattleProcessController::cancelPendingPlans() {
+    for (auto& agent : _agents) {
+        if (agent.planRequestId == 0) continue;
+
+        cancelPlanRequest(agent.planRequestId);
+        agent.planRequestId = 0;
+        agent.planReady = false;
+        if (agent.state == TroopState::PLANNING) {
+            agent.state = TroopState::IDLE;
+            agent.cooldown = 0.0f;
         }
     }
+}
 
-    CCLOG("  No wall found via pathfinder, trying enhanced line scan...");
-    
-    // 方法2：线性扫描，使用更多采样点
-    Vec2 startGrid = GridMapUtils::pixelToGrid(startPixel);
-    Vec2 endGrid = GridMapUtils::pixelToGrid(endPixel);
-    Vec2 diff = endGrid - startGrid;
-    
-    // 使用更细步长确保检测到每个格子
-    float maxDiff = std::max(std::abs(diff.x), std::abs(diff.y));
-    int steps = static_cast<int>(std::ceil(maxDiff)) * 2;
-    if (steps < 1) steps = 1;
-    
-    CCLOG("  Enhanced line scan: %d steps from grid(%.1f, %.1f) to grid(%.1f, %.1f)",
-          steps, startGrid.x, startGrid.y, endGrid.x, endGrid.y);
-    
-    Vec2 direction = diff / static_cast<float>(steps);
-    Vec2 current = startGrid;
-    
-    // 避免重复检测同一格子
-    std::set<std::pair<int, int>> checkedGrids;
-    
-    for (int i = 0; i <= steps; ++i) {
-        int gx = static_cast<int>(std::floor(current.x));
-        int gy = static_cast<int>(std::floor(current.y));
-        
-        auto gridKey = std::make_pair(gx, gy);
-        if (checkedGrids.find(gridKey) == checkedGrids.end()) {
-            checkedGrids.insert(gridKey);
-
-            BuildingInstance* b = dataManager->getBuildingAtGrid(gx, gy);
-            if (b) {
-                CCLOG("    Step %d: grid(%d, %d) has building ID=%d, type=%d",
-                      i, gx, gy, b->id, b->type);
-                      
-                if (b->type == 303 && !b->isDestroyed && b->currentHP > 0) {
-                    CCLOG("  ✓ Found wall at grid(%d, %d) via line scan!", gx, gy);
-                    return b;
-                }
-            }
+void BattleProcessController::cancelPlanRequest(int requestId) {
+    if (_planningMode == PlanningMode::TIME_SLICED) {
+        PathPlanningQueue::getInstance()->cancel(requestId);
+    } else if (_planningMode == PlanningMode::ASYNC) {
+        AsyncPathfinder::getInstance()->cancel(requestId);
+    }
+}
+
+void BattleProcessController::applyAttackPlan(TroopAgent& agent, BattleUnitSprite* unit,
+                                              bool planned, const FindPathUtil::WallBreakPlan& plan) {
+    // 异步路线返回时目标可能已被其他单位摧毁
+    const BuildingInstance* target = findLiveBuilding(agent.targetId);
+    if (!target) {
+        enterState(agent, unit, TroopState::IDLE);
+        return;
+    }
+
+    CCLOG("Wall-breaking plan: %s, path.size()=%zu, cost=%d, first wall ID=%d",
+          planned ? "ok" : "failed", plan.path.size(), plan.totalCost, plan.wallBuildingId);
+
+    if (planned && plan.wallBuildingId != 0) {
+        const BuildingInstance* wallToBreak = findLiveBuilding(plan.wallBuildingId);
+        if (!wallToBreak) {
+            // 规划后城墙已被打穿，重新规划
+            enterState(agent, unit, TroopState::IDLE);
+            return;
         }
-        current += direction;
+
+        // 先走到第一堵墙并锁定它
+        agent.targetId = wallToBreak->id;
+        agent.wallTarget = true;
+        startMoving(agent, unit, plan.path);
     }
-    
-    // 方法3：遍历所有城墙检查路径交叉
-    CCLOG("  Line scan failed, checking all walls for intersection...");
-    const auto& buildings = dataManager->getAllBuildings();
-    
-    for (const auto& building : buildings) {
-        if (building.type != 303) continue;
-        if (building.isDestroyed || building.currentHP <= 0) continue;
-        
-        int wallX = building.gridX;
-        int wallY = building.gridY;
-        
-        // 计算城墙是否在路径包围盒内
-        int minX = static_cast<int>(std::min(startGrid.x, endGrid.x)) - 1;
-        int maxX = static_cast<int>(std::max(startGrid.x, endGrid.x)) + 1;
-        int minY = static_cast<int>(std::min(startGrid.y, endGrid.y)) - 1;
-        int maxY = static_cast<int>(std::max(startGrid.y, endGrid.y)) + 1;
-        
-        if (wallX >= minX && wallX <= maxX && wallY >= minY && wallY <= maxY) {
-            // 使用点到线段距离判断城墙是否在路径上
-            Vec2 wallPos(wallX + 0.5f, wallY + 0.5f);
-            Vec2 lineDir = endGrid - startGrid;
-            float lineLen = lineDir.length();
-            
-            if (lineLen > 0.01f) {
-                lineDir.normalize();
-                Vec2 toWall = wallPos - startGrid;
-                float proj = toWall.dot(lineDir);
-                
-                // 检查投影点是否在线段范围内
-                if (proj >= 0 && proj <= lineLen) {
-                    Vec2 projPoint = startGrid + lineDir * proj;
-                    float dist = wallPos.distance(projPoint);
-                    
-                    // 距离小于1.5格认为城墙在路径上
-                    if (dist < 1.5f) {
-                        CCLOG("  ✓ Found wall ID=%d at grid(%d, %d) via intersection check! (dist=%.2f)",
-                              building.id, wallX, wallY, dist);
-                        return &building;
-                    }
-                }
-            }
+    else if (planned) {
+        // 绕路（没有值得打穿的墙）
+        agent.wallTarget = false;
+        startMoving(agent, unit, plan.path);
+    }
+    else {
+        CCLOG("⚠️ NO ROUTE FOUND! Going direct to target (may pass through walls!)");
+        agent.wallTarget = false;
+        startMoving(agent, unit, std::vector<Vec2>(1, GridMapUtils::gridToPixelCenter(target->gridX, target->gridY)));
+    }
+}
+
+// ===================================================================================
+// 移动
+// ===================================================================================
+
+void BattleProcessController::startMoving(TroopAgent& agent, BattleUnitSprite* unit, const std::vector<Vec2>& path) {
+    enterState(agent, unit, TroopState::MOVING);
+    agent.waypoints = path;
+    agent.nextWaypoint = 0;
+
+    // 路线从请求时的位置出发，等待期间单位可能已沿旧路线走开：
+    // 当前位置到下一个路径点不比该路径点更远、且两者之间直线不穿过障碍（不破墙）时跳过它，
+    // 直接从当前位置接上，不走回头路
+    Vec2 position = unit->getPosition();
+    Vec2 grid = GridMapUtils::pixelToGrid(position);
+    int cellX = static_cast<int>(std::floor(grid.x));
+    int cellY = static_cast<int>(std::floor(grid.y));
+    PathGridView gridView = FindPathUtil::getInstance()->getGridView();
+
+    while (agent.nextWaypoint + 1 < path.size()) {
+        const Vec2& next = path[agent.nextWaypoint + 1];
+        if (position.distanceSquared(next) > path[agent.nextWaypoint].distanceSquared(next)) break;
+
+        Vec2 nextGrid = GridMapUtils::pixelToGrid(next);
+        if (!PathSmoothing::hasLineOfSight(gridView, cellX, cellY,
+                                           static_cast<int>(std::floor(nextGrid.x)),
+                                           static_cast<int>(std::floor(nextGrid.y)), false)) {
+            break;
         }
+        agent.nextWaypoint++;
     }
 
-    CCLOG("  ✗ NO WALL FOUND in line between unit and target!");
-    CCLOG("--- END getFirstWallInLine ---");
-    return nullptr;
+    if (path.empty()) {
+        onArrived(agent, unit);
+    }
 }
 
-void BattleProcessController::startCombatLoop(BattleUnitSprite* unit, BattleTroopLayer* troopLayer) {
-    if (!unit || !troopLayer) return;
+bool BattleProcessController::advanceAlongPath(TroopAgent& agent, BattleUnitSprite* unit, float dt) {
+    Vec2 position = unit->getPosition();
+    float remaining = MOVE_SPEED * dt;
 
-    Vec2 unitPos = unit->getPosition();
-    auto dm = VillageDataManager::getInstance();
-    const BuildingInstance* target = TargetFinder::getInstance()->findTarget(unitPos, unit->getUnitTypeID());
+    while (agent.nextWaypoint < agent.waypoints.size()) {
+        const Vec2& waypoint = agent.waypoints[agent.nextWaypoint];
+        Vec2 delta = waypoint - position;
+        float distance = delta.length();
+
+        if (distance > remaining) {
+            unit->faceWalkDirection(delta);
+            position += delta * (remaining / distance);
+            break;
+        }
 
+        // 本 tick 内到达该路径点，剩余距离接着走下一段
+        position = waypoint;
+        remaining -= distance;
+        agent.nextWaypoint++;
+    }
+
+    unit->setPosition(position);
+    return agent.nextWaypoint >= agent.waypoints.size();
+}
+
+void BattleProcessController::onArrived(TroopAgent& agent, BattleUnitSprite* unit) {
+    BuildingInstance* target = findLiveBuilding(agent.targetId);
     if (!target) {
-        unit->playIdleAnimation();
+        enterState(agent, unit, TroopState::IDLE);
         return;
     }
 
-    BuildingInstance* mutableTarget = dm->getBuildingById(target->id);
-    if (!mutableTarget || mutableTarget->isDestroyed || mutableTarget->currentHP <= 0) {
-        startUnitAI(unit, troopLayer);
+    if (isInAttackRange(unit, *target)) {
+        enterState(agent, unit, TroopState::ATTACKING);
         return;
     }
 
-    auto config = BuildingConfig::getInstance()->getConfig(mutableTarget->type);
-    if (!config) {
-        startUnitAI(unit, troopLayer);
+    if (!agent.wallTarget) {
+        // 路线终点不在范围内（目标附近地形已变化），重新决策
+        enterState(agent, unit, TroopState::IDLE);
         return;
     }
 
-    Vec2 unitGridPos = GridMapUtils::pixelToGrid(unitPos);
-    int unitGridX = static_cast<int>(std::floor(unitGridPos.x));
-    int unitGridY = static_cast<int>(std::floor(unitGridPos.y));
+    // 锁定的城墙还够不着：先走到它的攻击范围
+    Vec2 unitPos = unit->getPosition();
+    int attackRange = getAttackRangeByUnitType(unit->getUnitTypeID());
+    std::vector<Vec2> path = FindPathUtil::getInstance()->findPathToAttackBuilding(unitPos, *target, attackRange);
+    if (path.empty()) {
+        path.push_back(GridMapUtils::gridToPixelCenter(target->gridX, target->gridY));
+    }
+
+    enterState(agent, unit, TroopState::MOVING);
+    agent.waypoints.swap(path);
+    agent.nextWaypoint = 0;
+}
+
+bool BattleProcessController::isInAttackRange(BattleUnitSprite* unit, const BuildingInstance& target) const {
+    auto config = BuildingConfig::getInstance()->getConfig(target.type);
+    if (!config) return false;
 
-    int bX = mutableTarget->gridX;
-    int bY = mutableTarget->gridY;
+    Vec2 unitPos = unit->getPosition();
+    int bX = target.gridX;
+    int bY = target.gridY;
     int bW = config->gridWidth;
     int bH = config->gridHeight;
 
-    CCLOG("--- startCombatLoop DEBUG ---");
-    CCLOG("  Unit %s at grid(%d, %d)", unit->getUnitType().c_str(), unitGridX, unitGridY);
-    CCLOG("  Target ID=%d Type=%d at grid(%d, %d), size(%d x %d)",
-          mutableTarget->id, mutableTarget->type, bX, bY, bW, bH);
+    // 气球兵使用像素距离判定
+    if (unit->getUnitTypeID() == UnitTypeID::BALLOON) {
+        Vec2 buildingCenter = GridMapUtils::gridToPixelCenter(bX + bW / 2, bY + bH / 2);
+        float maxAttackDistance = (std::max(bW, bH) + 1) * 32.0f;
+        return unitPos.distance(buildingCenter) <= maxAttackDistance;
+    }
+
+    Vec2 unitGridPos = GridMapUtils::pixelToGrid(unitPos);
+    int unitGridX = static_cast<int>(std::floor(unitGridPos.x));
+    int unitGridY = static_cast<int>(std::floor(unitGridPos.y));
 
     // 计算到建筑的网格距离
     int gridDistX = 0;
@@ -566,156 +759,192 @@ void BattleProcessController::startCombatLoop(BattleUnitSprite* unit, BattleTroo
         gridDistY = unitGridY - (bY + bH - 1);
     }
 
-    int gridDistance = std::max(gridDistX, gridDistY);
-    int attackRangeGrid = getAttackRangeByUnitType(unit->getUnitTypeID());
+    return std::max(gridDistX, gridDistY) <= getAttackRangeByUnitType(unit->getUnitTypeID());
+}
 
-    CCLOG("  Distance: X=%d, Y=%d, Max=%d, AttackRange=%d",
-          gridDistX, gridDistY, gridDistance, attackRangeGrid);
+// ===================================================================================
+// 攻击
+// ===================================================================================
 
-    // 气球兵使用像素距离判定
-    if (unit->getUnitTypeID() == UnitTypeID::BALLOON) {
-        Vec2 buildingCenter = GridMapUtils::gridToPixelCenter(
-            bX + bW / 2,
-            bY + bH / 2
-        );
-        float pixelDistance = unitPos.distance(buildingCenter);
-        float maxAttackDistance = (std::max(bW, bH) + 1) * 32.0f;
+void BattleProcessController::updateAttack(TroopAgent& agent, BattleUnitSprite* unit,
+                                           BattleTroopLayer* troopLayer, float dt) {
+    BuildingInstance* target = findLiveBuilding(agent.targetId);
 
-        if (pixelDistance > maxAttackDistance) {
-            CCLOG("  Balloon too far (%.1f > %.1f), restarting AI", pixelDistance, maxAttackDistance);
-            startUnitAI(unit, troopLayer);
-            return;
-        }
-    } else if (gridDistance > attackRangeGrid) {
-        CCLOG("  Out of range (%d > %d), restarting AI", gridDistance, attackRangeGrid);
-        startUnitAI(unit, troopLayer);
+    // 目标已被其他单位摧毁
+    if (!target) {
+        enterState(agent, unit, TroopState::IDLE);
         return;
     }
 
-    CCLOG("  ✓ In range, attacking target!");
-    CCLOG("--- END startCombatLoop ---");
+    agent.cooldown -= dt;
+    if (agent.cooldown > 0.0f) return;
 
-    // 执行攻击
-    Vec2 buildingPos = GridMapUtils::gridToPixelCenter(mutableTarget->gridX, mutableTarget->gridY);
-    int targetID = mutableTarget->id;
-
-    unit->attackTowardPosition(buildingPos, [this, unit, troopLayer, targetID]() {
-        executeAttack(unit, troopLayer, targetID, false,
-                      [this, unit, troopLayer]() {
-            startUnitAI(unit, troopLayer);
-        },
-                      [this, unit, troopLayer]() {
-            startCombatLoop(unit, troopLayer);
-        }
-        );
-    });
-}
-
-void BattleProcessController::startCombatLoopWithForcedTarget(BattleUnitSprite* unit, BattleTroopLayer* troopLayer, const BuildingInstance* forcedTarget) {
-    if (!unit || !troopLayer || !forcedTarget) return;
-
-    Vec2 unitPos = unit->getPosition();
-    auto dm = VillageDataManager::getInstance();
-    int targetID = forcedTarget->id;
-
-    BuildingInstance* liveTarget = dm->getBuildingById(targetID);
-    if (!liveTarget || liveTarget->isDestroyed || liveTarget->currentHP <= 0) {
-        startUnitAI(unit, troopLayer);
+    // 炸弹兵自爆特判
+    if (unit->getUnitTypeID() == UnitTypeID::WALL_BREAKER) {
+        performWallBreakerSuicideAttack(unit, target, troopLayer);
+        enterState(agent, unit, TroopState::DEAD);
         return;
     }
 
-    // 持续检查：如果正在攻击城墙，检查是否有更好的路径
-    if (liveTarget->type == 303 && shouldAbandonWallForBetterPath(unit, targetID)) {
-        CCLOG("BattleProcessController: Found better path! Abandoning wall attack.");
-        startUnitAI(unit, troopLayer);
+    int damage = getDamageByUnitType(unit->getUnitTypeID());
+    float splashRadius = getSplashRadiusByUnitType(unit->getUnitTypeID());
+    bool destroyed = false;
+
+    if (splashRadius > 0.0f) {
+        // 溅射以目标占地中心为爆炸点
+        auto state = BattleBuildingState::getInstance();
+        int index = state->indexOf(target->id);
+        Vec2 impact(target->gridX + state->getGridWidth(index) * 0.5f,
+                    target->gridY + state->getGridHeight(index) * 0.5f);
+        destroyed = applySplashDamage(*target, impact, splashRadius, damage, 1);
+    } else {
+        destroyed = damageBuilding(*target, damage);
+    }
+
+    if (destroyed) {
+        enterState(agent, unit, TroopState::IDLE);
         return;
     }
 
-    auto config = BuildingConfig::getInstance()->getConfig(liveTarget->type);
-    if (!config) {
-        startUnitAI(unit, troopLayer);
+    // 每次攻击城墙后都检查是否有更好的路径
+    if (target->type == 303 && shouldAbandonWallForBetterPath(unit, target->id)) {
+        CCLOG("BattleProcessController: Better path found after attack! Switching target.");
+        enterState(agent, unit, TroopState::IDLE);
         return;
     }
 
-    Vec2 unitGridPos = GridMapUtils::pixelToGrid(unitPos);
-    int unitGridX = static_cast<int>(std::floor(unitGridPos.x));
-    int unitGridY = static_cast<int>(std::floor(unitGridPos.y));
+    // 下一次出手
+    agent.cooldown += ATTACK_INTERVAL;
+    unit->playAttackToward(GridMapUtils::gridToPixelCenter(target->gridX, target->gridY));
+}
 
-    int bX = liveTarget->gridX;
-    int bY = liveTarget->gridY;
-    int bW = config->gridWidth;
-    int bH = config->gridHeight;
+BuildingInstance* BattleProcessController::findLiveBuilding(int buildingId) const {
+    auto state = BattleBuildingState::getInstance();
+    int index = state->indexOf(buildingId);
+    return (index >= 0 && state->isAlive(index)) ? &state->getBuilding(index) : nullptr;
+}
 
-    int gridDistX = 0;
-    int gridDistY = 0;
+bool BattleProcessController::damageBuilding(BuildingInstance& target, int damage) {
+    auto state = BattleBuildingState::getInstance();
+    int index = state->indexOf(target.id);
+    if (index < 0) return false;
 
-    if (unitGridX < bX) {
-        gridDistX = bX - unitGridX;
-    } else if (unitGridX >= bX + bW) {
-        gridDistX = unitGridX - (bX + bW) + 1;
+    if (!state->applyDamage(index, damage)) {
+        // 城墙剩余血量影响破墙寻路的代价
+        FindPathUtil::getInstance()->markBuildingDamaged(target);
+        return false;
     }
 
-    if (unitGridY < bY) {
-        gridDistY = bY - unitGridY;
-    } else if (unitGridY >= bY + bH) {
-        gridDistY = unitGridY - (bY + bH) + 1;
+    commitDestroyedBuildings(std::vector<const BuildingInstance*>(1, &target));
+    return true;
+}
+
+bool BattleProcessController::applySplashDamage(BuildingInstance& primary, const Vec2& gridCenter, float radius,
+                                                int damage, int wallMultiplier) {
+    // 经空间索引按占地查询，不扫描整张建筑表
+    std::vector<const BuildingInstance*> hits;
+    TargetFinder::getInstance()->findBuildingsInRadius(gridCenter, radius, hits);
+
+    // 爆炸点可能落在主目标占地之外（炸弹兵贴墙自爆），主目标总要计入
+    if (std::find(hits.begin(), hits.end(), &primary) == hits.end()) {
+        hits.push_back(&primary);
     }
 
-    int gridDistance = std::max(gridDistX, gridDistY);
-    int attackRangeGrid = getAttackRangeByUnitType(unit->getUnitTypeID());
-    
-    if (gridDistance > attackRangeGrid) {
-        auto pathfinder = FindPathUtil::getInstance();
-        std::vector<Vec2> pathToTarget = pathfinder->findPathToAttackBuilding(unitPos, *liveTarget, attackRangeGrid);
-        
-        if (!pathToTarget.empty()) {
-            unit->followPath(pathToTarget, 100.0f, [this, unit, troopLayer, forcedTarget]() {
-                startCombatLoopWithForcedTarget(unit, troopLayer, forcedTarget);
-            });
-        } else {
-            Vec2 targetPos = GridMapUtils::gridToPixelCenter(liveTarget->gridX, liveTarget->gridY);
-            std::vector<Vec2> directPath = { targetPos };
-            unit->followPath(directPath, 100.0f, [this, unit, troopLayer, forcedTarget]() {
-                startCombatLoopWithForcedTarget(unit, troopLayer, forcedTarget);
-            });
+    auto state = BattleBuildingState::getInstance();
+    auto pathfinder = FindPathUtil::getInstance();
+    std::vector<const BuildingInstance*> destroyed;
+    bool primaryDestroyed = false;
+
+    for (const BuildingInstance* hit : hits) {
+        int index = state->indexOf(hit->id);
+        if (index < 0 || !state->isAlive(index)) continue;
+
+        int hitDamage = state->hasFlag(index, BATTLE_WALL) ? damage * wallMultiplier : damage;
+        if (!state->applyDamage(index, hitDamage)) {
+            pathfinder->markBuildingDamaged(*hit);
+            continue;
         }
-        return;
+
+        destroyed.push_back(hit);
+        if (hit == &primary) primaryDestroyed = true;
     }
+
+    CCLOG("BattleProcessController: Splash r=%.1f hit %zu buildings, destroyed %zu",
+          radius, hits.size(), destroyed.size());
+
+    commitDestroyedBuildings(destroyed);
+    return primaryDestroyed;
+}
+
+void BattleProcessController::commitDestroyedBuildings(const std::vector<const BuildingInstance*>& destroyed) {
+    if (destroyed.empty()) return;
+
+    // 只清除被摧毁建筑的占地格子，同一批只合并一次连通区域、递增一次地图版本
+    FindPathUtil::getInstance()->markBuildingsRemoved(destroyed);
+
+    // 一次攻击摧毁的建筑合并为一个事件（摧毁进度由 BattleScene 每帧合并上报）
+    EventCustom event("EVENT_BUILDINGS_DESTROYED");
+    event.setUserData(const_cast<std::vector<const BuildingInstance*>*>(&destroyed));
+    Director::getInstance()->getEventDispatcher()->dispatchEvent(&event);
+}
+
+bool BattleProcessController::shouldAbandonWallForBetterPath(BattleUnitSprite* unit, int currentWallID) {
+    Vec2 unitPos = unit->getPosition();
+    Vec2 unitGridPos = GridMapUtils::pixelToGrid(unitPos);
     
-    Vec2 targetPos = GridMapUtils::gridToPixelCenter(liveTarget->gridX, liveTarget->gridY);
+    CCLOG("--- shouldAbandonWallForBetterPath DEBUG ---");
+    CCLOG("  Unit at pixel(%.1f, %.1f), grid(%.1f, %.1f)", 
+          unitPos.x, unitPos.y, unitGridPos.x, unitGridPos.y);
+    CCLOG("  Current wall ID: %d", currentWallID);
     
-    unit->attackTowardPosition(targetPos, [this, unit, troopLayer, targetID]() {
-        executeAttack(unit, troopLayer, targetID, true,
-            [this, unit, troopLayer]() {
-                startUnitAI(unit, troopLayer);
-            },
-            [this, unit, troopLayer, targetID]() {
-                auto dm = VillageDataManager::getInstance();
-                auto t = dm->getBuildingById(targetID);
-                if (t && !t->isDestroyed && t->currentHP > 0) {
-                    // 每次攻击后都检查是否有更好的路径
-                    if (t->type == 303 && shouldAbandonWallForBetterPath(unit, targetID)) {
-                        CCLOG("BattleProcessController: Better path found after attack! Switching target.");
-                        startUnitAI(unit, troopLayer);
-                    } else {
-                        startCombatLoopWithForcedTarget(unit, troopLayer, t);
-                    }
-                } else {
-                    startUnitAI(unit, troopLayer);
-                }
-            }
-        );
-    });
+    const BuildingInstance* bestTarget = nullptr;
+    // 使用TargetFinder查找最佳目标
+    bestTarget = TargetFinder::getInstance()->findTarget(unitPos, unit->getUnitTypeID());
+    
+    if (!bestTarget) {
+        CCLOG("  No best target found, keep attacking wall");
+        return false;
+    }
+    
+    CCLOG("  Best target: ID=%d, Type=%d at grid(%d, %d)",
+          bestTarget->id, bestTarget->type, bestTarget->gridX, bestTarget->gridY);
+    
+    auto pathfinder = FindPathUtil::getInstance();
+    int attackRange = getAttackRangeByUnitType(unit->getUnitTypeID());
+
+    // 共享流场 O(1) 判断：目标仍被围住时不必重新规划
+    std::vector<Vec2> pathAround = pathfinder->findPathByFlowField(unitPos, *bestTarget, attackRange);
+    if (pathAround.empty()) {
+        CCLOG("  No path around found, keep attacking wall");
+        return false;
+    }
+
+    // 有路可绕：按当前城墙剩余血量比较绕路和继续破墙
+    FindPathUtil::WallBreakPlan plan;
+    int damagePerHit = getDamageByUnitType(unit->getUnitTypeID());
+    if (!pathfinder->planPathWithWallBreaking(unitPos, *bestTarget, attackRange, damagePerHit, plan)) {
+        CCLOG("  Wall-breaking plan failed, keep attacking wall");
+        return false;
+    }
+
+    CCLOG("  Plan: cost=%d, first wall ID=%d", plan.totalCost, plan.wallBuildingId);
+
+    if (plan.wallBuildingId == 0) {
+        CCLOG("  ✓ ABANDON WALL - walking around is now cheaper!");
+        return true;
+    }
+
+    CCLOG("  ✗ Keep attacking wall - breaking through is still cheaper");
+    CCLOG("--- END shouldAbandonWallForBetterPath ---");
+    return false;
 }
 
 void BattleProcessController::performWallBreakerSuicideAttack(
     BattleUnitSprite* unit,
     BuildingInstance* target,
-    BattleTroopLayer* troopLayer,
-    const std::function<void()>& onComplete
+    BattleTroopLayer* troopLayer
 ) {
     if (!unit || !target || !troopLayer) {
-        if (onComplete) onComplete();
         return;
     }
 
@@ -723,40 +952,16 @@ void BattleProcessController::performWallBreakerSuicideAttack(
 
     // 获取炸弹兵伤害值
     int damage = getDamageByUnitType(unit->getUnitTypeID());
-    
-    // 对城墙造成10倍伤害
-    if (target->type == 303) {
-        damage *= 10;
-        CCLOG("BattleProcessController: Wall Breaker deals 10x damage to wall!");
-    }
-
-    // 对目标建筑造成伤害
-    target->currentHP -= damage;
-    CCLOG("BattleProcessController: Target HP: %d (damage: %d)", target->currentHP, damage);
-
-    // 检查目标是否被摧毁
-    if (target->currentHP <= 0) {
-        target->isDestroyed = true;
-        target->currentHP = 0;
 
-        FindPathUtil::getInstance()->updatePathfindingMap();
-
-        Director::getInstance()->getEventDispatcher()->dispatchCustomEvent(
-            "EVENT_BUILDING_DESTROYED",
-            static_cast<void*>(target)
-        );
-
-        DestructionTracker::getInstance()->updateProgress();
+    // 以自爆位置为中心造成溅射伤害，范围内的城墙都受10倍伤害
+    Vec2 impact = GridMapUtils::pixelToGrid(unit->getPosition());
+    float splashRadius = getSplashRadiusByUnitType(unit->getUnitTypeID());
+    if (applySplashDamage(*target, impact, splashRadius, damage, 10)) {
         CCLOG("BattleProcessController: Target destroyed!");
     }
 
     // 播放爆炸特效
-    auto explosion = ParticleExplosion::create();
-    explosion->setPosition(unit->getPosition());
-    explosion->setDuration(0.2f);
-    explosion->setScale(0.3f);
-    explosion->setAutoRemoveOnFinish(true);
-    troopLayer->getParent()->addChild(explosion, 1000);
+    BattleNodePool::getInstance()->playExplosion(troopLayer->getParent(), unit->getPosition(), 0.2f, 0.3f, 1000);
 
     // 屏幕震动
     auto camera = Camera::getDefaultCamera();
@@ -773,7 +978,7 @@ void BattleProcessController::performWallBreakerSuicideAttack(
     unit->setColor(Color3B::WHITE);
 
     // 播放死亡动画并移除
-    unit->playDeathAnimation([troopLayer, unit, onComplete]() {
+    unit->playDeathAnimation([troopLayer, unit]() {
         CCLOG("BattleProcessController: Wall Breaker death animation completed");
 
         Vec2 tombstonePos = unit->getPosition();
@@ -781,9 +986,5 @@ void BattleProcessController::performWallBreakerSuicideAttack(
 
         troopLayer->removeUnit(unit);
         troopLayer->spawnTombstone(tombstonePos, unitType);
-
-        if (onComplete) {
-            onComplete();
-        }
     });
 }
@@ -5,9 +5,12 @@
 
 #include "cocos2d.h"
 #include "../Model/VillageData.h"
+#include "../Util/FindPathUtil.h"
+#include "../Model/TroopHandle.h"
+#include "Model/ReplayData.h"
 #include <map>
-#include <set>
-#include <functional>
+#include <utility>
+#include <vector>
 
 USING_NS_CC;
 
@@ -15,37 +18,78 @@ class BattleUnitSprite;
 class BattleTroopLayer;
 struct BuildingInstance;
 
+// 单位行为状态
+enum class TroopState {
+    IDLE,       // 等待决策（选目标）
+    PLANNING,   // 已选定目标，等待路线返回
+    MOVING,     // 沿路线移动
+    ATTACKING,  // 在攻击范围内，按冷却出手
+    DEAD        // 已阵亡，等待移除
+};
+
 /**
  * @brief 战斗流程控制器 - 管理战斗中的单位AI和行为逻辑
+ *
+ * 每个单位对应一个 TroopAgent，按 TroopHandle 的槽位下标连续存放。
+ * updateTroops() 每个战斗 tick 调用一次，推进所有单位的状态机；
+ * 单位精灵只负责按状态播放动画，不再通过动作回调驱动逻辑。
  */
 class BattleProcessController {
 public:
     static BattleProcessController* getInstance();
     static void destroyInstance();
     
-    // 启动单位AI
-    void startUnitAI(BattleUnitSprite* unit, BattleTroopLayer* troopLayer);
-    
-    // 启动战斗循环
-    void startCombatLoop(BattleUnitSprite* unit, BattleTroopLayer* troopLayer);
-    void startCombatLoopWithForcedTarget(BattleUnitSprite* unit, BattleTroopLayer* troopLayer, const BuildingInstance* forcedTarget);
+    // 登记新部署的单位，从下一个 tick 开始决策
+    void registerUnit(BattleUnitSprite* unit);
+
+    // 推进所有单位的状态机（每个战斗 tick 调用一次）
+    void updateTroops(BattleTroopLayer* troopLayer);
+
+    // 渲染插值：每帧推进 tick 前把单位放回当前 tick 的逻辑位置，
+    // 推进后按 BattleClock::getInterpolationAlpha() 在上一 tick 和当前 tick 的位置之间插值显示
+    void restoreTickPositions(BattleTroopLayer* troopLayer);
+    void interpolatePositions(BattleTroopLayer* troopLayer, float alpha);
+
+    // 查询单位当前状态（未登记的单位返回 DEAD）
+    TroopState getTroopState(const TroopHandle& handle) const;
     
     // 重置战斗状态
     void resetBattleState();
 
-    // 绕路阈值常量（像素）
-    static constexpr float PIXEL_DETOUR_THRESHOLD = 800.0f;
+    // 路线规划方式
+    enum class PlanningMode {
+        SYNC,       // 决策时同步搜索
+        ASYNC,      // 交给 AsyncPathfinder 工作线程，路线返回前单位保持当前动作
+        TIME_SLICED // 交给 PathPlanningQueue 在主线程按每帧预算分段搜索
+    };
 
-    // 炸弹兵自爆攻击
-    void performWallBreakerSuicideAttack(
-        BattleUnitSprite* unit,
-        BuildingInstance* target,
-        BattleTroopLayer* troopLayer,
-        const std::function<void()>& onComplete
-    );
+    /**
+     * 默认方式由设备决定：有空闲硬件线程时用 ASYNC，否则用 TIME_SLICED，
+     * 两者都不会在一帧内做不受限的搜索，路线返回后在下一个 tick 生效。
+     * 生效的 tick 取决于设备快慢，录制时把每条路线及其生效的 tick 记入回放，
+     * 回放不再搜索，而是在同一个 tick 应用录制的路线（见 beginPlanRecording / beginPlanReplay）。
+     * 可用 UserDefault 的 PLANNING_MODE_KEY（"sync" / "async" / "time_sliced"）覆盖，
+     * 启动时读取一次；运行中切换用 setPlanningMode()。
+     */
+    static const char* const PLANNING_MODE_KEY;
+
+    void setPlanningMode(PlanningMode mode);
+    PlanningMode getPlanningMode() const { return _planningMode; }
+
+    // 丢弃所有尚未返回的路线（离开战斗场景时调用）
+    void cancelPendingPlans();
+
+    // 开始录制路线生效事件（在第一个单位部署前调用）
+    void beginPlanRecording();
+
+    // 结束录制，取出本场的路线生效事件
+    void endPlanRecording(std::vector<AttackPlanEvent>& outEvents);
+
+    // 开始回放：按录制的 tick 应用录制的路线；没有录制路线的旧回放仍重新规划
+    void beginPlanReplay(const std::vector<AttackPlanEvent>& events);
 
 private:
-    BattleProcessController() = default;
+    BattleProcessController();
     ~BattleProcessController() = default;
     
     BattleProcessController(const BattleProcessController&) = delete;
@@ -53,21 +97,110 @@ private:
     
     static BattleProcessController* _instance;
     
-    // 累积伤害系统
-    std::map<BattleUnitSprite*, float> _accumulatedDamage;
-
-    // 获取直线上第一个城墙
-    const BuildingInstance* getFirstWallInLine(const cocos2d::Vec2& startPixel, const cocos2d::Vec2& endPixel);
-
-    // 执行攻击逻辑
-    void executeAttack(
-        BattleUnitSprite* unit,
-        BattleTroopLayer* troopLayer,
-        int targetID,
-        bool isForcedTarget,
-        const std::function<void()>& onTargetDestroyed,
-        const std::function<void()>& onContinueAttack
-    );
+    // 单位状态机数据
+    struct TroopAgent {
+        TroopHandle handle;                 // 空句柄表示槽位未使用
+        int serial = 0;                     // 本场战斗的部署序号，录制和回放中一致
+        int planSeq = 0;                    // 已发出的路线请求数
+        TroopState state = TroopState::DEAD;
+        int targetId = 0;                   // 当前目标建筑
+        bool wallTarget = false;            // 目标是路线上必须打穿的城墙
+        Vec2 prevPosition;                  // 上一个 tick 结束时的逻辑位置
+        Vec2 position;                      // 当前 tick 结束时的逻辑位置
+        std::vector<Vec2> waypoints;        // 剩余路径点（像素坐标）
+        size_t nextWaypoint = 0;
+        float cooldown = 0.0f;              // IDLE: 距下次决策；ATTACKING: 距下次出手
+        int planRequestId = 0;              // PLANNING: 等待中的请求
+        int planDueTick = 0;                // PLANNING: 最早生效的 tick（回放时为录制的 tick）
+        bool planReady = false;             // 路线已返回，下个 tick 处理
+        bool planFound = false;
+        FindPathUtil::WallBreakPlan plan;
+    };
+
+    // 单位移动速度（像素/秒）
+    static constexpr float MOVE_SPEED = 100.0f;
+    // 两次出手的间隔（秒）
+    static constexpr float ATTACK_INTERVAL = 1.0f;
+    // 找不到目标时重新决策的间隔（秒）
+    static constexpr float RETHINK_INTERVAL = 0.5f;
+
+    std::vector<TroopAgent> _agents;    // 下标即 TroopHandle::index
+
+    // 路线规划
+    PlanningMode _planningMode;
+
+    // 路线录制与回放
+    int _nextUnitSerial;
+    bool _recordingPlans;
+    std::vector<AttackPlanEvent> _recordedPlans;
+    bool _replayingPlans;
+    std::map<std::pair<int, int>, AttackPlanEvent> _replayPlans;    // (部署序号, 请求序号) -> 事件
+
+    // 按设置和设备选择默认规划方式
+    static PlanningMode chooseDefaultPlanningMode();
+
+    TroopAgent* findAgent(const TroopHandle& handle);
+
+    // 状态切换：离开 PLANNING 时取消请求，并切换对应的表现
+    void enterState(TroopAgent& agent, BattleUnitSprite* unit, TroopState state);
+
+    // IDLE：选择目标并决定如何接近
+    void decide(TroopAgent& agent, BattleUnitSprite* unit);
+
+    // 为单位规划到目标的路线（按规划方式同步或异步）
+    void requestAttackPlan(TroopAgent& agent, BattleUnitSprite* unit, const BuildingInstance* target, int attackRange);
+
+    // 路线返回（只记录结果，由下个 tick 处理）
+    void onPlanReady(const TroopHandle& handle, bool found, const FindPathUtil::WallBreakPlan& plan);
+
+    // 回放：取录制的路线，录制时当即生效的立即应用，否则等到录制的 tick
+    void requestReplayPlan(TroopAgent& agent, BattleUnitSprite* unit);
+
+    // 路线生效：录制时记下生效的 tick 和路线，再按路线行动
+    void commitPlan(TroopAgent& agent, BattleUnitSprite* unit, bool planned, const FindPathUtil::WallBreakPlan& plan);
+
+    // 按路线行动：绕路走向目标，或先走到第一堵墙并锁定它
+    void applyAttackPlan(TroopAgent& agent, BattleUnitSprite* unit, bool planned, const FindPathUtil::WallBreakPlan& plan);
+
+    // 沿新路线移动（跳过当前位置已越过、且能直线走到下一点的前导路径点）；路线为空时视为已到达
+    void startMoving(TroopAgent& agent, BattleUnitSprite* unit, const std::vector<Vec2>& path);
+
+    // 沿路线前进一个 tick，走完返回 true
+    bool advanceAlongPath(TroopAgent& agent, BattleUnitSprite* unit, float dt);
+
+    // 路线走完：在攻击范围内则开始攻击，否则继续接近或重新决策
+    void onArrived(TroopAgent& agent, BattleUnitSprite* unit);
+
+    // ATTACKING：冷却结束时出手
+    void updateAttack(TroopAgent& agent, BattleUnitSprite* unit, BattleTroopLayer* troopLayer, float dt);
+
+    // 单位是否在目标的攻击范围内
+    bool isInAttackRange(BattleUnitSprite* unit, const BuildingInstance& target) const;
+
+    // 按ID取存活的建筑（查 BattleBuildingState，已摧毁时返回 nullptr）
+    BuildingInstance* findLiveBuilding(int buildingId) const;
+
+    // 经 BattleBuildingState 造成伤害并同步寻路地图，摧毁时派发事件，返回是否摧毁
+    bool damageBuilding(BuildingInstance& target, int damage);
+
+    /**
+     * @brief 溅射伤害：占地与圆相交的所有建筑（含城墙）各受一次伤害
+     * @param gridCenter 爆炸中心（网格坐标）
+     * @param radius 溅射半径（格子单位）
+     * @param wallMultiplier 对城墙的伤害倍数
+     * @return 主目标是否被摧毁（主目标总会被命中）
+     */
+    bool applySplashDamage(BuildingInstance& primary, const cocos2d::Vec2& gridCenter, float radius,
+                           int damage, int wallMultiplier);
+
+    // 提交一次攻击摧毁的建筑：寻路地图批量更新，派发一次 EVENT_BUILDINGS_DESTROYED
+    void commitDestroyedBuildings(const std::vector<const BuildingInstance*>& destroyed);
+
+    // 炸弹兵自爆攻击
+    void performWallBreakerSuicideAttack(BattleUnitSprite* unit, BuildingInstance* target, BattleTroopLayer* troopLayer);
+
+    // 按当前规划方式取消请求
+    void cancelPlanRequest(int requestId);
 
     // 判断是否应放弃当前城墙寻找更优路径
     bool shouldAbandonWallForBetterPath(BattleUnitSprite* unit, int currentWallID);
@@ -11,29 +11,39 @@
 #include "../Manager/AudioManager.h"
 #include "../Controller/BattleProcessController.h"
 #include "../Controller/DestructionTracker.h"
+#include "../Controller/BattleClock.h"
+#include "../Model/BattleBuildingState.h"
+#include "../Sprite/BattleUnitSprite.h"
 #include "../UI/BattleProgressUI.h"
+#include <cmath>
 
 USING_NS_CC;
 
 BattleRecorder::BattleRecorder()
     : _isRecording(false)
-    , _battleStartTime(0.0f)
+    , _lastChecksum(0)
     , _isReplayMode(false)
-    , _replayStartTime(0.0f)
+    , _replayEndTick(0)
     , _currentEventIndex(0)
     , _isEndingScheduled(false)
+    , _divergedTick(-1)
+    , _replayVerified(false)
 {
 }
 
 // ========== 录制系统实现 ==========
 
 void BattleRecorder::startRecording() {
+    // 时间统一取 BattleClock 的 tick，时钟由 BattleScene 在进入准备/战斗阶段时归零
     _isRecording = true;
-    _battleStartTime = Director::getInstance()->getTotalFrames() / 60.0f;
 
     // 清空数据
     _replayData = BattleReplayData();
     _replayData.troopEvents.clear();
+    _lastChecksum = 0;
+
+    // 路线生效的 tick 取决于设备快慢，连同路线一起录下
+    BattleProcessController::getInstance()->beginPlanRecording();
 
     // 地图状态在进入战斗时保存，确保记录用户最终选择的地图
 
@@ -41,7 +51,7 @@ void BattleRecorder::startRecording() {
     _replayData.defenderName = "AI Village";
     _replayData.timestamp = time(nullptr);
 
-    CCLOG("BattleRecorder: Recording started at time %.2f (map will be saved when battle starts)", _battleStartTime);
+    CCLOG("BattleRecorder: Recording started (map will be saved when battle starts)");
 }
 
 void BattleRecorder::saveCurrentMap() {
@@ -58,19 +68,21 @@ void BattleRecorder::saveCurrentMap() {
 void BattleRecorder::recordTroopDeployment(int troopId, int gridX, int gridY) {
     if (!_isRecording) return;
 
-    float currentTime = Director::getInstance()->getTotalFrames() / 60.0f;
-    float timestamp = currentTime - _battleStartTime;
+    // 在两个 tick 之间部署，回放时在下一个 tick 的逻辑之前部署
+    int tick = BattleClock::getInstance()->getTick();
+    float timestamp = tick * BattleClock::TICK_SECONDS;
 
     TroopDeployEvent event;
     event.timestamp = timestamp;
+    event.tick = tick;
     event.troopId = troopId;
     event.gridX = gridX;
     event.gridY = gridY;
 
     _replayData.troopEvents.push_back(event);
 
-    CCLOG("BattleRecorder: Recorded troop %d at grid(%d, %d) @ %.2fs",
-          troopId, gridX, gridY, timestamp);
+    CCLOG("BattleRecorder: Recorded troop %d at grid(%d, %d) @ tick %d (%.2fs)",
+          troopId, gridX, gridY, tick, timestamp);
 }
 
 void BattleRecorder::stopRecording(int lootedGold, int lootedElixir,
@@ -88,13 +100,15 @@ void BattleRecorder::stopRecording(int lootedGold, int lootedElixir,
     _replayData.lootedElixir = lootedElixir;
     _replayData.usedTroops = usedTroops;
     _replayData.troopLevels = troopLevels;
-    _replayData.battleDuration = Director::getInstance()->getTotalFrames() / 60.0f - _battleStartTime;
+    _replayData.battleDuration = BattleClock::getInstance()->getElapsedSeconds();
+    _replayData.finalChecksum = _lastChecksum;
+    BattleProcessController::getInstance()->endPlanRecording(_replayData.planEvents);
 
     // 保存到本地
     ReplayManager::getInstance()->saveReplay(_replayData);
 
-    CCLOG("BattleRecorder: Recording stopped, saved replay with %zu events",
-          _replayData.troopEvents.size());
+    CCLOG("BattleRecorder: Recording stopped, saved replay with %zu events and %zu plans",
+          _replayData.troopEvents.size(), _replayData.planEvents.size());
 }
 
 // ========== 回放播放实现 ==========
@@ -120,9 +134,20 @@ void BattleRecorder::startReplay(BattleHUDLayer* hudLayer, std::function<void()>
         CCLOG("BattleRecorder: HUD controls hidden for replay mode");
     }
 
-    _replayStartTime = Director::getInstance()->getTotalFrames() / 60.0f;
+    // 旧回放只有秒数，换算为 tick
+    for (auto& event : _replayData.troopEvents) {
+        if (event.tick < 0) {
+            event.tick = BattleClock::secondsToTicks(event.timestamp);
+        }
+    }
+    _replayEndTick = BattleClock::secondsToTicks(_replayData.battleDuration);
     _currentEventIndex = 0;
     _isEndingScheduled = false;
+    _divergedTick = -1;
+    _replayVerified = false;
+
+    // 单位在录制时生效的 tick 应用录制的路线，回放不依赖本机的规划速度
+    BattleProcessController::getInstance()->beginPlanReplay(_replayData.planEvents);
 
     // 自动进入战斗状态
     if (onSwitchToFighting) {
@@ -130,18 +155,17 @@ void BattleRecorder::startReplay(BattleHUDLayer* hudLayer, std::function<void()>
     }
 }
 
-void BattleRecorder::updateReplay(float dt, BattleTroopLayer* troopLayer,
+void BattleRecorder::updateReplay(BattleTroopLayer* troopLayer,
                                    std::function<void()> onReplayFinished) {
     if (!_isReplayMode) return;
 
-    float currentTime = Director::getInstance()->getTotalFrames() / 60.0f;
-    float elapsedTime = currentTime - _replayStartTime;
+    int currentTick = BattleClock::getInstance()->getTick();
 
     // 检查是否有兵种需要部署
-    checkAndDeployNextTroop(elapsedTime, troopLayer);
+    checkAndDeployNextTroop(currentTick, troopLayer);
 
     // 当经过完整战斗时长后触发结束回调
-    if (elapsedTime >= _replayData.battleDuration && !_isEndingScheduled) {
+    if (currentTick >= _replayEndTick && !_isEndingScheduled) {
         _isEndingScheduled = true;
         CCLOG("BattleRecorder: Battle duration (%.2fs) reached, triggering finish callback...", 
               _replayData.battleDuration);
@@ -152,14 +176,14 @@ void BattleRecorder::updateReplay(float dt, BattleTroopLayer* troopLayer,
     }
 }
 
-void BattleRecorder::checkAndDeployNextTroop(float elapsedTime, BattleTroopLayer* troopLayer) {
+void BattleRecorder::checkAndDeployNextTroop(int currentTick, BattleTroopLayer* troopLayer) {
     if (!troopLayer) return;
 
     while (_currentEventIndex < _replayData.troopEvents.size()) {
         const auto& event = _replayData.troopEvents[_currentEventIndex];
 
-        // 如果时间未到，跳出循环
-        if (elapsedTime < event.timestamp) {
+        // 录制时在第 event.tick 个 tick 之后部署，回放在下一个 tick 开始时部署
+        if (event.tick >= currentTick) {
             break;
         }
 
@@ -190,7 +214,7 @@ void BattleRecorder::checkAndDeployNextTroop(float elapsedTime, BattleTroopLayer
                 audioManager->playEffect("Audios/balloon_deploy.mp3", 0.8f);
             }
 
-            BattleProcessController::getInstance()->startUnitAI(unit, troopLayer);
+            BattleProcessController::getInstance()->registerUnit(unit);
             CCLOG("BattleRecorder: [REPLAY] Auto-deployed %s at grid(%d, %d)",
                   name.c_str(), event.gridX, event.gridY);
         }
@@ -199,6 +223,88 @@ void BattleRecorder::checkAndDeployNextTroop(float elapsedTime, BattleTroopLayer
     }
 }
 
+// ========== 回放校验 ==========
+
+void BattleRecorder::onTickFinished(BattleTroopLayer* troopLayer) {
+    if (!_isRecording && !_isReplayMode) return;
+
+    int tick = BattleClock::getInstance()->getTick();
+    int checksum = computeStateChecksum(troopLayer);
+    bool sampled = tick > 0 && tick % CHECKSUM_INTERVAL_TICKS == 0;
+
+    if (_isRecording) {
+        _lastChecksum = checksum;
+        if (sampled) {
+            _replayData.stateChecksums.push_back(checksum);
+        }
+        return;
+    }
+
+    if (sampled && _divergedTick < 0) {
+        size_t index = tick / CHECKSUM_INTERVAL_TICKS - 1;
+        if (index < _replayData.stateChecksums.size() && _replayData.stateChecksums[index] != checksum) {
+            _divergedTick = tick;
+            CCLOG("BattleRecorder: [REPLAY] State diverged at tick %d (recorded %d, replayed %d)",
+                  tick, _replayData.stateChecksums[index], checksum);
+        }
+    }
+
+    if (tick == _replayEndTick) {
+        verifyReplayOutcome(checksum);
+    }
+}
+
+int BattleRecorder::computeStateChecksum(BattleTroopLayer* troopLayer) {
+    uint32_t hash = 2166136261u;
+    auto mix = [&hash](int value) {
+        hash = (hash ^ static_cast<uint32_t>(value)) * 16777619u;
+    };
+
+    auto state = BattleBuildingState::getInstance();
+    for (int i = 0; i < state->size(); ++i) {
+        mix(state->getHP(i));
+    }
+
+    // 阵亡单位的移除时机跟随死亡动画，不参与校验
+    if (troopLayer) {
+        for (auto unit : troopLayer->getAllUnits()) {
+            if (!unit || unit->isDead()) continue;
+            mix(static_cast<int>(unit->getUnitTypeID()));
+            mix(unit->getCurrentHP());
+            mix(static_cast<int>(std::lround(unit->getPositionX())));
+            mix(static_cast<int>(std::lround(unit->getPositionY())));
+        }
+    }
+
+    return static_cast<int>(hash);
+}
+
+void BattleRecorder::verifyReplayOutcome(int checksum) {
+    if (_replayData.stateChecksums.empty() && _replayData.finalChecksum == 0) {
+        CCLOG("BattleRecorder: [REPLAY] Replay has no checksums, skipping verification");
+        return;
+    }
+
+    auto tracker = DestructionTracker::getInstance();
+    int stars = tracker->getStars();
+    int destruction = (int)tracker->getProgress();
+
+    _replayVerified = _divergedTick < 0
+        && checksum == _replayData.finalChecksum
+        && stars == _replayData.finalStars
+        && destruction == _replayData.destructionPercentage;
+
+    if (_replayVerified) {
+        CCLOG("BattleRecorder: [REPLAY] Verified identical outcome at tick %d: %d stars, %d%%",
+              _replayEndTick, stars, destruction);
+    } else {
+        CCLOG("BattleRecorder: [REPLAY] Outcome mismatch at tick %d (first divergence: tick %d): "
+              "stars %d/%d, destruction %d%%/%d%%, checksum %d/%d",
+              _replayEndTick, _divergedTick, stars, _replayData.finalStars,
+              destruction, _replayData.destructionPercentage, checksum, _replayData.finalChecksum);
+    }
+}
+
 // ========== 加载回放地图 ==========
 
 void BattleRecorder::loadReplayMap(BattleMapLayer* mapLayer, BattleHUDLayer* hudLayer) {
@@ -15,8 +15,18 @@ class BattleProgressUI;
 
 // 战斗回放管理器类
 // 职责：录制战斗事件、保存回放数据、播放回放
+//
+// 除兵种部署外，录制还保存每条攻击路线及其生效的 tick（由 BattleProcessController 记录），
+// 回放在相同的 tick 应用录制的路线，不受本机寻路快慢影响。
+//
+// 回放校验：录制时每 CHECKSUM_INTERVAL_TICKS 个 tick 记录一次战斗状态校验值
+// （建筑血量、存活单位的血量和位置），回放在相同的 tick 重新计算并比对，
+// 到录制结束的 tick 再比对星数、摧毁率和最终校验值，结果写入日志。
 class BattleRecorder {
 public:
+    // 两次状态校验之间的 tick 数
+    static const int CHECKSUM_INTERVAL_TICKS = 30;
+
     BattleRecorder();
     ~BattleRecorder() = default;
 
@@ -43,10 +53,16 @@ public:
     // 开始播放回放
     void startReplay(BattleHUDLayer* hudLayer, std::function<void()> onSwitchToFighting);
     
-    // 更新回放进度
-    void updateReplay(float dt, BattleTroopLayer* troopLayer,
+    // 更新回放进度（每个战斗 tick 调用一次，按 BattleClock 的 tick 部署兵种）
+    void updateReplay(BattleTroopLayer* troopLayer,
                       std::function<void()> onReplayFinished);
     
+    // 每个战斗 tick 的逻辑结束后调用：录制时记录状态校验值，回放时比对
+    void onTickFinished(BattleTroopLayer* troopLayer);
+
+    // 回放与录制是否一致（回放到录制结束的 tick 后才有结论）
+    bool isReplayVerified() const { return _replayVerified; }
+
     // 是否为回放模式
     bool isReplayMode() const { return _isReplayMode; }
 
@@ -59,18 +75,26 @@ public:
 
 private:
     // 检查并部署下一个兵种
-    void checkAndDeployNextTroop(float elapsedTime, BattleTroopLayer* troopLayer);
+    void checkAndDeployNextTroop(int currentTick, BattleTroopLayer* troopLayer);
+
+    // 计算当前战斗状态的校验值（FNV-1a）
+    static int computeStateChecksum(BattleTroopLayer* troopLayer);
+
+    // 回放到录制结束的 tick：比对最终结果
+    void verifyReplayOutcome(int checksum);
 
     // 录制状态
     bool _isRecording = false;
-    float _battleStartTime = 0.0f;
     BattleReplayData _replayData;
+    int _lastChecksum = 0;                // 最近一个 tick 结束时的状态校验值
 
     // 回放状态
     bool _isReplayMode = false;
-    float _replayStartTime = 0.0f;
+    int _replayEndTick = 0;
     size_t _currentEventIndex = 0;
     bool _isEndingScheduled = false;
+    int _divergedTick = -1;               // 第一个校验值不一致的 tick
+    bool _replayVerified = false;
 };
 
 #endif // __BATTLE_RECORDER_H__
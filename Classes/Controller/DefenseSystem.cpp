@@ -2,13 +2,18 @@
 // 建筑防御系统实现，管理防御建筑的自动锁定和攻击逻辑
 
 #include "DefenseSystem.h"
+#include "BattleClock.h"
 #include "../Layer/BattleTroopLayer.h"
 #include "../Manager/VillageDataManager.h"
+#include "../Manager/BattleViewRegistry.h"
 #include "../Model/BuildingConfig.h"
+#include "../Model/BattleBuildingState.h"
 #include "../Util/GridMapUtils.h"
+#include "../Util/TroopSpatialIndex.h"
 #include "../Sprite/BattleUnitSprite.h"
 #include "../Sprite/BuildingSprite.h"
 #include "../Component/DefenseBuildingAnimation.h"
+#include <algorithm>
 
 USING_NS_CC;
 
@@ -28,6 +33,14 @@ void DefenseSystem::destroyInstance() {
     }
 }
 
+void DefenseSystem::queryUnitsInRange(int centerX, int centerY, int range, int layerMask) {
+    // 距离按截断后的网格坐标计算，-1 < x < 0 的单位截断为 0，因此向下多查一格再精确判断
+    TroopSpatialIndex::getInstance()->queryRect(
+        centerX - range - 1, centerY - range - 1,
+        centerX + range, centerY + range,
+        layerMask, _queryBuffer);
+}
+
 BattleUnitSprite* DefenseSystem::findNearestUnitInRange(
     const BuildingInstance& building, 
     float attackRangeGrids,
@@ -41,45 +54,38 @@ BattleUnitSprite* DefenseSystem::findNearestUnitInRange(
     // 计算建筑中心网格坐标
     int centerX = building.gridX + config->gridWidth / 2;
     int centerY = building.gridY + config->gridHeight / 2;
+    int attackRangeInt = static_cast<int>(attackRangeGrids);
     
-    auto allUnits = troopLayer->getAllUnits();
-    if (allUnits.empty()) return nullptr;
+    // 气球兵是飞行单位，只有箭塔能攻击
+    int layerMask = (building.type == 302) ? TroopSpatialIndex::LAYER_ALL : TroopSpatialIndex::LAYER_GROUND;
+    queryUnitsInRange(centerX, centerY, attackRangeInt, layerMask);
     
-    BattleUnitSprite* nearestUnit = nullptr;
+    const TroopEntry* nearest = nullptr;
     int minGridDistance = INT_MAX;
-    int attackRangeInt = static_cast<int>(attackRangeGrids);
     
-    for (auto unit : allUnits) {
-        if (!unit) continue;
-        
-        // 气球兵是飞行单位，只有箭塔能攻击
-        if (unit->getUnitTypeID() == UnitTypeID::BALLOON && building.type != 302) {
-            continue;
-        }
-        
-        Vec2 unitGridPos = unit->getGridPosition();
-        int unitGridX = static_cast<int>(unitGridPos.x);
-        int unitGridY = static_cast<int>(unitGridPos.y);
+    for (const TroopEntry* entry : _queryBuffer) {
+        int unitGridX = static_cast<int>(entry->gridPos.x);
+        int unitGridY = static_cast<int>(entry->gridPos.y);
         
         // 计算网格距离（切比雪夫距离）
         int gridDistance = std::max(
             std::abs(unitGridX - centerX),
             std::abs(unitGridY - centerY)
         );
+        if (gridDistance > attackRangeInt) continue;
         
-        if (gridDistance <= attackRangeInt) {
-            if (gridDistance < minGridDistance) {
-                minGridDistance = gridDistance;
-                nearestUnit = unit;
-            }
+        // 距离相同时取单位列表中靠前的一个
+        if (gridDistance < minGridDistance ||
+            (gridDistance == minGridDistance && entry->order < nearest->order)) {
+            minGridDistance = gridDistance;
+            nearest = entry;
         }
     }
     
-    if (nearestUnit) {
-        nearestUnit->setTargetedByBuilding(true);
-    }
+    if (!nearest) return nullptr;
     
-    return nearestUnit;
+    nearest->unit->setTargetedByBuilding(true);
+    return nearest->unit;
 }
 
 std::vector<BattleUnitSprite*> DefenseSystem::getAllUnitsInRange(
@@ -97,24 +103,23 @@ std::vector<BattleUnitSprite*> DefenseSystem::getAllUnitsInRange(
     // 计算建筑中心网格坐标
     int centerX = building.gridX + config->gridWidth / 2;
     int centerY = building.gridY + config->gridHeight / 2;
-    
-    auto allUnits = troopLayer->getAllUnits();
     int attackRangeInt = static_cast<int>(attackRangeGrids);
     
-    for (auto unit : allUnits) {
-        if (!unit) continue;
-        
-        Vec2 unitGridPos = unit->getGridPosition();
-        int unitGridX = static_cast<int>(unitGridPos.x);
-        int unitGridY = static_cast<int>(unitGridPos.y);
-        
+    queryUnitsInRange(centerX, centerY, attackRangeInt, TroopSpatialIndex::LAYER_ALL);
+    
+    // 按单位列表顺序返回
+    std::sort(_queryBuffer.begin(), _queryBuffer.end(), [](const TroopEntry* a, const TroopEntry* b) {
+        return a->order < b->order;
+    });
+    
+    for (const TroopEntry* entry : _queryBuffer) {
         int gridDistance = std::max(
-            std::abs(unitGridX - centerX),
-            std::abs(unitGridY - centerY)
+            std::abs(static_cast<int>(entry->gridPos.x) - centerX),
+            std::abs(static_cast<int>(entry->gridPos.y) - centerY)
         );
         
         if (gridDistance <= attackRangeInt) {
-            unitsInRange.push_back(unit);
+            unitsInRange.push_back(entry->unit);
         }
     }
     
@@ -124,44 +129,39 @@ std::vector<BattleUnitSprite*> DefenseSystem::getAllUnitsInRange(
 void DefenseSystem::updateBuildingDefense(BattleTroopLayer* troopLayer) {
     if (!troopLayer) return;
 
-    auto dataManager = VillageDataManager::getInstance();
-    auto& buildings = const_cast<std::vector<BuildingInstance>&>(dataManager->getAllBuildings());
+    // 只遍历防御建筑下标表（建筑状态已在本 tick 开始时同步）
+    auto state = BattleBuildingState::getInstance();
 
-    std::set<BattleUnitSprite*> targetedUnitsThisFrame;
-    float deltaTime = Director::getInstance()->getDeltaTime();
+    std::set<TroopHandle> targetedUnitsThisFrame;
+    // 每个战斗 tick 调用一次，冷却按固定步长递减
+    const float deltaTime = BattleClock::TICK_SECONDS;
 
-    for (auto& building : buildings) {
-        // 跳过非防御建筑
-        if (building.isDestroyed || building.currentHP <= 0) continue;
-        if (building.state == BuildingInstance::State::PLACING) continue;
-        if (building.type != 301 && building.type != 302) continue;
+    for (int index : state->getDefenses()) {
+        if (!state->isAlive(index)) continue;
 
+        const BuildingInstance& building = state->getBuilding(index);
         auto config = BuildingConfig::getInstance()->getConfig(building.type);
         if (!config) continue;
 
         float attackRange = config->attackRange;
         float attackSpeed = config->attackSpeed;
+        TroopHandle& lockedTarget = state->lockedTarget(index);
+        float& attackCooldown = state->cooldown(index);
 
-        BattleUnitSprite* currentTarget = static_cast<BattleUnitSprite*>(building.lockedTarget);
+        // 句柄解析 O(1)：单位已被移除时得到 nullptr
+        BattleUnitSprite* currentTarget = troopLayer->resolveUnit(lockedTarget);
 
         // 目标有效性检查
         bool targetValid = false;
 
-        if (currentTarget) {
-            auto allUnits = troopLayer->getAllUnits();
-
+        if (!lockedTarget.isNull()) {
             // 检查目标是否还存活
-            for (auto unit : allUnits) {
-                if (unit == currentTarget && !unit->isDead()) {
-                    targetValid = true;
-                    break;
-                }
-            }
+            targetValid = currentTarget && !currentTarget->isDead();
 
             // 检查目标是否还在范围内
             if (targetValid) {
-                int centerX = building.gridX + config->gridWidth / 2;
-                int centerY = building.gridY + config->gridHeight / 2;
+                int centerX = state->getCenterGridX(index);
+                int centerY = state->getCenterGridY(index);
 
                 Vec2 unitGridPos = currentTarget->getGridPosition();
                 int gridDistance = std::max(
@@ -176,7 +176,7 @@ void DefenseSystem::updateBuildingDefense(BattleTroopLayer* troopLayer) {
 
             // 目标无效，清除锁定
             if (!targetValid) {
-                building.lockedTarget = nullptr;
+                lockedTarget = TroopHandle();
                 currentTarget = nullptr;
             }
         }
@@ -185,54 +185,40 @@ void DefenseSystem::updateBuildingDefense(BattleTroopLayer* troopLayer) {
         if (!currentTarget) {
             BattleUnitSprite* newTarget = findNearestUnitInRange(building, attackRange, troopLayer);
             if (newTarget && !newTarget->isDead()) {
-                building.lockedTarget = static_cast<void*>(newTarget);
+                lockedTarget = newTarget->getHandle();
                 currentTarget = newTarget;
-                building.attackCooldown = 0.0f;
+                attackCooldown = 0.0f;
             }
         }
 
         // 攻击逻辑
         if (currentTarget) {
-            targetedUnitsThisFrame.insert(currentTarget);
+            targetedUnitsThisFrame.insert(currentTarget->getHandle());
 
-            building.attackCooldown -= deltaTime;
+            attackCooldown -= deltaTime;
 
-            if (building.attackCooldown <= 0.0f) {
+            if (attackCooldown <= 0.0f) {
                 // 计算伤害
                 int damagePerShot = static_cast<int>(config->damagePerSecond * attackSpeed);
                 currentTarget->takeDamage(damagePerShot);
 
-                // 播放攻击动画
-                auto mapLayer = troopLayer->getParent();
-                if (mapLayer) {
-                    std::string spriteName = "Building_" + std::to_string(building.id);
-                    auto buildingSprite = dynamic_cast<BuildingSprite*>(mapLayer->getChildByName(spriteName));
-
-                    if (buildingSprite) {
-                        auto defenseAnim = dynamic_cast<DefenseBuildingAnimation*>(
-                            buildingSprite->getChildByName("DefenseAnim")
-                            );
-
-                        if (defenseAnim) {
-                            Vec2 unitPosInTroopLayer = currentTarget->getPosition();
-                            Vec2 targetPosInMapLayer = troopLayer->convertToNodeSpace(
-                                troopLayer->getParent()->convertToWorldSpace(unitPosInTroopLayer)
-                            );
-
-                            CCLOG("DefenseSystem: Aiming at target - Unit pos: (%.1f, %.1f)",
-                                  unitPosInTroopLayer.x, unitPosInTroopLayer.y);
-
-                            defenseAnim->playAttackAnimation(targetPosInMapLayer);
-                        }
-                    }
+                // 播放攻击动画（按建筑ID直接取动画，不在地图层按名字查找）
+                auto defenseAnim = BattleViewRegistry::getInstance()->getDefenseAnimation(building.id);
+                if (defenseAnim && troopLayer->getParent()) {
+                    Vec2 unitPosInTroopLayer = currentTarget->getPosition();
+                    Vec2 targetPosInMapLayer = troopLayer->convertToNodeSpace(
+                        troopLayer->getParent()->convertToWorldSpace(unitPosInTroopLayer)
+                    );
+
+                    defenseAnim->playAttackAnimation(targetPosInMapLayer);
                 }
 
-                building.attackCooldown = attackSpeed;
+                attackCooldown = attackSpeed;
 
                 // 目标死亡处理
                 if (currentTarget->isDead()) {
-                    building.lockedTarget = nullptr;
-                    targetedUnitsThisFrame.erase(currentTarget);
+                    lockedTarget = TroopHandle();
+                    targetedUnitsThisFrame.erase(currentTarget->getHandle());
                     currentTarget->setTargetedByBuilding(false);
                     currentTarget->stopAllActions();
 
@@ -247,11 +233,11 @@ void DefenseSystem::updateBuildingDefense(BattleTroopLayer* troopLayer) {
     }
 
     // 更新兵种锁定状态
-    auto allUnits = troopLayer->getAllUnits();
+    const auto& allUnits = troopLayer->getAllUnits();
     for (auto unit : allUnits) {
         if (!unit || unit->isDead()) continue;
 
-        bool shouldBeTargeted = (targetedUnitsThisFrame.find(unit) != targetedUnitsThisFrame.end());
+        bool shouldBeTargeted = (targetedUnitsThisFrame.find(unit->getHandle()) != targetedUnitsThisFrame.end());
         if (unit->isTargetedByBuilding() != shouldBeTargeted) {
             unit->setTargetedByBuilding(shouldBeTargeted);
         }
@@ -11,15 +11,18 @@
 class BattleUnitSprite;
 class BattleTroopLayer;
 struct BuildingInstance;
+struct TroopEntry;
 
 // 建筑防御系统类
 // 职责：防御建筑自动锁定目标、攻击逻辑、播放攻击动画
+// 范围查询使用 TroopSpatialIndex（BattleScene::update 中每帧先重建）
+// 只遍历 BattleBuildingState 的防御建筑下标表，冷却和锁定目标也存放在那里
 class DefenseSystem {
 public:
     static DefenseSystem* getInstance();
     static void destroyInstance();
     
-    // 更新建筑防御（每帧调用）
+    // 更新建筑防御（每个战斗 tick 调用一次）
     void updateBuildingDefense(BattleTroopLayer* troopLayer);
     
     // 查找攻击范围内最近的兵种
@@ -39,6 +42,12 @@ private:
     ~DefenseSystem() = default;
     
     static DefenseSystem* _instance;
+
+    // 范围查询结果缓冲（复用，避免每帧分配）
+    std::vector<const TroopEntry*> _queryBuffer;
+
+    // 查询建筑中心附近的单位（结果写入 _queryBuffer，调用方再按切比雪夫距离精确判断）
+    void queryUnitsInRange(int centerX, int centerY, int range, int layerMask);
 };
 
 #endif // __DEFENSE_SYSTEM_H__
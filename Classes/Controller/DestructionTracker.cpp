@@ -5,6 +5,7 @@
 #include "../Manager/VillageDataManager.h"
 #include "../Model/BuildingConfig.h"
 #include "../Model/VillageData.h"
+#include "../Model/BattleBuildingState.h"
 
 USING_NS_CC;
 
@@ -26,6 +27,7 @@ void DestructionTracker::destroyInstance() {
 
 void DestructionTracker::reset() {
     _totalBuildingHP = 0;
+    _reportedHPRemoved = 0;
     _currentStars = 0;
     _townHallDestroyed = false;
     _star50Awarded = false;
@@ -40,8 +42,13 @@ void DestructionTracker::initTracking() {
     // 重置所有追踪变量
     reset();
 
-    // 计算总血量
+    // 战斗开始：按当前建筑列表重建战斗建筑状态
+    auto& buildings = const_cast<std::vector<BuildingInstance>&>(VillageDataManager::getInstance()->getAllBuildings());
+    BattleBuildingState::getInstance()->build(buildings);
+
+    // 计算总血量；开战前已有的损伤视为已上报
     _totalBuildingHP = calculateTotalBuildingHP();
+    _reportedHPRemoved = BattleBuildingState::getInstance()->getScoredHPRemoved();
 
     CCLOG("========================================");
     CCLOG("DestructionTracker: Destruction tracking initialized");
@@ -54,40 +61,27 @@ void DestructionTracker::initTracking() {
 // ==========================================
 
 int DestructionTracker::calculateTotalBuildingHP() {
-    auto dataManager = VillageDataManager::getInstance();
-    const auto& buildings = dataManager->getAllBuildings();
-
-    int totalHP = 0;
-    int buildingCount = 0;
-
-    for (const auto& building : buildings) {
-        // 跳过城墙（type == 303）
-        if (building.type == 303) continue;
+    auto& buildings = const_cast<std::vector<BuildingInstance>&>(VillageDataManager::getInstance()->getAllBuildings());
+    auto state = BattleBuildingState::getInstance();
+    state->sync(buildings);
 
-        // 跳过陷阱（type >= 400 && type < 500）
-        if (building.type >= 400 && building.type < 500) continue;
+    // 计分下标表已排除城墙、陷阱和未建成的建筑，总血量在建立时已累加
+    int totalHP = state->getScoredTotalHP();
 
-        // 跳过未建造完成的建筑
-        if (building.state != BuildingInstance::State::BUILT) continue;
+    CCLOG("DestructionTracker: Total %zu buildings tracked, Total HP=%d",
+          state->getScored().size(), totalHP);
 
-        // 获取建筑配置
-        auto config = BuildingConfig::getInstance()->getConfig(building.type);
-        if (!config) continue;
-
-        // 累加血量
-        int maxHP = config->hitPoints;
-        if (maxHP > 0) {
-            totalHP += maxHP;
-            buildingCount++;
+    return totalHP;
+}
 
-            CCLOG("  [%d] Type=%d, HP=%d", building.id, building.type, maxHP);
-        }
-    }
+float DestructionTracker::progressFor(int hpRemoved) const {
+    float progress = (hpRemoved / (float)_totalBuildingHP) * 100.0f;
 
-    CCLOG("DestructionTracker: Total %d buildings tracked, Total HP=%d",
-          buildingCount, totalHP);
+    // 限制在 0-100 范围内
+    if (progress < 0.0f) progress = 0.0f;
+    if (progress > 100.0f) progress = 100.0f;
 
-    return totalHP;
+    return progress;
 }
 
 // ==========================================
@@ -96,50 +90,20 @@ int DestructionTracker::calculateTotalBuildingHP() {
 
 void DestructionTracker::updateProgress() {
     // 如果总血量为0，说明没有初始化或没有建筑
-    if (_totalBuildingHP <= 0) {
-        CCLOG("DestructionTracker: Total HP is 0, skipping progress update");
-        return;
-    }
-
-    auto dataManager = VillageDataManager::getInstance();
-    const auto& buildings = dataManager->getAllBuildings();
+    if (_totalBuildingHP <= 0) return;
 
-    // 计算当前剩余血量
-    int currentTotalHP = 0;
-    bool townHallDestroyed = false;
+    // 已损失血量在伤害写入时增量累加，这里只读取
+    auto state = BattleBuildingState::getInstance();
+    int hpRemoved = state->getScoredHPRemoved();
 
-    for (const auto& building : buildings) {
-        // 使用与 calculateTotalBuildingHP 相同的过滤逻辑
-        if (building.type == 303) continue;
-        if (building.type >= 400 && building.type < 500) continue;
-        if (building.state != BuildingInstance::State::BUILT) continue;
+    int townHall = state->getTownHall();
+    bool townHallDestroyed = townHall >= 0 && state->hasFlag(townHall, BATTLE_SCORED) && !state->isAlive(townHall);
 
-        // 检查大本营状态（type == 1）
-        if (building.type == 1 && building.isDestroyed) {
-            townHallDestroyed = true;
-        }
-
-        // 累加当前血量
-        if (!building.isDestroyed && building.currentHP > 0) {
-            currentTotalHP += building.currentHP;
-        }
-    }
+    // 自上次发送以来没有变化
+    if (hpRemoved == _reportedHPRemoved && townHallDestroyed == _townHallDestroyed) return;
+    _reportedHPRemoved = hpRemoved;
 
-    // 计算摧毁进度
-    float progress = ((_totalBuildingHP - currentTotalHP) / (float)_totalBuildingHP) * 100.0f;
-
-    // 限制在 0-100 范围内
-    if (progress < 0.0f) progress = 0.0f;
-    if (progress > 100.0f) progress = 100.0f;
-
-    CCLOG("========================================");
-    CCLOG("DestructionTracker: Progress Updated");
-    CCLOG("  Total HP: %d", _totalBuildingHP);
-    CCLOG("  Current HP: %d", currentTotalHP);
-    CCLOG("  Destroyed HP: %d", _totalBuildingHP - currentTotalHP);
-    CCLOG("  Progress: %.1f%%", progress);
-    CCLOG("  Town Hall Destroyed: %s", townHallDestroyed ? "YES" : "NO");
-    CCLOG("========================================");
+    float progress = progressFor(hpRemoved);
 
     // 先检查星级条件（此时 _townHallDestroyed 还是旧值）
     checkStarConditions(progress, townHallDestroyed);
@@ -249,29 +213,11 @@ void DestructionTracker::checkStarConditions(float progress, bool townHallDestro
 float DestructionTracker::getProgress() {
     if (_totalBuildingHP <= 0) return 0.0f;
 
-    auto dataManager = VillageDataManager::getInstance();
-    const auto& buildings = dataManager->getAllBuildings();
-
-    int currentTotalHP = 0;
-
-    for (const auto& building : buildings) {
-        if (building.type == 303) continue;
-        if (building.type >= 400 && building.type < 500) continue;
-        if (building.state != BuildingInstance::State::BUILT) continue;
-
-        if (!building.isDestroyed && building.currentHP > 0) {
-            currentTotalHP += building.currentHP;
-        }
-    }
-
-    float progress = ((_totalBuildingHP - currentTotalHP) / (float)_totalBuildingHP) * 100.0f;
-
-    if (progress < 0.0f) progress = 0.0f;
-    if (progress > 100.0f) progress = 100.0f;
-
-    return progress;
+    return progressFor(BattleBuildingState::getInstance()->getScoredHPRemoved());
 }
 
 int DestructionTracker::getStars() {
+    // 结算时本帧的伤害可能还没合并上报，先补上
+    updateProgress();
     return _currentStars;
 }
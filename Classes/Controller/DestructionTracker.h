@@ -9,6 +9,7 @@
 
 // 摧毁进度追踪系统类
 // 职责：计算总血量、追踪摧毁进度、检查和发送星级事件
+// 已损失血量由 BattleBuildingState 在伤害写入时增量累加，进度查询为 O(1)
 class DestructionTracker {
 public:
     static DestructionTracker* getInstance();
@@ -20,7 +21,7 @@ public:
     // 计算总血量（排除城墙和陷阱）
     int calculateTotalBuildingHP();
     
-    // 更新摧毁进度（建筑被摧毁时调用）
+    // 合并上报摧毁进度（每帧调用一次，O(1)；自上次上报以来没有变化时不发送事件）
     void updateProgress();
     
     // 获取当前摧毁进度百分比 (0.0-100.0)
@@ -40,8 +41,12 @@ private:
     
     // 检查星级条件并发送事件
     void checkStarConditions(float progress, bool townHallDestroyed);
+
+    // 已损失血量对应的进度百分比
+    float progressFor(int hpRemoved) const;
     
     int _totalBuildingHP = 0;        // 总血量（不含城墙和陷阱）
+    int _reportedHPRemoved = 0;      // 上次上报时的已损失血量
     int _currentStars = 0;           // 当前星数
     bool _townHallDestroyed = false; // 大本营是否已摧毁
     bool _star50Awarded = false;     // 50%星是否已获得
@@ -2,10 +2,13 @@
 // 战斗目标查找器实现，为不同兵种提供智能目标选择策略
 
 #include "TargetFinder.h"
-#include "../Manager/VillageDataManager.h"
 #include "../Model/BuildingConfig.h"
+#include "../Model/BattleBuildingState.h"
 #include "../Util/GridMapUtils.h"
+#include "../Util/FindPathUtil.h"
 #include "../Sprite/BattleUnitSprite.h"
+#include <algorithm>
+#include <cmath>
 
 USING_NS_CC;
 
@@ -25,181 +28,210 @@ void TargetFinder::destroyInstance() {
     }
 }
 
-// 判断是否为资源建筑
-static bool isResourceBuilding(int buildingType) {
-    return buildingType == 1 || buildingType == 202 || buildingType == 203 || 
-           buildingType == 204 || buildingType == 205;
+TargetFinder::TargetFinder()
+    : _indexDirty(true)
+    , _tableWidth(0)
+    , _tableHeight(0) {
+
+    for (auto& table : _tables) {
+        table.built = false;
+    }
+
+    // 被摧毁的建筑从索引和目标表中移除（陷阱不在索引中，会被忽略）
+    _destroyedListener = EventListenerCustom::create("EVENT_BUILDING_DESTROYED", [this](EventCustom* event) {
+        auto building = static_cast<const BuildingInstance*>(event->getUserData());
+        if (building) {
+            onBuildingsDestroyed(std::vector<const BuildingInstance*>(1, building));
+        }
+    });
+    Director::getInstance()->getEventDispatcher()->addEventListenerWithFixedPriority(_destroyedListener, 1);
+
+    _batchDestroyedListener = EventListenerCustom::create("EVENT_BUILDINGS_DESTROYED", [this](EventCustom* event) {
+        auto buildings = static_cast<const std::vector<const BuildingInstance*>*>(event->getUserData());
+        if (buildings && !buildings->empty()) {
+            onBuildingsDestroyed(*buildings);
+        }
+    });
+    Director::getInstance()->getEventDispatcher()->addEventListenerWithFixedPriority(_batchDestroyedListener, 1);
 }
 
-// 判断是否为防御建筑
-static bool isDefenseBuilding(int buildingType) {
-    return buildingType == 301 || buildingType == 302;
+TargetFinder::~TargetFinder() {
+    Director::getInstance()->getEventDispatcher()->removeEventListener(_destroyedListener);
+    Director::getInstance()->getEventDispatcher()->removeEventListener(_batchDestroyedListener);
 }
 
-const BuildingInstance* TargetFinder::findTarget(const Vec2& unitWorldPos, UnitTypeID unitType) {
-    // 炸弹兵：只攻击城墙
-    if (unitType == UnitTypeID::WALL_BREAKER) {
-        return findNearestWall(unitWorldPos);
+void TargetFinder::invalidateIndex() {
+    _indexDirty = true;
+}
+
+const BuildingSpatialIndex& TargetFinder::getIndex() {
+    // 索引直接取战斗建筑状态中预先算好的中心和类别（状态由战斗场景每个 tick 同步）
+    auto state = BattleBuildingState::getInstance();
+    if (_indexDirty || !_index.isBuiltFor(*state)) {
+        _index.build(*state);
+        _indexDirty = false;
+
+        for (auto& table : _tables) {
+            table.built = false;
+        }
     }
-    
-    // 哥布林：资源优先
-    if (unitType == UnitTypeID::GOBLIN) {
-        return findTargetWithResourcePriority(unitWorldPos, unitType);
+    return _index;
+}
+
+// ===================================================================================
+// 预计算目标表
+// ===================================================================================
+
+TargetFinder::TargetPreference TargetFinder::preferenceOf(UnitTypeID unitType) {
+    if (unitType == UnitTypeID::WALL_BREAKER) return TargetPreference::WALL;
+    if (unitType == UnitTypeID::GOBLIN) return TargetPreference::RESOURCE;
+    if (unitType == UnitTypeID::GIANT || unitType == UnitTypeID::BALLOON) return TargetPreference::DEFENSE;
+    return TargetPreference::ANY;
+}
+
+const BuildingInstance* TargetFinder::findByPreference(const BuildingSpatialIndex& index,
+                                                       const Vec2& worldPos, TargetPreference preference) {
+    int resourceMask = BuildingSpatialIndex::categoryBit(BuildingCategory::RESOURCE);
+    int defenseMask = BuildingSpatialIndex::categoryBit(BuildingCategory::DEFENSE);
+    int otherMask = BuildingSpatialIndex::categoryBit(BuildingCategory::OTHER);
+
+    switch (preference) {
+    case TargetPreference::WALL:
+        return index.findNearest(worldPos, BuildingSpatialIndex::categoryBit(BuildingCategory::WALL));
+
+    case TargetPreference::RESOURCE: {
+        // 优先资源建筑，没有时选择最近的非资源建筑
+        const BuildingInstance* building = index.findNearest(worldPos, resourceMask);
+        return building ? building : index.findNearest(worldPos, defenseMask | otherMask);
     }
-    
-    // 巨人、气球：防御优先
-    if (unitType == UnitTypeID::GIANT || unitType == UnitTypeID::BALLOON) {
-        return findTargetWithDefensePriority(unitWorldPos, unitType);
+
+    case TargetPreference::DEFENSE: {
+        // 优先防御建筑，没有时选择最近的非防御建筑（排除城墙）
+        const BuildingInstance* building = index.findNearest(worldPos, defenseMask);
+        return building ? building : index.findNearest(worldPos, resourceMask | otherMask);
+    }
+
+    default:
+        return index.findNearest(worldPos, resourceMask | defenseMask | otherMask);
     }
-    
-    // 其他兵种：资源优先（默认行为）
-    return findTargetWithResourcePriority(unitWorldPos, unitType);
 }
 
-const BuildingInstance* TargetFinder::findTargetWithResourcePriority(const Vec2& unitWorldPos, UnitTypeID unitType) {
-    auto dataManager = VillageDataManager::getInstance();
-    const auto& buildings = dataManager->getAllBuildings();
-
-    if (buildings.empty()) return nullptr;
-
-    const BuildingInstance* bestBuilding = nullptr;
-    const BuildingInstance* fallbackBuilding = nullptr;
-    float minDistanceSq = FLT_MAX;
-    float fallbackMinDistanceSq = FLT_MAX;
-
-    for (const auto& building : buildings) {
-        if (building.isDestroyed || building.currentHP <= 0) continue;
-        if (building.state == BuildingInstance::State::PLACING) continue;
-        
-        // 跳过城墙和陷阱
-        if (building.type == 303) continue;
-        if (building.type >= 400 && building.type < 500) continue;
-
-        auto config = BuildingConfig::getInstance()->getConfig(building.type);
-        if (!config) continue;
-
-        Vec2 bPos = GridMapUtils::getBuildingCenterPixel(
-            building.gridX, building.gridY, 
-            config->gridWidth, config->gridHeight
-        );
-        float distSq = unitWorldPos.distanceSquared(bPos);
-
-        if (unitType == UnitTypeID::GOBLIN) {
-            // 哥布林优先攻击资源建筑
-            if (isResourceBuilding(building.type)) {
-                if (distSq < minDistanceSq) {
-                    minDistanceSq = distSq;
-                    bestBuilding = &building;
-                }
-            } else {
-                // 备选目标：非资源建筑
-                if (distSq < fallbackMinDistanceSq) {
-                    fallbackMinDistanceSq = distSq;
-                    fallbackBuilding = &building;
-                }
-            }
-        } else {
-            // 其他兵种选择最近建筑
-            if (distSq < minDistanceSq) {
-                minDistanceSq = distSq;
-                bestBuilding = &building;
-            }
+const TargetFinder::TargetTable& TargetFinder::getTargetTable(TargetPreference preference) {
+    const BuildingSpatialIndex& index = getIndex();
+
+    // 表尺寸跟随寻路地图（战斗地图可大于 44x44）
+    auto pathfinder = FindPathUtil::getInstance();
+    if (pathfinder->getMapWidth() != _tableWidth || pathfinder->getMapHeight() != _tableHeight) {
+        _tableWidth = pathfinder->getMapWidth();
+        _tableHeight = pathfinder->getMapHeight();
+        for (auto& table : _tables) {
+            table.built = false;
         }
     }
 
-    // 哥布林如果没找到资源建筑，使用备选目标
-    if (unitType == UnitTypeID::GOBLIN && !bestBuilding && fallbackBuilding) {
-        return fallbackBuilding;
+    TargetTable& table = _tables[static_cast<int>(preference)];
+    if (!table.built) {
+        table.nearest.assign(_tableWidth * _tableHeight, nullptr);
+        table.cellsByBuilding.assign(BattleBuildingState::getInstance()->size(), std::vector<int>());
+        for (int y = 0; y < _tableHeight; ++y) {
+            for (int x = 0; x < _tableWidth; ++x) {
+                assignCell(table, y * _tableWidth + x,
+                           findByPreference(index, GridMapUtils::gridToPixelCenter(x, y), preference));
+            }
+        }
+        table.built = true;
     }
+    return table;
+}
+
+void TargetFinder::assignCell(TargetTable& table, int cell, const BuildingInstance* target) {
+    table.nearest[cell] = target;
+    if (!target) return;
 
-    return bestBuilding;
+    int owner = BattleBuildingState::getInstance()->indexOf(target->id);
+    if (owner >= 0 && owner < static_cast<int>(table.cellsByBuilding.size())) {
+        table.cellsByBuilding[owner].push_back(cell);
+    }
 }
 
-const BuildingInstance* TargetFinder::findTargetWithDefensePriority(const Vec2& unitWorldPos, UnitTypeID unitType) {
-    auto dataManager = VillageDataManager::getInstance();
-    const auto& buildings = dataManager->getAllBuildings();
-
-    if (buildings.empty()) return nullptr;
-
-    const BuildingInstance* bestBuilding = nullptr;
-    const BuildingInstance* fallbackBuilding = nullptr;
-    float minDistanceSq = FLT_MAX;
-    float fallbackMinDistanceSq = FLT_MAX;
-
-    for (const auto& building : buildings) {
-        if (building.isDestroyed || building.currentHP <= 0) continue;
-        if (building.state == BuildingInstance::State::PLACING) continue;
-        
-        // 跳过城墙和陷阱
-        if (building.type == 303) continue;
-        if (building.type >= 400 && building.type < 500) continue;
-        
-        // 气球兵额外跳过城墙
-        if (unitType == UnitTypeID::BALLOON && building.type == 303) continue;
-
-        auto config = BuildingConfig::getInstance()->getConfig(building.type);
-        if (!config) continue;
-
-        Vec2 bPos = GridMapUtils::getBuildingCenterPixel(
-            building.gridX, building.gridY, 
-            config->gridWidth, config->gridHeight
-        );
-        float distSq = unitWorldPos.distanceSquared(bPos);
-
-        if (unitType == UnitTypeID::GIANT || unitType == UnitTypeID::BALLOON) {
-            // 巨人、气球优先攻击防御建筑
-            if (isDefenseBuilding(building.type)) {
-                if (distSq < minDistanceSq) {
-                    minDistanceSq = distSq;
-                    bestBuilding = &building;
-                }
-            } else {
-                // 备选目标：非防御建筑（排除城墙）
-                if (building.type != 303) {
-                    if (distSq < fallbackMinDistanceSq) {
-                        fallbackMinDistanceSq = distSq;
-                        fallbackBuilding = &building;
-                    }
-                }
-            }
-        } else {
-            // 其他兵种选择最近建筑
-            if (distSq < minDistanceSq) {
-                minDistanceSq = distSq;
-                bestBuilding = &building;
+void TargetFinder::onBuildingsDestroyed(const std::vector<const BuildingInstance*>& buildings) {
+    for (const BuildingInstance* building : buildings) {
+        _index.remove(building);
+    }
+
+    // 索引待重建时目标表也会随之重建；建筑状态已重建时下标不再对应，同样等待重建
+    auto state = BattleBuildingState::getInstance();
+    if (_indexDirty || !_index.isBuiltFor(*state)) return;
+
+    for (int p = 0; p < static_cast<int>(TargetPreference::COUNT); ++p) {
+        TargetTable& table = _tables[p];
+        if (!table.built) continue;
+
+        // 只重算登记在被摧毁建筑名下的格子（索引已先移除整批建筑，新目标必定存活）
+        for (const BuildingInstance* building : buildings) {
+            int owner = state->indexOf(building->id);
+            if (owner < 0 || owner >= static_cast<int>(table.cellsByBuilding.size())) continue;
+
+            std::vector<int> cells;
+            cells.swap(table.cellsByBuilding[owner]);
+            for (int cell : cells) {
+                if (table.nearest[cell] != building) continue;
+
+                int x = cell % _tableWidth;
+                int y = cell / _tableWidth;
+                assignCell(table, cell, findByPreference(_index, GridMapUtils::gridToPixelCenter(x, y),
+                                                         static_cast<TargetPreference>(p)));
             }
         }
     }
+}
+
+// ===================================================================================
+// 目标查找
+// ===================================================================================
 
-    // 如果没找到防御建筑，使用备选目标
-    if ((unitType == UnitTypeID::GIANT || unitType == UnitTypeID::BALLOON) && !bestBuilding && fallbackBuilding) {
-        return fallbackBuilding;
+const BuildingInstance* TargetFinder::findTarget(const Vec2& unitWorldPos, UnitTypeID unitType) {
+    const TargetTable& table = getTargetTable(preferenceOf(unitType));
+
+    Vec2 gridPos = GridMapUtils::pixelToGrid(unitWorldPos);
+    int gridX = static_cast<int>(std::floor(gridPos.x));
+    int gridY = static_cast<int>(std::floor(gridPos.y));
+
+    if (gridX >= 0 && gridX < _tableWidth && gridY >= 0 && gridY < _tableHeight) {
+        return table.nearest[gridY * _tableWidth + gridX];
     }
 
-    return bestBuilding;
+    // 单位在地图外（如刚从边缘投放）
+    return findTargetExact(unitWorldPos, unitType);
+}
+
+const BuildingInstance* TargetFinder::findTargetExact(const Vec2& unitWorldPos, UnitTypeID unitType) {
+    // 炸弹兵只攻击城墙；哥布林资源优先；巨人、气球防御优先；其他兵种选择最近建筑
+    return findByPreference(getIndex(), unitWorldPos, preferenceOf(unitType));
+}
+
+const BuildingInstance* TargetFinder::findTargetWithResourcePriority(const Vec2& unitWorldPos, UnitTypeID unitType) {
+    // 哥布林优先攻击资源建筑，其他兵种选择最近建筑（城墙和陷阱除外）
+    TargetPreference preference = (unitType == UnitTypeID::GOBLIN) ? TargetPreference::RESOURCE : TargetPreference::ANY;
+    return findByPreference(getIndex(), unitWorldPos, preference);
+}
+
+const BuildingInstance* TargetFinder::findTargetWithDefensePriority(const Vec2& unitWorldPos, UnitTypeID unitType) {
+    // 巨人、气球优先攻击防御建筑，其他兵种选择最近建筑（城墙和陷阱除外）
+    TargetPreference preference = (unitType == UnitTypeID::GIANT || unitType == UnitTypeID::BALLOON)
+        ? TargetPreference::DEFENSE : TargetPreference::ANY;
+    return findByPreference(getIndex(), unitWorldPos, preference);
 }
 
 const BuildingInstance* TargetFinder::findNearestWall(const Vec2& unitWorldPos) {
-    auto dataManager = VillageDataManager::getInstance();
-    const auto& buildings = dataManager->getAllBuildings();
-    
-    const BuildingInstance* nearestWall = nullptr;
-    float minDistanceSq = FLT_MAX;
-    
-    for (const auto& building : buildings) {
-        // 只查找城墙（type=303）
-        if (building.type != 303) continue;
-        if (building.isDestroyed || building.currentHP <= 0) continue;
-        if (building.state == BuildingInstance::State::PLACING) continue;
-        
-        Vec2 bPos = GridMapUtils::gridToPixelCenter(building.gridX, building.gridY);
-        float distSq = unitWorldPos.distanceSquared(bPos);
-        
-        if (distSq < minDistanceSq) {
-            minDistanceSq = distSq;
-            nearestWall = &building;
-        }
+    return findByPreference(getIndex(), unitWorldPos, TargetPreference::WALL);
+}
+
+void TargetFinder::findBuildingsInRadius(const Vec2& gridCenter, float radius,
+                                         std::vector<const BuildingInstance*>& out) {
+    int allCategories = 0;
+    for (int c = 0; c < static_cast<int>(BuildingCategory::COUNT); ++c) {
+        allCategories |= BuildingSpatialIndex::categoryBit(static_cast<BuildingCategory>(c));
     }
-    
-    return nearestWall;
+    getIndex().findInRadius(gridCenter, radius, allCategories, out);
 }
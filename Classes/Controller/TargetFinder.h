@@ -5,6 +5,8 @@
 #define __TARGET_FINDER_H__
 
 #include "cocos2d.h"
+#include "../Util/BuildingSpatialIndex.h"
+#include <vector>
 
 struct BuildingInstance;
 enum class UnitTypeID;
@@ -13,6 +15,15 @@ enum class UnitTypeID;
  * 战斗目标查找器类
  * 
  * 职责：为不同兵种找到合适的攻击目标、根据优先级选择目标
+ *
+ * 查找通过 BuildingSpatialIndex 进行：BattleBuildingState 重建后首次查询时随之重建
+ * （BattleBuildingState 由战斗场景每个 tick 同步一次，查询时不再同步），
+ * 收到 EVENT_BUILDING_DESTROYED / EVENT_BUILDINGS_DESTROYED（一次爆炸摧毁的一批建筑）时移除被摧毁的建筑
+ *
+ * 目标选择只取决于单位位置和兵种偏好，因此 findTarget() 为每种偏好
+ * 预先算好"每格最近目标"表，查询只是一次查表。
+ * 每张表同时记录每个建筑被哪些格子指向，建筑被摧毁时只重算这些格子。
+ * 表按格子中心计算，同一格内的单位共用一个目标。
  */
 class TargetFinder {
 public:
@@ -21,9 +32,12 @@ public:
 
     // ========== 目标查找接口 ==========
     
-    // 通用入口：根据兵种类型自动选择策略
+    // 通用入口：根据兵种类型自动选择策略（查预计算的目标表，地图外退回精确查找）
     const BuildingInstance* findTarget(const cocos2d::Vec2& unitWorldPos, UnitTypeID unitType);
 
+    // 精确查找：按单位的实际坐标比较距离
+    const BuildingInstance* findTargetExact(const cocos2d::Vec2& unitWorldPos, UnitTypeID unitType);
+
     // 资源优先查找（哥布林等）
     const BuildingInstance* findTargetWithResourcePriority(const cocos2d::Vec2& unitWorldPos, UnitTypeID unitType);
     
@@ -33,11 +47,61 @@ public:
     // 查找最近城墙（炸弹兵专用）
     const BuildingInstance* findNearestWall(const cocos2d::Vec2& unitWorldPos);
 
+    // 查找占地与圆相交的存活建筑（溅射伤害，圆心为网格坐标，半径为格子单位）
+    void findBuildingsInRadius(const cocos2d::Vec2& gridCenter, float radius,
+                               std::vector<const BuildingInstance*>& out);
+
+    // 建筑列表被重新加载或批量修改后调用，下次查询时重建索引
+    void invalidateIndex();
+
 private:
-    TargetFinder() = default;
-    ~TargetFinder() = default;
+    TargetFinder();
+    ~TargetFinder();
     
     static TargetFinder* _instance;
+
+    // 兵种的目标偏好
+    enum class TargetPreference {
+        RESOURCE = 0,   // 资源优先（哥布林）
+        DEFENSE = 1,    // 防御优先（巨人、气球）
+        WALL = 2,       // 只打城墙（炸弹兵）
+        ANY = 3,        // 最近的非城墙建筑（其他兵种）
+        COUNT = 4
+    };
+
+    // 每格最近目标表
+    struct TargetTable {
+        std::vector<const BuildingInstance*> nearest;   // 按 y * 宽 + x 存放，nullptr 表示没有目标
+        std::vector<std::vector<int>> cellsByBuilding;  // 按 BattleBuildingState 下标存放指向该建筑的格子
+        bool built;
+    };
+
+    BuildingSpatialIndex _index;
+    bool _indexDirty;
+    cocos2d::EventListenerCustom* _destroyedListener;
+    cocos2d::EventListenerCustom* _batchDestroyedListener;
+
+    TargetTable _tables[static_cast<int>(TargetPreference::COUNT)];
+    int _tableWidth;
+    int _tableHeight;
+
+    // 确保索引与当前建筑列表一致（重建索引时目标表一并失效）
+    const BuildingSpatialIndex& getIndex();
+
+    static TargetPreference preferenceOf(UnitTypeID unitType);
+
+    // 按偏好在索引中查找（含找不到首选类别时的备选）
+    static const BuildingInstance* findByPreference(const BuildingSpatialIndex& index,
+                                                    const cocos2d::Vec2& worldPos, TargetPreference preference);
+
+    // 获取（必要时构建）某偏好的目标表
+    const TargetTable& getTargetTable(TargetPreference preference);
+
+    // 设置格子的目标，并登记到目标建筑的格子列表
+    static void assignCell(TargetTable& table, int cell, const BuildingInstance* target);
+
+    // 建筑被摧毁：移出索引，只重算目标表中登记在它们名下的格子
+    void onBuildingsDestroyed(const std::vector<const BuildingInstance*>& buildings);
 };
 
 #endif // __TARGET_FINDER_H__
@@ -2,11 +2,18 @@
 // 陷阱系统实现，管理陷阱的触发检测和爆炸逻辑
 
 #include "TrapSystem.h"
+#include "BattleClock.h"
 #include "../Layer/BattleTroopLayer.h"
 #include "../Manager/VillageDataManager.h"
+#include "../Manager/BattleViewRegistry.h"
+#include "../Manager/BattleNodePool.h"
 #include "../Model/BuildingConfig.h"
+#include "../Model/BattleBuildingState.h"
 #include "../Util/GridMapUtils.h"
+#include "../Util/TroopSpatialIndex.h"
 #include "../Sprite/BattleUnitSprite.h"
+#include "../Sprite/BuildingSprite.h"
+#include <algorithm>
 
 USING_NS_CC;
 
@@ -26,9 +33,65 @@ void TrapSystem::destroyInstance() {
     }
 }
 
+TrapSystem::TrapSystem()
+    : _cellIndexVersion(0) {
+}
+
 void TrapSystem::reset() {
-    _triggeredTraps.clear();
-    _trapTimers.clear();
+    _armed.clear();
+    _trapAtCell.clear();
+    _cellIndexVersion = 0;
+}
+
+// ===================================================================================
+// 格子索引
+// ===================================================================================
+
+void TrapSystem::ensureCellIndex() {
+    // 建筑状态由战斗场景每个 tick 同步一次，这里只比较版本
+    auto state = BattleBuildingState::getInstance();
+    if (_cellIndexVersion == state->getVersion()) return;
+
+    _cellIndexVersion = state->getVersion();
+    _armed.clear();
+    _trapAtCell.assign(GridMapUtils::GRID_WIDTH * GridMapUtils::GRID_HEIGHT, -1);
+
+    // 只登记尚未引爆的炸弹（401）和巨型炸弹（404）
+    int count = 0;
+    for (int index : state->getTraps()) {
+        if (!state->isAlive(index)) continue;
+
+        BuildingInstance& trap = state->getBuilding(index);
+        if (trap.type != 401 && trap.type != 404) continue;
+
+        fillTrapCells(trap, state->getGridWidth(index), state->getGridHeight(index), index);
+        count++;
+    }
+
+    CCLOG("TrapSystem: Cell index built for %d traps", count);
+}
+
+void TrapSystem::fillTrapCells(const BuildingInstance& trap, int width, int height, int index) {
+    for (int y = trap.gridY; y < trap.gridY + height; ++y) {
+        for (int x = trap.gridX; x < trap.gridX + width; ++x) {
+            if (!GridMapUtils::isValidGridPosition(x, y)) continue;
+            _trapAtCell[y * GridMapUtils::GRID_WIDTH + x] = index;
+        }
+    }
+}
+
+void TrapSystem::queryUnitsOnTrap(const BuildingInstance& trap) {
+    // 炸弹（401）占 1x1，巨型炸弹（404）占 2x2；气球兵是飞行单位，不会触发也不受伤害
+    int size = (trap.type == 404) ? 2 : 1;
+    TroopSpatialIndex::getInstance()->queryRect(
+        trap.gridX, trap.gridY,
+        trap.gridX + size - 1, trap.gridY + size - 1,
+        TroopSpatialIndex::LAYER_GROUND, _queryBuffer);
+
+    // 按单位列表顺序处理
+    std::sort(_queryBuffer.begin(), _queryBuffer.end(), [](const TroopEntry* a, const TroopEntry* b) {
+        return a->order < b->order;
+    });
 }
 
 bool TrapSystem::isUnitInTrapRange(const BuildingInstance& trap, BattleUnitSprite* unit) {
@@ -55,75 +118,71 @@ bool TrapSystem::isUnitInTrapRange(const BuildingInstance& trap, BattleUnitSprit
     return false;
 }
 
+// ===================================================================================
+// 触发与倒计时
+// ===================================================================================
+
+void TrapSystem::onUnitEnteredCell(int cellX, int cellY) {
+    if (!GridMapUtils::isValidGridPosition(cellX, cellY)) return;
+
+    ensureCellIndex();
+
+    int index = _trapAtCell[cellY * GridMapUtils::GRID_WIDTH + cellX];
+    if (index < 0) return;
+
+    auto state = BattleBuildingState::getInstance();
+    if (!state->isAlive(index)) return;
+
+    BuildingInstance& trap = state->getBuilding(index);
+
+    // 触发陷阱，开始倒计时；从索引中移除，之后踩上来的单位不再重复触发
+    CCLOG("TrapSystem: Trap %d (type=%d) triggered by unit at grid(%d, %d)!",
+          trap.id, trap.type, cellX, cellY);
+
+    fillTrapCells(trap, state->getGridWidth(index), state->getGridHeight(index), -1);
+
+    ArmedTrap armed;
+    armed.index = index;
+    armed.timer = TRIGGER_DELAY;
+    _armed.push_back(armed);
+
+    // 显示陷阱
+    auto trapSprite = BattleViewRegistry::getInstance()->getBuildingSprite(trap.id);
+    if (trapSprite) {
+        trapSprite->setVisible(true);
+        CCLOG("TrapSystem: Trap %d now VISIBLE!", trap.id);
+    }
+}
+
 void TrapSystem::updateTrapDetection(BattleTroopLayer* troopLayer) {
-    if (!troopLayer) return;
-    
-    auto dataManager = VillageDataManager::getInstance();
-    auto& buildings = const_cast<std::vector<BuildingInstance>&>(dataManager->getAllBuildings());
-    float deltaTime = Director::getInstance()->getDeltaTime();
-    
-    auto allUnits = troopLayer->getAllUnits();
-    if (allUnits.empty()) return;
-    
-    // 遍历所有陷阱
-    for (auto& building : buildings) {
-        // 只处理陷阱（401: 炸弹, 404: 巨型炸弹）
-        if (building.type != 401 && building.type != 404) continue;
-        
-        // 跳过已摧毁或已触发的陷阱
-        if (building.isDestroyed || building.currentHP <= 0) continue;
-        
-        int trapId = building.id;
-        
-        // 检查陷阱是否已触发（正在倒计时）
-        if (_triggeredTraps.find(trapId) != _triggeredTraps.end()) {
-            // 更新计时器
-            _trapTimers[trapId] -= deltaTime;
-            
-            if (_trapTimers[trapId] <= 0.0f) {
-                // 时间到，执行爆炸
-                CCLOG("TrapSystem: Trap %d exploding!", trapId);
-                explodeTrap(&building, troopLayer);
-                
-                // 清除触发状态
-                _triggeredTraps.erase(trapId);
-                _trapTimers.erase(trapId);
-            }
+    if (!troopLayer || _armed.empty()) return;
+
+    // 建筑状态重建过则倒计时已失效
+    ensureCellIndex();
+
+    // 每个战斗 tick 调用一次，引爆倒计时按固定步长递减
+    const float deltaTime = BattleClock::TICK_SECONDS;
+    auto state = BattleBuildingState::getInstance();
+
+    // 按触发顺序推进，未到时的陷阱原地压紧
+    size_t kept = 0;
+    for (size_t k = 0; k < _armed.size(); ++k) {
+        ArmedTrap armed = _armed[k];
+        armed.timer -= deltaTime;
+
+        if (armed.timer > 0.0f) {
+            _armed[kept++] = armed;
             continue;
         }
-        
-        // 检查是否有兵种进入陷阱范围
-        for (auto unit : allUnits) {
-            if (!unit || unit->isDead()) continue;
-            
-            // 气球兵是飞行单位，不会触发地面陷阱
-            if (unit->getUnitTypeID() == UnitTypeID::BALLOON) continue;
-            
-            if (isUnitInTrapRange(building, unit)) {
-                // 触发陷阱，开始0.5秒倒计时
-                CCLOG("TrapSystem: Trap %d (type=%d) triggered by unit at grid(%d, %d)!",
-                      trapId, building.type,
-                      static_cast<int>(unit->getGridPosition().x),
-                      static_cast<int>(unit->getGridPosition().y));
-                
-                _triggeredTraps.insert(trapId);
-                _trapTimers[trapId] = 0.5f;
-                
-                // 显示陷阱
-                auto mapLayer = troopLayer->getParent();
-                if (mapLayer) {
-                    std::string spriteName = "Building_" + std::to_string(trapId);
-                    auto trapSprite = mapLayer->getChildByName(spriteName);
-                    if (trapSprite) {
-                        trapSprite->setVisible(true);
-                        CCLOG("TrapSystem: Trap %d now VISIBLE!", trapId);
-                    }
-                }
-                
-                break;
-            }
+
+        if (state->isAlive(armed.index)) {
+            // 时间到，执行爆炸
+            BuildingInstance& trap = state->getBuilding(armed.index);
+            CCLOG("TrapSystem: Trap %d exploding!", trap.id);
+            explodeTrap(&trap, troopLayer);
         }
     }
+    _armed.resize(kept);
 }
 
 void TrapSystem::explodeTrap(BuildingInstance* trap, BattleTroopLayer* troopLayer) {
@@ -138,17 +197,12 @@ void TrapSystem::explodeTrap(BuildingInstance* trap, BattleTroopLayer* troopLaye
           trap->id, trap->type, damage);
     
     // 获取所有在范围内的兵种
-    auto allUnits = troopLayer->getAllUnits();
+    queryUnitsOnTrap(*trap);
     std::vector<BattleUnitSprite*> affectedUnits;
     
-    for (auto unit : allUnits) {
-        if (!unit || unit->isDead()) continue;
-        
-        // 气球兵不受地面陷阱伤害
-        if (unit->getUnitTypeID() == UnitTypeID::BALLOON) continue;
-        
-        if (isUnitInTrapRange(*trap, unit)) {
-            affectedUnits.push_back(unit);
+    for (const TroopEntry* entry : _queryBuffer) {
+        if (isUnitInTrapRange(*trap, entry->unit)) {
+            affectedUnits.push_back(entry->unit);
         }
     }
     
@@ -177,19 +231,16 @@ void TrapSystem::explodeTrap(BuildingInstance* trap, BattleTroopLayer* troopLaye
         trapPixelPos = GridMapUtils::gridToPixelCenter(trap->gridX, trap->gridY + 1);
     }
     
-    auto explosion = ParticleExplosion::create();
-    explosion->setPosition(trapPixelPos);
-    explosion->setDuration(0.3f);
-    
     // 巨型炸弹爆炸更大
     float scale = (trap->type == 404) ? 0.6f : 0.3f;
-    explosion->setScale(scale);
-    explosion->setAutoRemoveOnFinish(true);
-    troopLayer->getParent()->addChild(explosion, 1000);
+    BattleNodePool::getInstance()->playExplosion(troopLayer->getParent(), trapPixelPos, 0.3f, scale, 1000);
     
     // 标记陷阱为已摧毁
-    trap->isDestroyed = true;
-    trap->currentHP = 0;
+    auto state = BattleBuildingState::getInstance();
+    int index = state->indexOf(trap->id);
+    if (index >= 0) {
+        state->destroy(index);
+    }
     
     // 发送陷阱摧毁事件
     Director::getInstance()->getEventDispatcher()->dispatchCustomEvent(
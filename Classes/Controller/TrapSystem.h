@@ -5,35 +5,65 @@
 #define __TRAP_SYSTEM_H__
 
 #include "cocos2d.h"
-#include <set>
-#include <map>
+#include <vector>
 
 class BattleUnitSprite;
 class BattleTroopLayer;
 struct BuildingInstance;
+struct TroopEntry;
 
 // 陷阱系统类
 // 职责：检测兵种是否踩到陷阱、管理触发延迟、执行爆炸逻辑
+//
+// 陷阱按占地格子建立 格子 -> 陷阱 的索引（每场战斗建立一次），
+// 地面单位进入新格子时才查一次表，触发后陷阱从索引中移除；
+// 倒计时中的陷阱放在一个小数组里，每个 tick 只推进这些陷阱。
+// 开销与单位跨格次数成正比，而不是每个 tick 陷阱数 x 单位数。
 class TrapSystem {
 public:
     static TrapSystem* getInstance();
     static void destroyInstance();
     
-    // 更新陷阱检测（每帧调用）
+    // 推进已触发陷阱的倒计时，到时引爆（每个战斗 tick 调用一次）
     void updateTrapDetection(BattleTroopLayer* troopLayer);
+
+    // 地面单位进入新格子（单位移动后由 BattleProcessController 调用），该格有未触发的陷阱时触发
+    void onUnitEnteredCell(int cellX, int cellY);
     
     // 重置陷阱状态（战斗开始时调用）
     void reset();
 
 private:
-    TrapSystem() = default;
+    TrapSystem();
     ~TrapSystem() = default;
     
     static TrapSystem* _instance;
-    
-    // 陷阱触发追踪
-    std::set<int> _triggeredTraps;       // 已触发的陷阱ID
-    std::map<int, float> _trapTimers;    // 陷阱ID -> 剩余延迟时间
+
+    // 触发到引爆的延迟（秒）
+    static constexpr float TRIGGER_DELAY = 0.5f;
+
+    // 倒计时中的陷阱
+    struct ArmedTrap {
+        int index;          // BattleBuildingState 下标
+        float timer;        // 剩余延迟时间
+    };
+    std::vector<ArmedTrap> _armed;
+
+    // 格子 -> 未触发陷阱的下标（-1 表示没有），按 y * 宽 + x 存放
+    std::vector<int> _trapAtCell;
+    unsigned int _cellIndexVersion;      // 建立索引时 BattleBuildingState 的版本号，0 表示未建立
+
+    // 范围查询结果缓冲（复用，避免每帧分配）
+    std::vector<const TroopEntry*> _queryBuffer;
+
+    // 战斗建筑状态重建后重新建立格子索引（倒计时中的下标随之失效）
+    void ensureCellIndex();
+
+    // 把陷阱占用的格子写入索引（index = -1 时清除）
+    void fillTrapCells(const BuildingInstance& trap, int width, int height, int index);
+
+    // 从 TroopSpatialIndex 查询站在陷阱格子上的地面单位（结果写入 _queryBuffer）
+    void queryUnitsOnTrap(const BuildingInstance& trap);
     
     // 检查兵种是否在陷阱范围内
     bool isUnitInTrapRange(const BuildingInstance& trap, BattleUnitSprite* unit);
@@ -6,6 +6,9 @@
 #include "Manager/VillageDataManager.h"
 #include "Controller/MoveMapController.h"
 #include "Util/GridMapUtils.h"
+#include "Util/FindPathUtil.h"
+#include "Controller/TargetFinder.h"
+#include "Model/BattleBuildingState.h"
 
 USING_NS_CC;
 
@@ -93,6 +96,12 @@ void BattleMapLayer::reloadMap() {
     // 创建新的BuildingManager
     _buildingManager = new BuildingManager(this, true);
 
+    // 同步占用表和寻路地图（尺寸随战斗地图变化，同时使旧地图的缓存失效）
+    VillageDataManager::getInstance()->updateBattleGridOccupancy();
+    FindPathUtil::getInstance()->updatePathfindingMap();
+    BattleBuildingState::getInstance()->invalidate();
+    TargetFinder::getInstance()->invalidateIndex();
+
     // 输出建筑布局
     logBuildingLayout("RELOAD MAP");
 
@@ -221,6 +230,12 @@ void BattleMapLayer::reloadMapFromData() {
     // 创建新的BuildingManager（从VillageDataManager读取当前数据）
     _buildingManager = new BuildingManager(this, true);
 
+    // 同步占用表和寻路地图（尺寸随战斗地图变化，同时使旧地图的缓存失效）
+    VillageDataManager::getInstance()->updateBattleGridOccupancy();
+    FindPathUtil::getInstance()->updatePathfindingMap();
+    BattleBuildingState::getInstance()->invalidate();
+    TargetFinder::getInstance()->invalidateIndex();
+
     // 输出建筑布局
     logBuildingLayout("REPLAY MAP LOADED");
 
@@ -4,6 +4,8 @@
 #include "BattleTroopLayer.h"
 #include "../Manager/AnimationManager.h"
 #include "../Util/GridMapUtils.h"
+#include "../Manager/VillageDataManager.h"
+#include "../Manager/BattleNodePool.h"
 
 USING_NS_CC;
 
@@ -31,14 +33,16 @@ bool BattleTroopLayer::init() {
 }
 
 BattleUnitSprite* BattleTroopLayer::spawnUnit(const std::string& unitType, int gridX, int gridY) {
-    // 边界检查
-    if (gridX < 0 || gridX >= GRID_WIDTH || gridY < 0 || gridY >= GRID_HEIGHT) {
+    // 边界检查（战斗地图尺寸是运行时属性）
+    auto dataManager = VillageDataManager::getInstance();
+    if (gridX < 0 || gridX >= dataManager->getBattleGridWidth() ||
+        gridY < 0 || gridY >= dataManager->getBattleGridHeight()) {
         CCLOG("BattleTroopLayer: Invalid grid position (%d, %d)", gridX, gridY);
         return nullptr;
     }
     
-    // 创建单位
-    auto unit = BattleUnitSprite::create(unitType);
+    // 从节点池取出单位（池为空时才创建）
+    auto unit = BattleNodePool::getInstance()->acquireUnit(unitType);
     if (!unit) {
         CCLOG("BattleTroopLayer: Failed to create unit '%s'", unitType.c_str());
         return nullptr;
@@ -66,6 +70,7 @@ BattleUnitSprite* BattleTroopLayer::spawnUnit(const std::string& unitType, int g
         this->addChild(unit, zOrder); 
     }
     _units.push_back(unit);
+    unit->setHandle(allocateHandle(unit));
     
     CCLOG("BattleTroopLayer: Spawned %s at grid(%d, %d)", unitType.c_str(), gridX, gridY);
     return unit;
@@ -73,9 +78,12 @@ BattleUnitSprite* BattleTroopLayer::spawnUnit(const std::string& unitType, int g
 
 void BattleTroopLayer::spawnUnitsGrid(const std::string& unitType, int spacing) {
     int count = 0;
+    auto dataManager = VillageDataManager::getInstance();
+    int gridWidth = dataManager->getBattleGridWidth();
+    int gridHeight = dataManager->getBattleGridHeight();
     
-    for (int gridY = 0; gridY < GRID_HEIGHT; gridY += spacing) {
-        for (int gridX = 0; gridX < GRID_WIDTH; gridX += spacing) {
+    for (int gridY = 0; gridY < gridHeight; gridY += spacing) {
+        for (int gridX = 0; gridX < gridWidth; gridX += spacing) {
             if (spawnUnit(unitType, gridX, gridY)) {
                 count++;
             }
@@ -86,8 +94,10 @@ void BattleTroopLayer::spawnUnitsGrid(const std::string& unitType, int spacing)
 }
 
 void BattleTroopLayer::removeAllUnits() {
+    auto pool = BattleNodePool::getInstance();
     for (auto unit : _units) {
-        this->removeChild(unit);
+        releaseHandle(unit);
+        pool->recycleUnit(unit);
     }
     _units.clear();
     CCLOG("BattleTroopLayer: Removed all units");
@@ -107,143 +117,119 @@ void BattleTroopLayer::removeUnit(BattleUnitSprite* unit) {
     CCLOG("BattleTroopLayer::removeUnit - START: Removing unit %s at position (%.1f, %.1f)", 
           unitType.c_str(), posX, posY);
     
+    // 回收槽位，其他系统持有的句柄随之失效
+    releaseHandle(unit);
+    
     // 从列表中移除
     auto it = std::find(_units.begin(), _units.end(), unit);
     if (it != _units.end()) {
         _units.erase(it);
         CCLOG("BattleTroopLayer::removeUnit - Unit removed from _units vector (size now: %zu)", _units.size());
     } else {
+        // 已被移除过（多个击杀方各自回调），不能重复回收
         CCLOG("BattleTroopLayer::removeUnit - WARNING: Unit not found in _units vector!");
+        return;
     }
     
-    // 从显示树移除
-    auto mapLayer = this->getParent();
-    CCLOG("BattleTroopLayer::removeUnit - MapLayer: %p", mapLayer);
+    // 从显示树移除并回收到节点池（不论挂在地图层还是本层）
+    BattleNodePool::getInstance()->recycleUnit(unit);
     
-    if (mapLayer) {
-        Node* unitParent = unit->getParent();
-        CCLOG("BattleTroopLayer::removeUnit - Unit's parent: %p (MapLayer: %p)", unitParent, mapLayer);
-        
-        if (unitParent == mapLayer) {
-            CCLOG("BattleTroopLayer::removeUnit - Removing from MapLayer...");
-            mapLayer->removeChild(unit);
-            CCLOG("BattleTroopLayer::removeUnit - Successfully removed from MapLayer");
-        } else {
-            CCLOG("BattleTroopLayer::removeUnit - Unit parent mismatch, removing from TroopLayer...");
-            this->removeChild(unit);
-            CCLOG("BattleTroopLayer::removeUnit - Successfully removed from TroopLayer");
-        }
+    CCLOG("BattleTroopLayer::removeUnit - COMPLETE: Unit %s removed successfully", unitType.c_str());
+}
+
+TroopHandle BattleTroopLayer::allocateHandle(BattleUnitSprite* unit) {
+    uint32_t index;
+    if (_freeSlots.empty()) {
+        index = static_cast<uint32_t>(_slots.size());
+        TroopSlot slot = { nullptr, 1 };
+        _slots.push_back(slot);
     } else {
-        CCLOG("BattleTroopLayer::removeUnit - No MapLayer, removing from TroopLayer...");
-        this->removeChild(unit);
-        CCLOG("BattleTroopLayer::removeUnit - Successfully removed from TroopLayer");
+        index = _freeSlots.back();
+        _freeSlots.pop_back();
     }
     
-    CCLOG("BattleTroopLayer::removeUnit - COMPLETE: Unit %s removed successfully", unitType.c_str());
+    _slots[index].unit = unit;
+    
+    TroopHandle handle;
+    handle.index = index;
+    handle.generation = _slots[index].generation;
+    return handle;
 }
 
-void BattleTroopLayer::spawnTombstone(const Vec2& position, UnitTypeID unitType) {
-    CCLOG("===== TOMBSTONE DEBUG START =====");
-    CCLOG("BattleTroopLayer::spawnTombstone - Creating tombstone at (%.1f, %.1f)", position.x, position.y);
-
-    Sprite* tombstone = nullptr;
+void BattleTroopLayer::releaseHandle(BattleUnitSprite* unit) {
+    TroopHandle handle = unit->getHandle();
+    if (resolveUnit(handle) != unit) return;
+    
+    TroopSlot& slot = _slots[handle.index];
+    slot.unit = nullptr;
+    
+    // 代数加一使旧句柄失效（跳过保留给空句柄的 0）
+    slot.generation++;
+    if (slot.generation == 0) slot.generation = 1;
+    
+    _freeSlots.push_back(handle.index);
+    unit->setHandle(TroopHandle());
+}
 
-    // 根据兵种类型加载墓碑图片
-    if (unitType == UnitTypeID::BALLOON) {
-        // 气球兵使用独立墓碑图片
-        tombstone = Sprite::create("Animation/troop/balloon/balloon_death.png");
-    } else {
-        // 其他兵种从精灵图集获取墓碑帧
-        std::string frameName;
-        switch (unitType) {
-            case UnitTypeID::BARBARIAN:
-                frameName = "barbarian175.0.png";
-                break;
-            case UnitTypeID::ARCHER:
-                frameName = "archer53.0.png";
-                break;
-            case UnitTypeID::GOBLIN:
-                frameName = "goblin41.0.png";
-                break;
-            case UnitTypeID::GIANT:
-                frameName = "giant99.0.png";
-                break;
-            case UnitTypeID::WALL_BREAKER:
-                frameName = "wall_breaker1.0.png";
-                break;
-            default:
-                frameName = "barbarian175.0.png";
-                break;
-        }
+BattleUnitSprite* BattleTroopLayer::resolveUnit(const TroopHandle& handle) const {
+    if (handle.isNull() || handle.index >= _slots.size()) return nullptr;
+    
+    const TroopSlot& slot = _slots[handle.index];
+    return (slot.generation == handle.generation) ? slot.unit : nullptr;
+}
 
-        auto frame = SpriteFrameCache::getInstance()->getSpriteFrameByName(frameName);
-        if (frame) {
-            tombstone = Sprite::createWithSpriteFrame(frame);
-        }
-    }
+bool BattleTroopLayer::isAlive(const TroopHandle& handle) const {
+    BattleUnitSprite* unit = resolveUnit(handle);
+    return unit && !unit->isDead();
+}
 
+void BattleTroopLayer::spawnTombstone(const Vec2& position, UnitTypeID unitType) {
+    // 从节点池取出墓碑（已按兵种设置好图片、锚点和缩放，颜色恢复为白色）
+    Sprite* tombstone = BattleNodePool::getInstance()->acquireTombstone(unitType);
     if (!tombstone) {
         CCLOG("BattleTroopLayer::spawnTombstone - ERROR: Failed to create tombstone sprite!");
         return;
     }
 
-    // 设置位置
     tombstone->setPosition(position);
-    tombstone->setAnchorPoint(Vec2(0.5f, 0.0f));
-
-    // 设置缩放
-    float scale = 0.8f;
-    switch (unitType) {
-        case UnitTypeID::BARBARIAN: scale = 0.8f; break;
-        case UnitTypeID::ARCHER: scale = 0.75f; break;
-        case UnitTypeID::GOBLIN: scale = 0.7f; break;
-        case UnitTypeID::GIANT: scale = 1.2f; break;
-        case UnitTypeID::WALL_BREAKER: scale = 0.65f; break;
-        case UnitTypeID::BALLOON: scale = 1.0f; break;
-    }
-    tombstone->setScale(scale);
-
-    // 强制设置为白色（防止继承兵种的红色）
-    tombstone->setColor(Color3B::WHITE);
-    tombstone->setOpacity(255);
-
-    CCLOG("BattleTroopLayer::spawnTombstone - Tombstone color set to WHITE");
 
     // 添加到地图层
     auto mapLayer = this->getParent();
-    CCLOG("BattleTroopLayer::spawnTombstone - MapLayer: %p", mapLayer);
-
     if (mapLayer) {
-        CCLOG("BattleTroopLayer::spawnTombstone - Adding to MapLayer with Z-order 100...");
         mapLayer->addChild(tombstone, 100);
-        CCLOG("BattleTroopLayer::spawnTombstone - Tombstone added successfully");
     } else {
         CCLOG("BattleTroopLayer::spawnTombstone - WARNING: No MapLayer, adding to TroopLayer...");
         this->addChild(tombstone, 100);
     }
+    _tombstones.push_back(tombstone);
 
-    // 墓碑自动消失：停留3秒后淡出
+    // 墓碑自动消失：停留3秒后淡出，然后回收
     auto sequence = Sequence::create(
         DelayTime::create(3.0f),
         FadeOut::create(1.0f),
-        RemoveSelf::create(),
+        CallFunc::create([this, tombstone]() {
+            recycleTombstone(tombstone);
+        }),
         nullptr
     );
     tombstone->runAction(sequence);
 
-    CCLOG("BattleTroopLayer::spawnTombstone - COMPLETE: Tombstone created and will fade out after 3s");
-    CCLOG("===== TOMBSTONE DEBUG END =====");
+    CCLOG("BattleTroopLayer::spawnTombstone - Tombstone at (%.1f, %.1f) will fade out after 3s",
+          position.x, position.y);
+}
+
+void BattleTroopLayer::recycleTombstone(Sprite* tombstone) {
+    auto it = std::find(_tombstones.begin(), _tombstones.end(), tombstone);
+    if (it != _tombstones.end()) {
+        _tombstones.erase(it);
+    }
+    BattleNodePool::getInstance()->recycleTombstone(tombstone);
 }
 
 void BattleTroopLayer::clearAllTombstones() {
-    auto mapLayer = this->getParent();
-    
+    auto pool = BattleNodePool::getInstance();
     for (auto tombstone : _tombstones) {
-        if (mapLayer && tombstone->getParent() == mapLayer) {
-            mapLayer->removeChild(tombstone);
-        } else {
-            this->removeChild(tombstone);
-        }
+        pool->recycleTombstone(tombstone);
     }
     
     _tombstones.clear();
@@ -5,6 +5,7 @@
 
 #include "cocos2d.h"
 #include "../Sprite/BattleUnitSprite.h"
+#include "../Model/TroopHandle.h"
 #include <vector>
 
 USING_NS_CC;
@@ -15,6 +16,8 @@ USING_NS_CC;
 // 2. 提供单位生成、移除接口
 // 3. 纯粹的显示层，不包含控制逻辑
 // 4. 管理战斗墓碑显示
+// 5. 维护兵种槽位表：其他系统通过 TroopHandle 引用单位，O(1) 判断单位是否仍在场上
+// 6. 单位和墓碑从 BattleNodePool 取出，移除时回收而不是释放
 class BattleTroopLayer : public Layer {
 public:
     static BattleTroopLayer* create();
@@ -36,6 +39,12 @@ public:
     // 移除指定单位（死亡时调用）
     void removeUnit(BattleUnitSprite* unit);
     
+    // 解析句柄，单位已被移除时返回 nullptr
+    BattleUnitSprite* resolveUnit(const TroopHandle& handle) const;
+    
+    // 句柄指向的单位是否仍在场上且存活
+    bool isAlive(const TroopHandle& handle) const;
+    
     // 在指定位置生成墓碑
     void spawnTombstone(const Vec2& position, UnitTypeID unitType);
 
@@ -43,9 +52,23 @@ public:
     void clearAllTombstones();
     
 private:
+    // 兵种槽位
+    struct TroopSlot {
+        BattleUnitSprite* unit;
+        uint32_t generation;
+    };
+    
     std::vector<BattleUnitSprite*> _units;  // 所有单位列表
-    std::vector<Node*> _tombstones;         // 墓碑列表
+    std::vector<Sprite*> _tombstones;       // 场上的墓碑
+    std::vector<TroopSlot> _slots;          // 槽位表（下标即句柄的 index）
+    std::vector<uint32_t> _freeSlots;       // 可复用的槽位
+    
+    // 为新单位分配句柄
+    TroopHandle allocateHandle(BattleUnitSprite* unit);
+    
+    // 回收单位的槽位，旧句柄随之失效
+    void releaseHandle(BattleUnitSprite* unit);
     
-    static const int GRID_WIDTH = 44;
-    static const int GRID_HEIGHT = 44;
+    // 墓碑淡出后回收到节点池
+    void recycleTombstone(Sprite* tombstone);
 };
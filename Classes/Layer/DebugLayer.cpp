@@ -276,11 +276,20 @@ void DebugLayer::initBattleMapSection() {
     // 生成随机地图按钮
     auto randomMapBtn = Button::create();
     randomMapBtn->setTitleText("[ 🎲 生成随机战斗地图 ]");
-    randomMapBtn->setPosition(Vec2(300, 40));
+    randomMapBtn->setPosition(Vec2(170, 40));
     randomMapBtn->setTitleFontSize(16);
     randomMapBtn->setTitleColor(Color3B(0, 255, 255));
     randomMapBtn->addClickEventListener([this](Ref*) { this->onGenerateRandomMap(); });
     _panel->addChild(randomMapBtn);
+
+    // 寻路性能测试按钮
+    auto benchmarkBtn = Button::create();
+    benchmarkBtn->setTitleText("[ ⏱️ 寻路性能测试 ]");
+    benchmarkBtn->setPosition(Vec2(430, 40));
+    benchmarkBtn->setTitleFontSize(16);
+    benchmarkBtn->setTitleColor(Color3B(0, 255, 255));
+    benchmarkBtn->addClickEventListener([this](Ref*) { this->onBenchmarkPathfinding(); });
+    _panel->addChild(benchmarkBtn);
 }
 
 void DebugLayer::onGenerateRandomMap() {
@@ -297,3 +306,11 @@ void DebugLayer::onGenerateRandomMap() {
     
     CCLOG("DebugLayer: Generated random battle map");
 }
+
+void DebugLayer::onBenchmarkPathfinding() {
+    std::string result = DebugHelper::benchmarkPathfindingMapUpdate();
+    result += "\n" + DebugHelper::benchmarkHierarchicalPathfinding();
+
+    _selectedBuildingLabel->setString(result);
+    _selectedBuildingLabel->setColor(Color3B(0, 255, 255));
+}
@@ -12,6 +12,9 @@ AnimationManager::AnimationManager() {
 }
 
 AnimationManager::~AnimationManager() {
+    clearCachedAnimations();
+    _animTables.clear();
+
     for (const auto& plist : _loadedPlists) {
         SpriteFrameCache::getInstance()->removeSpriteFramesFromFile(plist);
     }
@@ -66,6 +69,9 @@ void AnimationManager::preloadBattleAnimations() {
 }
 
 void AnimationManager::unloadSpriteFrames(const std::string& plistFile) {
+    // 缓存的动画持有帧引用，卸载前先丢弃，之后按需重新构建
+    clearCachedAnimations();
+
     SpriteFrameCache::getInstance()->removeSpriteFramesFromFile(plistFile);
     auto it = std::find(_loadedPlists.begin(), _loadedPlists.end(), plistFile);
     if (it != _loadedPlists.end()) {
@@ -75,6 +81,12 @@ void AnimationManager::unloadSpriteFrames(const std::string& plistFile) {
 }
 
 Animation* AnimationManager::createAnimation(const std::string& unitType, AnimationType animType) {
+    auto tableIt = _animTables.find(unitType);
+    if (tableIt != _animTables.end()) {
+        Animation* cached = tableIt->second[static_cast<int>(animType)];
+        if (cached) return cached;
+    }
+
     std::string key = getConfigKey(unitType, animType);
     auto it = _animConfigs.find(key);
 
@@ -83,8 +95,56 @@ Animation* AnimationManager::createAnimation(const std::string& unitType, Animat
         return nullptr;
     }
 
-    const AnimationConfig& config = it->second;
+    Animation* animation = buildAnimation(key, it->second);
+    if (animation) {
+        AnimationCache::getInstance()->addAnimation(animation, key);
+        _animTables[unitType][static_cast<int>(animType)] = animation;
+    }
+    return animation;
+}
+
+void AnimationManager::cacheAnimations() {
+    int cachedCount = 0;
+
+    for (auto& pair : _animTables) {
+        for (int i = 0; i < ANIMATION_TYPE_COUNT; ++i) {
+            if (pair.second[i]) continue;
+
+            std::string key = getConfigKey(pair.first, static_cast<AnimationType>(i));
+            auto it = _animConfigs.find(key);
+            if (it == _animConfigs.end()) continue;
+
+            Animation* animation = buildAnimation(key, it->second);
+            if (!animation) continue;
+
+            AnimationCache::getInstance()->addAnimation(animation, key);
+            pair.second[i] = animation;
+            cachedCount++;
+        }
+    }
 
+    CCLOG("AnimationManager: Cached %d animations for %d unit types", cachedCount, (int)_animTables.size());
+}
+
+const AnimationManager::AnimationTable* AnimationManager::getAnimationTable(const std::string& unitType) const {
+    auto it = _animTables.find(unitType);
+    return it != _animTables.end() ? &it->second : nullptr;
+}
+
+void AnimationManager::clearCachedAnimations() {
+    auto cache = AnimationCache::getInstance();
+
+    // 只清空表项、保留兵种条目，精灵持有的动画表指针保持有效
+    for (auto& pair : _animTables) {
+        for (int i = 0; i < ANIMATION_TYPE_COUNT; ++i) {
+            if (!pair.second[i]) continue;
+            cache->removeAnimation(getConfigKey(pair.first, static_cast<AnimationType>(i)));
+            pair.second[i] = nullptr;
+        }
+    }
+}
+
+Animation* AnimationManager::buildAnimation(CC_UNUSED const std::string& key, const AnimationConfig& config) const {
     // 创建帧序列
     Vector<SpriteFrame*> frames;
     auto cache = SpriteFrameCache::getInstance();
@@ -130,8 +190,7 @@ Animation* AnimationManager::createAnimation(const std::string& unitType, Animat
         return nullptr;
     }
 
-    Animation* animation = Animation::createWithSpriteFrames(frames, config.frameDelay);
-    return animation;
+    return Animation::createWithSpriteFrames(frames, config.frameDelay);
 }
 
 RepeatForever* AnimationManager::createLoopAnimate(const std::string& unitType, AnimationType animType) {
@@ -165,6 +224,13 @@ void AnimationManager::registerAnimationConfig(
     std::string key = getConfigKey(unitType, animType);
     _animConfigs[key] = config;
 
+    // 覆盖已缓存的配置时丢弃旧动画，下次使用时按新配置构建
+    Animation*& cached = _animTables[unitType][static_cast<int>(animType)];
+    if (cached) {
+        AnimationCache::getInstance()->removeAnimation(key);
+        cached = nullptr;
+    }
+
     if (config.isNonContinuous()) {
         CCLOG("AnimationManager: Registered config: %s (non-continuous frames: %zu frames)",
               key.c_str(), config.frameIndices.size());
@@ -383,6 +449,9 @@ void AnimationManager::initializeDefaultConfigs() {
     });
 
     CCLOG("AnimationManager: Default configs initialized (including Wall_Breaker)");
+
+    // 帧资源已在 preloadBattleAnimations() 中加载，这里一次性构建全部动画
+    cacheAnimations();
 }
 
 std::string AnimationManager::getConfigKey(const std::string& unitType, AnimationType animType) const {
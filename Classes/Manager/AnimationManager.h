@@ -5,6 +5,7 @@
 #define __ANIMATION_MANAGER_H__
 
 #include "cocos2d.h"
+#include <array>
 #include <string>
 #include <unordered_map>
 
@@ -28,6 +29,9 @@ enum class AnimationType {
     HURT
 };
 
+// 动画类型数量（用作动画表下标范围）
+static const int ANIMATION_TYPE_COUNT = static_cast<int>(AnimationType::HURT) + 1;
+
 // 移动方向枚举
 enum class MoveDirection {
   RIGHT,         // 向右（0度）
@@ -72,6 +76,9 @@ struct AnimationConfig {
 // 动画管理器（单例）
 class AnimationManager {
 public:
+  // 单个兵种的动画表，按 AnimationType 下标取用，未配置的类型为 nullptr
+  typedef std::array<Animation*, ANIMATION_TYPE_COUNT> AnimationTable;
+
   static AnimationManager* getInstance();
   static void destroyInstance();
 
@@ -80,7 +87,7 @@ public:
   void preloadBattleAnimations();
   void unloadSpriteFrames(const std::string& plistFile);
 
-  // 动画创建
+  // 动画创建（返回缓存的 Animation，未缓存时按配置构建并放入 AnimationCache）
   Animation* createAnimation(const std::string& unitType, AnimationType animType);
   RepeatForever* createLoopAnimate(const std::string& unitType, AnimationType animType);
   Animate* createOnceAnimate(const std::string& unitType, AnimationType animType);
@@ -94,6 +101,12 @@ public:
 
   void initializeDefaultConfigs();
 
+  // 按已注册配置构建全部动画并放入 AnimationCache（需在帧资源加载后调用）
+  void cacheAnimations();
+
+  // 兵种的动画表，精灵初始化时取一次，之后切换动画只做下标访问
+  const AnimationTable* getAnimationTable(const std::string& unitType) const;
+
   // 辅助方法
   std::string animTypeToString(AnimationType type) const;
 
@@ -106,10 +119,19 @@ private:
   // 动画配置缓存: <"Barbarian_WALK", AnimationConfig>
   std::unordered_map<std::string, AnimationConfig> _animConfigs;
 
+  // 已构建的动画: <"Barbarian", 动画表>，Animation 由 AnimationCache 持有
+  std::unordered_map<std::string, AnimationTable> _animTables;
+
   // 已加载的 .plist 文件列表
   std::vector<std::string> _loadedPlists;
 
   std::string getConfigKey(const std::string& unitType, AnimationType animType) const;
+
+  // 按配置逐帧查找并构建动画
+  Animation* buildAnimation(const std::string& key, const AnimationConfig& config) const;
+
+  // 从 AnimationCache 移除全部已构建动画
+  void clearCachedAnimations();
 };
 
 #endif // __ANIMATION_MANAGER_H__
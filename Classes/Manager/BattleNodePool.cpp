@@ -0,0 +1,271 @@
+﻿// BattleNodePool.cpp
+// 战斗节点池实现：预热、取出、重置回收和命中统计
+
+#include "BattleNodePool.h"
+#include "../Sprite/BattleUnitSprite.h"
+
+USING_NS_CC;
+
+BattleNodePool* BattleNodePool::_instance = nullptr;
+
+BattleNodePool* BattleNodePool::getInstance() {
+    if (!_instance) {
+        _instance = new BattleNodePool();
+    }
+    return _instance;
+}
+
+void BattleNodePool::destroyInstance() {
+    if (_instance) {
+        delete _instance;
+        _instance = nullptr;
+    }
+}
+
+// ===================================================================================
+// 预热
+// ===================================================================================
+
+void BattleNodePool::prewarmUnits(const std::string& unitType, int count) {
+    auto& pool = _units[unitType];
+    BattleNodePoolStats& stats = _stats[static_cast<int>(Kind::TROOP)];
+
+    while (static_cast<int>(pool.size()) < count) {
+        auto unit = BattleUnitSprite::create(unitType);
+        if (!unit) break;
+
+        // 不在显示树上时动作也会被 ActionManager 持有，先清掉，取出时再重置
+        unit->cleanup();
+        pool.pushBack(unit);
+        stats.prewarmed++;
+    }
+}
+
+void BattleNodePool::prewarmTombstones(UnitTypeID unitType, int count) {
+    auto& pool = _tombstones[static_cast<int>(unitType)];
+    BattleNodePoolStats& stats = _stats[static_cast<int>(Kind::TOMBSTONE)];
+
+    while (static_cast<int>(pool.size()) < count) {
+        auto tombstone = createTombstone(unitType);
+        if (!tombstone) break;
+
+        pool.pushBack(tombstone);
+        stats.prewarmed++;
+    }
+}
+
+void BattleNodePool::prewarmExplosions(int count) {
+    BattleNodePoolStats& stats = _stats[static_cast<int>(Kind::EXPLOSION)];
+
+    while (static_cast<int>(_explosions.size()) < count) {
+        auto explosion = ParticleExplosion::create();
+        if (!explosion) break;
+
+        _explosions.pushBack(explosion);
+        stats.prewarmed++;
+    }
+}
+
+// ===================================================================================
+// 兵种
+// ===================================================================================
+
+BattleUnitSprite* BattleNodePool::acquireUnit(const std::string& unitType) {
+    auto& pool = _units[unitType];
+    BattleNodePoolStats& stats = _stats[static_cast<int>(Kind::TROOP)];
+
+    if (pool.empty()) {
+        stats.misses++;
+        return BattleUnitSprite::create(unitType);
+    }
+
+    // 先保留一次引用再出池，交给调用方的父节点持有
+    BattleUnitSprite* unit = pool.back();
+    unit->retain();
+    unit->autorelease();
+    pool.popBack();
+
+    unit->resetForReuse();
+    stats.hits++;
+    return unit;
+}
+
+void BattleNodePool::recycleUnit(BattleUnitSprite* unit) {
+    if (!unit) return;
+
+    // 先入池持有引用，再从显示树移除（清理动作和调度）
+    _units[unit->getUnitType()].pushBack(unit);
+    unit->removeFromParentAndCleanup(true);
+    _stats[static_cast<int>(Kind::TROOP)].recycled++;
+}
+
+// ===================================================================================
+// 墓碑
+// ===================================================================================
+
+Sprite* BattleNodePool::createTombstone(UnitTypeID unitType) {
+    Sprite* tombstone = nullptr;
+
+    // 根据兵种类型加载墓碑图片
+    if (unitType == UnitTypeID::BALLOON) {
+        // 气球兵使用独立墓碑图片
+        tombstone = Sprite::create("Animation/troop/balloon/balloon_death.png");
+    } else {
+        // 其他兵种从精灵图集获取墓碑帧
+        std::string frameName;
+        switch (unitType) {
+            case UnitTypeID::BARBARIAN:
+                frameName = "barbarian175.0.png";
+                break;
+            case UnitTypeID::ARCHER:
+                frameName = "archer53.0.png";
+                break;
+            case UnitTypeID::GOBLIN:
+                frameName = "goblin41.0.png";
+                break;
+            case UnitTypeID::GIANT:
+                frameName = "giant99.0.png";
+                break;
+            case UnitTypeID::WALL_BREAKER:
+                frameName = "wall_breaker1.0.png";
+                break;
+            default:
+                frameName = "barbarian175.0.png";
+                break;
+        }
+
+        auto frame = SpriteFrameCache::getInstance()->getSpriteFrameByName(frameName);
+        if (frame) {
+            tombstone = Sprite::createWithSpriteFrame(frame);
+        }
+    }
+
+    if (!tombstone) {
+        CCLOG("BattleNodePool: Failed to create tombstone sprite for type %d", static_cast<int>(unitType));
+        return nullptr;
+    }
+
+    tombstone->setAnchorPoint(Vec2(0.5f, 0.0f));
+    tombstone->setTag(static_cast<int>(unitType));
+
+    // 设置缩放
+    float scale = 0.8f;
+    switch (unitType) {
+        case UnitTypeID::BARBARIAN: scale = 0.8f; break;
+        case UnitTypeID::ARCHER: scale = 0.75f; break;
+        case UnitTypeID::GOBLIN: scale = 0.7f; break;
+        case UnitTypeID::GIANT: scale = 1.2f; break;
+        case UnitTypeID::WALL_BREAKER: scale = 0.65f; break;
+        case UnitTypeID::BALLOON: scale = 1.0f; break;
+        default: break;
+    }
+    tombstone->setScale(scale);
+
+    return tombstone;
+}
+
+Sprite* BattleNodePool::acquireTombstone(UnitTypeID unitType) {
+    auto& pool = _tombstones[static_cast<int>(unitType)];
+    BattleNodePoolStats& stats = _stats[static_cast<int>(Kind::TOMBSTONE)];
+
+    Sprite* tombstone = nullptr;
+    if (pool.empty()) {
+        stats.misses++;
+        tombstone = createTombstone(unitType);
+        if (!tombstone) return nullptr;
+    } else {
+        tombstone = pool.back();
+        tombstone->retain();
+        tombstone->autorelease();
+        pool.popBack();
+        stats.hits++;
+    }
+
+    // 强制设置为白色（防止继承兵种的红色），上次淡出的透明度一并恢复
+    tombstone->setColor(Color3B::WHITE);
+    tombstone->setOpacity(255);
+    tombstone->setVisible(true);
+    return tombstone;
+}
+
+void BattleNodePool::recycleTombstone(Sprite* tombstone) {
+    if (!tombstone) return;
+
+    _tombstones[tombstone->getTag()].pushBack(tombstone);
+    tombstone->removeFromParentAndCleanup(true);
+    _stats[static_cast<int>(Kind::TOMBSTONE)].recycled++;
+}
+
+// ===================================================================================
+// 爆炸特效
+// ===================================================================================
+
+void BattleNodePool::playExplosion(Node* parent, const Vec2& position, float duration, float scale, int zOrder) {
+    if (!parent) return;
+
+    BattleNodePoolStats& stats = _stats[static_cast<int>(Kind::EXPLOSION)];
+
+    ParticleExplosion* explosion = nullptr;
+    if (_explosions.empty()) {
+        stats.misses++;
+        explosion = ParticleExplosion::create();
+        if (!explosion) return;
+    } else {
+        explosion = _explosions.back();
+        explosion->retain();
+        explosion->autorelease();
+        _explosions.popBack();
+        stats.hits++;
+    }
+
+    explosion->setPosition(position);
+    explosion->setDuration(duration);
+    explosion->setScale(scale);
+    explosion->setAutoRemoveOnFinish(false);
+    explosion->resetSystem();
+    parent->addChild(explosion, zOrder);
+
+    // 发射结束后等最长寿命的粒子消失再回收
+    float lifetime = duration + explosion->getLife() + explosion->getLifeVar();
+    explosion->runAction(Sequence::create(
+        DelayTime::create(lifetime),
+        CallFunc::create([explosion]() {
+            BattleNodePool::getInstance()->recycleExplosion(explosion);
+        }),
+        nullptr
+    ));
+}
+
+void BattleNodePool::recycleExplosion(ParticleExplosion* explosion) {
+    _explosions.pushBack(explosion);
+    explosion->removeFromParentAndCleanup(true);
+    _stats[static_cast<int>(Kind::EXPLOSION)].recycled++;
+}
+
+// ===================================================================================
+// 清理与统计
+// ===================================================================================
+
+void BattleNodePool::clear() {
+    logStats();
+
+    _units.clear();
+    _tombstones.clear();
+    _explosions.clear();
+
+    for (auto& stats : _stats) {
+        stats = BattleNodePoolStats();
+    }
+}
+
+void BattleNodePool::logStats() const {
+#if COCOS2D_DEBUG > 0
+    static const char* names[] = { "troop", "tombstone", "explosion" };
+
+    for (int k = 0; k < static_cast<int>(Kind::COUNT); ++k) {
+        const BattleNodePoolStats& stats = _stats[k];
+        CCLOG("BattleNodePool: %-9s hits=%d misses=%d recycled=%d prewarmed=%d",
+              names[k], stats.hits, stats.misses, stats.recycled, stats.prewarmed);
+    }
+#endif
+}
@@ -0,0 +1,104 @@
+﻿// BattleNodePool.h
+// 战斗节点池声明：按类型复用兵种精灵、墓碑和爆炸特效，准备阶段预热
+
+#ifndef __BATTLE_NODE_POOL_H__
+#define __BATTLE_NODE_POOL_H__
+
+#include "cocos2d.h"
+#include "2d/CCParticleExamples.h"
+#include <string>
+#include <unordered_map>
+
+class BattleUnitSprite;
+enum class UnitTypeID;
+
+/**
+ * @brief 节点池统计
+ */
+struct BattleNodePoolStats {
+    int hits;           // 从池中取到
+    int misses;         // 池为空，临时创建
+    int recycled;       // 回收次数
+    int prewarmed;      // 预热创建数
+
+    BattleNodePoolStats()
+        : hits(0)
+        , misses(0)
+        , recycled(0)
+        , prewarmed(0) {}
+};
+
+/**
+ * @brief 战斗节点池（单例，仅主线程）
+ *
+ * 长按连续投放时每个单位都要走一遍 BattleUnitSprite 的初始化（贴图查找、血条），
+ * 每次爆炸和单位阵亡也都要新建特效和墓碑节点，分配集中在同一帧时会卡顿。
+ * 这里按类型保存用完的节点：
+ * 1. BattleScene 进入准备阶段时按本场可用兵种数量预热
+ * 2. acquire*() 优先从池中取，池为空时才创建（计入 misses）
+ * 3. 节点用完后 recycle*() 回收：重置状态、从显示树移除，但不释放
+ *
+ * 池中的节点由池持有引用；取出后由加入的父节点持有。离开战斗时 clear()。
+ */
+class BattleNodePool {
+public:
+    // 节点类别
+    enum class Kind {
+        TROOP = 0,
+        TOMBSTONE = 1,
+        EXPLOSION = 2,
+        COUNT = 3
+    };
+
+    static BattleNodePool* getInstance();
+    static void destroyInstance();
+
+    // ========== 预热（已在池中的节点计入数量，不会重复创建） ==========
+    void prewarmUnits(const std::string& unitType, int count);
+    void prewarmTombstones(UnitTypeID unitType, int count);
+    void prewarmExplosions(int count);
+
+    // ========== 兵种 ==========
+
+    // 取出一个已重置的单位（未加入显示树），创建失败返回 nullptr
+    BattleUnitSprite* acquireUnit(const std::string& unitType);
+
+    // 回收单位：从显示树移除并重置（调用方需先回收其句柄）
+    void recycleUnit(BattleUnitSprite* unit);
+
+    // ========== 墓碑 ==========
+    cocos2d::Sprite* acquireTombstone(UnitTypeID unitType);
+    void recycleTombstone(cocos2d::Sprite* tombstone);
+
+    // ========== 爆炸特效 ==========
+
+    // 在 parent 上播放一次爆炸，粒子全部消失后自动回收
+    void playExplosion(cocos2d::Node* parent, const cocos2d::Vec2& position,
+                       float duration, float scale, int zOrder);
+
+    // 释放池中所有节点（离开战斗时调用），统计一并清零
+    void clear();
+
+    const BattleNodePoolStats& getStats(Kind kind) const { return _stats[static_cast<int>(kind)]; }
+
+    // 输出各类别的命中统计
+    void logStats() const;
+
+private:
+    BattleNodePool() = default;
+    ~BattleNodePool() = default;
+
+    static BattleNodePool* _instance;
+
+    std::unordered_map<std::string, cocos2d::Vector<BattleUnitSprite*>> _units;     // 兵种名 -> 空闲单位
+    std::unordered_map<int, cocos2d::Vector<cocos2d::Sprite*>> _tombstones;         // 兵种ID -> 空闲墓碑（墓碑的 tag 即兵种ID）
+    cocos2d::Vector<cocos2d::ParticleExplosion*> _explosions;                       // 空闲爆炸特效
+
+    BattleNodePoolStats _stats[static_cast<int>(Kind::COUNT)];
+
+    static cocos2d::Sprite* createTombstone(UnitTypeID unitType);
+
+    void recycleExplosion(cocos2d::ParticleExplosion* explosion);
+};
+
+#endif // __BATTLE_NODE_POOL_H__
@@ -0,0 +1,48 @@
+﻿// BattleViewRegistry.cpp
+// 战斗视图注册表实现
+
+#include "BattleViewRegistry.h"
+
+USING_NS_CC;
+
+BattleViewRegistry* BattleViewRegistry::_instance = nullptr;
+
+BattleViewRegistry* BattleViewRegistry::getInstance() {
+    if (!_instance) {
+        _instance = new BattleViewRegistry();
+    }
+    return _instance;
+}
+
+void BattleViewRegistry::destroyInstance() {
+    if (_instance) {
+        delete _instance;
+        _instance = nullptr;
+    }
+}
+
+void BattleViewRegistry::registerBuilding(int buildingId, BuildingSprite* sprite) {
+    _views[buildingId].sprite = sprite;
+}
+
+void BattleViewRegistry::registerDefenseAnimation(int buildingId, DefenseBuildingAnimation* animation) {
+    _views[buildingId].defenseAnimation = animation;
+}
+
+void BattleViewRegistry::unregisterBuilding(int buildingId) {
+    _views.erase(buildingId);
+}
+
+void BattleViewRegistry::clear() {
+    _views.clear();
+}
+
+BuildingSprite* BattleViewRegistry::getBuildingSprite(int buildingId) const {
+    auto it = _views.find(buildingId);
+    return (it != _views.end()) ? it->second.sprite : nullptr;
+}
+
+DefenseBuildingAnimation* BattleViewRegistry::getDefenseAnimation(int buildingId) const {
+    auto it = _views.find(buildingId);
+    return (it != _views.end()) ? it->second.defenseAnimation : nullptr;
+}
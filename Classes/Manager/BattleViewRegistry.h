@@ -0,0 +1,57 @@
+﻿// BattleViewRegistry.h
+// 战斗视图注册表声明，按建筑ID直接查找建筑精灵和防御动画
+
+#ifndef __BATTLE_VIEW_REGISTRY_H__
+#define __BATTLE_VIEW_REGISTRY_H__
+
+#include "cocos2d.h"
+#include <unordered_map>
+
+class BuildingSprite;
+class DefenseBuildingAnimation;
+
+/**
+ * @brief 战斗视图注册表（单例）
+ *
+ * 战斗场景的 BuildingManager 创建建筑精灵/防御动画时登记，销毁时注销。
+ * 防御、陷阱等战斗系统每次开火/触发都按建筑ID直接取到视图，
+ * 不再拼接 "Building_<id>" 在地图层的全部子节点中按名字查找，也不需要 dynamic_cast。
+ *
+ * 注册表不持有引用，视图的生命周期仍由 BuildingManager 管理。
+ */
+class BattleViewRegistry {
+public:
+    static BattleViewRegistry* getInstance();
+    static void destroyInstance();
+
+    // 登记建筑精灵
+    void registerBuilding(int buildingId, BuildingSprite* sprite);
+
+    // 登记防御建筑动画
+    void registerDefenseAnimation(int buildingId, DefenseBuildingAnimation* animation);
+
+    // 注销建筑（精灵和动画一起）
+    void unregisterBuilding(int buildingId);
+
+    // 清空（战斗地图重新加载或离开战斗时）
+    void clear();
+
+    // 查找，未登记返回 nullptr
+    BuildingSprite* getBuildingSprite(int buildingId) const;
+    DefenseBuildingAnimation* getDefenseAnimation(int buildingId) const;
+
+private:
+    BattleViewRegistry() = default;
+    ~BattleViewRegistry() = default;
+
+    static BattleViewRegistry* _instance;
+
+    struct BuildingView {
+        BuildingSprite* sprite = nullptr;
+        DefenseBuildingAnimation* defenseAnimation = nullptr;
+    };
+
+    std::unordered_map<int, BuildingView> _views;
+};
+
+#endif // __BATTLE_VIEW_REGISTRY_H__
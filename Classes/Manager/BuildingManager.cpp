@@ -7,6 +7,7 @@
 #include "Model/BattleMapData.h"
 #include "Util/GridMapUtils.h"
 #include "Component/DefenseBuildingAnimation.h" 
+#include "Manager/BattleViewRegistry.h"
 
 USING_NS_CC;
 
@@ -34,6 +35,11 @@ BuildingManager::~BuildingManager() {
     // 清理防御动画
     _defenseAnims.clear();
 
+    // 战斗视图随精灵一起失效
+    if (_isBattleScene) {
+        BattleViewRegistry::getInstance()->clear();
+    }
+
     // 移除所有建筑精灵
     for (auto& pair : _buildings) {
         if (pair.second) {
@@ -84,6 +90,9 @@ BuildingSprite* BuildingManager::addBuilding(const BuildingInstance& building) {
     _parentLayer->addChild(sprite, zOrder);
 
     _buildings[building.id] = sprite;
+    if (_isBattleScene) {
+        BattleViewRegistry::getInstance()->registerBuilding(building.id, sprite);
+    }
 
     // 陷阱特殊处理：战斗场景中初始不可见
     if (_isBattleScene && building.type >= 400 && building.type < 500) {
@@ -109,6 +118,10 @@ void BuildingManager::removeBuilding(int buildingId) {
         _defenseAnims.erase(animIt);
     }
 
+    if (_isBattleScene) {
+        BattleViewRegistry::getInstance()->unregisterBuilding(buildingId);
+    }
+
     // 清理建筑精灵
     auto it = _buildings.find(buildingId);
     if (it != _buildings.end()) {
@@ -160,6 +173,7 @@ void BuildingManager::createDefenseAnimation(BuildingSprite* sprite, const Build
 
     // 保存引用
     _defenseAnims[building.id] = anim;
+    BattleViewRegistry::getInstance()->registerDefenseAnimation(building.id, anim);
     CCLOG("BuildingManager: Defense animation saved to map, total anims: %zu", _defenseAnims.size());
 
     // 验证
@@ -330,4 +344,7 @@ void BuildingManager::removeBuildingSprite(int buildingId) {
     it->second->removeFromParent();
     _buildings.erase(it);
   }
+  if (_isBattleScene) {
+    BattleViewRegistry::getInstance()->unregisterBuilding(buildingId);
+  }
 }
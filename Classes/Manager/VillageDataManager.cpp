@@ -257,9 +257,11 @@ BuildingInstance* VillageDataManager::getBuildingById(int id) {
 }
 
 BuildingInstance* VillageDataManager::getBuildingAtGrid(int gridX, int gridY) {
-  if (gridX < 0 || gridY < 0 || gridX >= GridMapUtils::GRID_WIDTH || gridY >= GridMapUtils::GRID_HEIGHT) return nullptr;
-  
+  // 战斗地图尺寸可变，按当前占用表的实际尺寸检查边界
   const auto& occupancy = _inBattleMode ? _battleGridOccupancy : _gridOccupancy;
+  if (gridX < 0 || gridY < 0 || gridX >= (int)occupancy.size()) return nullptr;
+  if (gridY >= (int)occupancy[gridX].size()) return nullptr;
+  
   int occupyingId = occupancy[gridX][gridY];
   if (occupyingId == 0) return nullptr;
   return getBuildingById(occupyingId);
@@ -1149,6 +1151,14 @@ bool VillageDataManager::hasBattleMapData() const {
   return !_battleMapData.buildings.empty();
 }
 
+int VillageDataManager::getBattleGridWidth() const {
+  return _battleMapData.gridWidth > 0 ? _battleMapData.gridWidth : GridMapUtils::GRID_WIDTH;
+}
+
+int VillageDataManager::getBattleGridHeight() const {
+  return _battleMapData.gridHeight > 0 ? _battleMapData.gridHeight : GridMapUtils::GRID_HEIGHT;
+}
+
 void VillageDataManager::setInBattleMode(bool inBattle) {
   if (_inBattleMode == inBattle) return;
   
@@ -1171,9 +1181,13 @@ bool VillageDataManager::isInBattleMode() const {
 }
 
 void VillageDataManager::updateBattleGridOccupancy() {
-  // 清空战斗网格占用表
+  int width = getBattleGridWidth();
+  int height = getBattleGridHeight();
+
+  // 按战斗地图尺寸重置占用表
+  _battleGridOccupancy.resize(width);
   for (auto& row : _battleGridOccupancy) {
-    std::fill(row.begin(), row.end(), 0);
+    row.assign(height, 0);
   }
   
   // 标记战斗地图中所有建筑占用的网格
@@ -1187,8 +1201,8 @@ void VillageDataManager::updateBattleGridOccupancy() {
     
     for (int x = building.gridX; x < building.gridX + config->gridWidth; ++x) {
       for (int y = building.gridY; y < building.gridY + config->gridHeight; ++y) {
-        if (x >= 0 && x < GridMapUtils::GRID_WIDTH &&
-            y >= 0 && y < GridMapUtils::GRID_HEIGHT) {
+        if (x >= 0 && x < width &&
+            y >= 0 && y < height) {
           _battleGridOccupancy[x][y] = building.id;
         }
       }
@@ -101,6 +101,8 @@ public:
   const BattleMapData& getBattleMapData() const;
   void generateRandomBattleMap(int difficulty = 0);
   bool hasBattleMapData() const;
+  int getBattleGridWidth() const;
+  int getBattleGridHeight() const;
   
   // 战斗模式切换
   void setInBattleMode(bool inBattle);
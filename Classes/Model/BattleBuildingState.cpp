@@ -0,0 +1,170 @@
+﻿// BattleBuildingState.cpp
+// 战斗建筑状态实现：从建筑列表拆出数组、分类下标表和伤害写回
+
+#include "BattleBuildingState.h"
+#include "BuildingConfig.h"
+#include "../Util/BuildingSpatialIndex.h"
+#include "../Util/GridMapUtils.h"
+#include <algorithm>
+
+USING_NS_CC;
+
+BattleBuildingState* BattleBuildingState::_instance = nullptr;
+
+BattleBuildingState* BattleBuildingState::getInstance() {
+  if (!_instance) {
+    _instance = new BattleBuildingState();
+  }
+  return _instance;
+}
+
+void BattleBuildingState::destroyInstance() {
+  if (_instance) {
+    delete _instance;
+    _instance = nullptr;
+  }
+}
+
+BattleBuildingState::BattleBuildingState()
+    : _townHall(-1)
+    , _scoredTotalHP(0)
+    , _scoredHPRemoved(0)
+    , _sourceData(nullptr)
+    , _sourceSize(0)
+    , _dirty(true)
+    , _version(0) {}
+
+void BattleBuildingState::sync(std::vector<BuildingInstance>& buildings) {
+  if (_dirty || _sourceData != buildings.data() || _sourceSize != buildings.size()) {
+    build(buildings);
+  }
+}
+
+void BattleBuildingState::build(std::vector<BuildingInstance>& buildings) {
+  size_t count = buildings.size();
+
+  _buildings.resize(count);
+  _hp.resize(count);
+  _maxHP.resize(count);
+  _alive.resize(count);
+  _flags.resize(count);
+  _worldCenter.resize(count);
+  _centerGridX.resize(count);
+  _centerGridY.resize(count);
+  _gridWidth.resize(count);
+  _gridHeight.resize(count);
+  _cooldown.assign(count, 0.0f);
+  _lockedTarget.assign(count, TroopHandle());
+
+  _defenses.clear();
+  _traps.clear();
+  _walls.clear();
+  _scored.clear();
+  _townHall = -1;
+  _scoredTotalHP = 0;
+  _scoredHPRemoved = 0;
+  _indexById.clear();
+
+  auto buildingConfig = BuildingConfig::getInstance();
+
+  for (size_t i = 0; i < count; ++i) {
+    BuildingInstance& building = buildings[i];
+    int index = static_cast<int>(i);
+    auto config = buildingConfig->getConfig(building.type);
+
+    int width = config ? config->gridWidth : 1;
+    int height = config ? config->gridHeight : 1;
+
+    _buildings[i] = &building;
+    _hp[i] = building.currentHP;
+    _maxHP[i] = (config && config->hitPoints > 0) ? config->hitPoints : 0;
+    _indexById[building.id] = index;
+
+    // 放置中的建筑不参与战斗
+    bool placing = (building.state == BuildingInstance::State::PLACING);
+    _alive[i] = (!placing && !building.isDestroyed && building.currentHP > 0) ? 1 : 0;
+
+    uint32_t flags = 0;
+    if (building.type >= 400 && building.type < 500) {
+      flags |= BATTLE_TRAP;
+    } else {
+      flags |= 1u << static_cast<int>(BuildingSpatialIndex::categoryOf(building.type));
+    }
+    if (building.type == 1) flags |= BATTLE_TOWN_HALL;
+    if (building.type == 302) flags |= BATTLE_HITS_AIR;
+
+    // 计分规则：不含城墙和陷阱，只算已建成的建筑
+    if (!(flags & (BATTLE_WALL | BATTLE_TRAP)) &&
+        building.state == BuildingInstance::State::BUILT && _maxHP[i] > 0) {
+      flags |= BATTLE_SCORED;
+    }
+    _flags[i] = flags;
+
+    if (flags & BATTLE_WALL) {
+      _worldCenter[i] = GridMapUtils::gridToPixelCenter(building.gridX, building.gridY);
+    } else {
+      _worldCenter[i] = GridMapUtils::getBuildingCenterPixel(building.gridX, building.gridY, width, height);
+    }
+    _centerGridX[i] = building.gridX + width / 2;
+    _centerGridY[i] = building.gridY + height / 2;
+    _gridWidth[i] = width;
+    _gridHeight[i] = height;
+
+    if (placing) continue;
+
+    if (flags & BATTLE_DEFENSE) _defenses.push_back(index);
+    if (flags & BATTLE_TRAP) _traps.push_back(index);
+    if (flags & BATTLE_WALL) _walls.push_back(index);
+    if (flags & BATTLE_SCORED) {
+      _scored.push_back(index);
+      _scoredTotalHP += _maxHP[i];
+      _scoredHPRemoved += _alive[i] ? std::max(_maxHP[i] - _hp[i], 0) : _maxHP[i];
+    }
+    if ((flags & BATTLE_TOWN_HALL) && _townHall < 0) _townHall = index;
+  }
+
+  _sourceData = buildings.data();
+  _sourceSize = count;
+  _dirty = false;
+  _version++;
+
+  CCLOG("BattleBuildingState: Built %zu buildings (%zu defenses, %zu traps, %zu walls, %zu scored)",
+        count, _defenses.size(), _traps.size(), _walls.size(), _scored.size());
+}
+
+int BattleBuildingState::indexOf(int buildingId) const {
+  auto it = _indexById.find(buildingId);
+  return it != _indexById.end() ? it->second : -1;
+}
+
+bool BattleBuildingState::applyDamage(int index, int damage) {
+  if (!_alive[index]) return false;
+
+  BuildingInstance& building = *_buildings[index];
+
+  // 超出剩余血量的部分不计入进度
+  if (damage < _hp[index]) {
+    if (_flags[index] & BATTLE_SCORED) _scoredHPRemoved += damage;
+    _hp[index] -= damage;
+    building.currentHP = _hp[index];
+    return false;
+  }
+
+  destroy(index);
+  return true;
+}
+
+void BattleBuildingState::destroy(int index) {
+  BuildingInstance& building = *_buildings[index];
+
+  if (_alive[index] && (_flags[index] & BATTLE_SCORED)) {
+    _scoredHPRemoved += std::max(_hp[index], 0);
+  }
+
+  _hp[index] = 0;
+  _alive[index] = 0;
+  _lockedTarget[index] = TroopHandle();
+
+  building.currentHP = 0;
+  building.isDestroyed = true;
+}
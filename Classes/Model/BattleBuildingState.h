@@ -0,0 +1,147 @@
+﻿// BattleBuildingState.h
+// 战斗建筑状态声明：战斗期间的血量、存活、位置、分类和冷却按数组分开存放
+
+#ifndef __BATTLE_BUILDING_STATE_H__
+#define __BATTLE_BUILDING_STATE_H__
+
+#include "cocos2d.h"
+#include "VillageData.h"
+#include "TroopHandle.h"
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+// 建筑分类位（前四位与 BuildingSpatialIndex::categoryBit 一致）
+enum BattleBuildingFlag : uint32_t {
+  BATTLE_RESOURCE  = 1u << 0,   // 大本营、资源生产和储存建筑
+  BATTLE_DEFENSE   = 1u << 1,   // 防御建筑
+  BATTLE_WALL      = 1u << 2,   // 城墙
+  BATTLE_OTHER     = 1u << 3,   // 其余建筑
+  BATTLE_TRAP      = 1u << 4,   // 陷阱
+  BATTLE_TOWN_HALL = 1u << 5,   // 大本营
+  BATTLE_HITS_AIR  = 1u << 6,   // 能攻击飞行单位（箭塔）
+  BATTLE_SCORED    = 1u << 7    // 计入摧毁进度
+};
+
+/**
+ * @brief 战斗建筑状态（单例）
+ *
+ * BuildingInstance 同时承载村庄的持久数据和战斗中的运行数据，
+ * 战斗系统每 tick 遍历整张建筑表再按类型跳过大部分条目。
+ * 这里在战斗开始时把战斗要用的字段拆成按下标对齐的数组，
+ * 并为防御、陷阱、城墙和计分建筑各建一张下标表，各系统只遍历自己关心的条目。
+ *
+ * 下标与建筑列表中的下标一致。血量变化经 applyDamage()/destroy() 写入，
+ * 同时写回 BuildingInstance，存档、回放和血条等非战斗逻辑照旧读取。
+ */
+class BattleBuildingState {
+public:
+  static BattleBuildingState* getInstance();
+  static void destroyInstance();
+
+  // 按建筑列表重建（战斗开始时调用）
+  void build(std::vector<BuildingInstance>& buildings);
+
+  // 列表地址或长度变化、或被标记失效时重建
+  void sync(std::vector<BuildingInstance>& buildings);
+
+  // 建筑列表被重新加载或批量修改后调用
+  void invalidate() { _dirty = true; }
+
+  // 每次重建递增，依赖本状态的缓存据此判断是否过期
+  unsigned int getVersion() const { return _version; }
+
+  int size() const { return static_cast<int>(_buildings.size()); }
+
+  // 建筑ID -> 下标，不存在时返回 -1
+  int indexOf(int buildingId) const;
+
+  BuildingInstance& getBuilding(int index) const { return *_buildings[index]; }
+
+  // ========== 热数据 ==========
+  bool isAlive(int index) const { return _alive[index] != 0; }
+  int getHP(int index) const { return _hp[index]; }
+  int getMaxHP(int index) const { return _maxHP[index]; }
+  uint32_t getFlags(int index) const { return _flags[index]; }
+  bool hasFlag(int index, uint32_t flag) const { return (_flags[index] & flag) != 0; }
+
+  // 建筑中心（世界坐标；城墙取所在格中心）
+  const cocos2d::Vec2& getWorldCenter(int index) const { return _worldCenter[index]; }
+
+  // 建筑中心格（防御射程按此计算）
+  int getCenterGridX(int index) const { return _centerGridX[index]; }
+  int getCenterGridY(int index) const { return _centerGridY[index]; }
+
+  // 占地格数（溅射按占地矩形判断是否命中）
+  int getGridWidth(int index) const { return _gridWidth[index]; }
+  int getGridHeight(int index) const { return _gridHeight[index]; }
+
+  // 防御建筑的攻击冷却和锁定目标
+  float& cooldown(int index) { return _cooldown[index]; }
+  TroopHandle& lockedTarget(int index) { return _lockedTarget[index]; }
+
+  // ========== 分类下标表 ==========
+  const std::vector<int>& getDefenses() const { return _defenses; }
+  const std::vector<int>& getTraps() const { return _traps; }
+  const std::vector<int>& getWalls() const { return _walls; }
+  const std::vector<int>& getScored() const { return _scored; }
+
+  // 大本营下标，没有时返回 -1
+  int getTownHall() const { return _townHall; }
+
+  // ========== 摧毁进度 ==========
+
+  // 计分建筑的总血量（按满血计）
+  int getScoredTotalHP() const { return _scoredTotalHP; }
+
+  // 计分建筑已损失的血量，伤害写入时增量累加
+  int getScoredHPRemoved() const { return _scoredHPRemoved; }
+
+  // ========== 修改 ==========
+
+  // 造成伤害，返回本次是否将其摧毁
+  bool applyDamage(int index, int damage);
+
+  // 直接摧毁（陷阱引爆后）
+  void destroy(int index);
+
+private:
+  BattleBuildingState();
+  ~BattleBuildingState() = default;
+
+  static BattleBuildingState* _instance;
+
+  // 按下标对齐的数组
+  std::vector<BuildingInstance*> _buildings;
+  std::vector<int> _hp;
+  std::vector<int> _maxHP;
+  std::vector<uint8_t> _alive;
+  std::vector<uint32_t> _flags;
+  std::vector<cocos2d::Vec2> _worldCenter;
+  std::vector<int> _centerGridX;
+  std::vector<int> _centerGridY;
+  std::vector<int> _gridWidth;
+  std::vector<int> _gridHeight;
+  std::vector<float> _cooldown;
+  std::vector<TroopHandle> _lockedTarget;
+
+  // 分类下标表
+  std::vector<int> _defenses;
+  std::vector<int> _traps;
+  std::vector<int> _walls;
+  std::vector<int> _scored;
+  int _townHall;
+
+  int _scoredTotalHP;
+  int _scoredHPRemoved;
+
+  std::unordered_map<int, int> _indexById;
+
+  // 建立时的建筑列表
+  const BuildingInstance* _sourceData;
+  size_t _sourceSize;
+  bool _dirty;
+  unsigned int _version;
+};
+
+#endif // __BATTLE_BUILDING_STATE_H__
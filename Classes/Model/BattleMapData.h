@@ -17,6 +17,10 @@ struct BattleMapData {
     int lootableElixir;     // 总可掠夺药水
     int goldStorageCount;   // 金币仓库数量
     int elixirStorageCount; // 药水仓库数量
+
+    // 地图网格尺寸（运行时属性，活动地图可使用 128x128、256x256 等更大尺寸）
+    int gridWidth;
+    int gridHeight;
     
     BattleMapData() 
         : difficulty(1)
@@ -25,5 +29,7 @@ struct BattleMapData {
         , lootableGold(0)
         , lootableElixir(0)
         , goldStorageCount(0)
-        , elixirStorageCount(0) {}
+        , elixirStorageCount(0)
+        , gridWidth(44)
+        , gridHeight(44) {}
 };
@@ -10,6 +10,7 @@ USING_NS_CC;
 ValueMap TroopDeployEvent::toValueMap() const {
     ValueMap map;
     map["timestamp"] = timestamp;
+    map["tick"] = tick;
     map["troopId"] = troopId;
     map["gridX"] = gridX;
     map["gridY"] = gridY;
@@ -19,12 +20,52 @@ ValueMap TroopDeployEvent::toValueMap() const {
 TroopDeployEvent TroopDeployEvent::fromValueMap(const ValueMap& map) {
     TroopDeployEvent event;
     event.timestamp = map.at("timestamp").asFloat();
+    event.tick = (map.find("tick") != map.end()) ? map.at("tick").asInt() : -1;
     event.troopId = map.at("troopId").asInt();
     event.gridX = map.at("gridX").asInt();
     event.gridY = map.at("gridY").asInt();
     return event;
 }
 
+// AttackPlanEvent 序列化
+ValueMap AttackPlanEvent::toValueMap() const {
+    ValueMap map;
+    map["tick"] = tick;
+    map["unitSerial"] = unitSerial;
+    map["planSeq"] = planSeq;
+    map["found"] = found;
+    map["totalCost"] = totalCost;
+    map["wallBuildingId"] = wallBuildingId;
+    map["wallGridX"] = wallGridX;
+    map["wallGridY"] = wallGridY;
+
+    ValueVector cellsVec;
+    for (int value : pathCells) {
+        cellsVec.push_back(Value(value));
+    }
+    map["pathCells"] = cellsVec;
+    return map;
+}
+
+AttackPlanEvent AttackPlanEvent::fromValueMap(const ValueMap& map) {
+    AttackPlanEvent event;
+    event.tick = map.at("tick").asInt();
+    event.unitSerial = map.at("unitSerial").asInt();
+    event.planSeq = map.at("planSeq").asInt();
+    event.found = map.at("found").asBool();
+    event.totalCost = map.at("totalCost").asInt();
+    event.wallBuildingId = map.at("wallBuildingId").asInt();
+    event.wallGridX = map.at("wallGridX").asInt();
+    event.wallGridY = map.at("wallGridY").asInt();
+
+    if (map.find("pathCells") != map.end()) {
+        for (const auto& value : map.at("pathCells").asValueVector()) {
+            event.pathCells.push_back(value.asInt());
+        }
+    }
+    return event;
+}
+
 // BattleReplayData 序列化
 ValueMap BattleReplayData::toValueMap() const {
     ValueMap map;
@@ -86,6 +127,21 @@ ValueMap BattleReplayData::toValueMap() const {
     }
     map["troopEvents"] = eventsVec;
 
+    // 路线生效序列
+    ValueVector plansVec;
+    for (const auto& event : planEvents) {
+        plansVec.push_back(Value(event.toValueMap()));
+    }
+    map["planEvents"] = plansVec;
+
+    // 回放校验
+    ValueVector checksumsVec;
+    for (int checksum : stateChecksums) {
+        checksumsVec.push_back(Value(checksum));
+    }
+    map["stateChecksums"] = checksumsVec;
+    map["finalChecksum"] = finalChecksum;
+
     return map;
 }
 
@@ -157,6 +213,22 @@ BattleReplayData BattleReplayData::fromValueMap(const ValueMap& map) {
         }
     }
 
+    // 路线生效序列
+    if (map.find("planEvents") != map.end()) {
+        for (const auto& planValue : map.at("planEvents").asValueVector()) {
+            data.planEvents.push_back(AttackPlanEvent::fromValueMap(planValue.asValueMap()));
+        }
+    }
+
+    // 回放校验
+    if (map.find("stateChecksums") != map.end()) {
+        ValueVector checksumsVec = map.at("stateChecksums").asValueVector();
+        for (const auto& checksumValue : checksumsVec) {
+            data.stateChecksums.push_back(checksumValue.asInt());
+        }
+    }
+    data.finalChecksum = (map.find("finalChecksum") != map.end()) ? map.at("finalChecksum").asInt() : 0;
+
     return data;
 }
 
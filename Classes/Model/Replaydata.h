@@ -13,6 +13,7 @@
 // 兵种部署事件
 struct TroopDeployEvent {
     float timestamp;      // 相对战斗开始的时间（秒）
+    int tick;             // 相对战斗开始的逻辑 tick，旧回放没有该字段时为 -1
     int troopId;          // 兵种ID
     int gridX;            // 部署位置X
     int gridY;            // 部署位置Y
@@ -22,6 +23,23 @@ struct TroopDeployEvent {
     static TroopDeployEvent fromValueMap(const cocos2d::ValueMap& map);
 };
 
+// 路线生效事件：单位的第几次路线请求在第几个 tick 生效，以及路线本身
+struct AttackPlanEvent {
+    int tick;                 // 生效的逻辑 tick
+    int unitSerial;           // 单位在本场战斗中的部署序号（从 1 开始）
+    int planSeq;              // 该单位的第几次路线请求（从 1 开始）
+    bool found;               // 是否找到路线
+    int totalCost;            // 路线代价
+    int wallBuildingId;       // 第一堵要打的城墙ID，0 表示绕路
+    int wallGridX;            // 第一堵城墙的网格坐标
+    int wallGridY;
+    std::vector<int> pathCells;   // 路径点所在格，按 x, y 交替存放（路径点都在格子中心）
+
+    // JSON序列化
+    cocos2d::ValueMap toValueMap() const;
+    static AttackPlanEvent fromValueMap(const cocos2d::ValueMap& map);
+};
+
 // 完整回放数据
 struct BattleReplayData {
     // 元数据
@@ -45,6 +63,13 @@ struct BattleReplayData {
     // 兵种部署序列
     std::vector<TroopDeployEvent> troopEvents;      // 按时间排序的兵种部署事件
 
+    // 路线生效序列，回放时按录制的 tick 应用（旧回放没有时回放重新规划）
+    std::vector<AttackPlanEvent> planEvents;
+
+    // 回放校验（旧回放没有这些字段时不校验）
+    std::vector<int> stateChecksums;                // 每隔固定 tick 数的战斗状态校验值
+    int finalChecksum;                              // 战斗结束时的状态校验值
+
     // JSON序列化
     cocos2d::ValueMap toValueMap() const;
     static BattleReplayData fromValueMap(const cocos2d::ValueMap& map);
@@ -0,0 +1,24 @@
+﻿// TroopHandle.h
+// 兵种句柄定义：槽位下标 + 代数，单位被移除后旧句柄自动失效
+
+#pragma once
+#include <cstdint>
+
+// 兵种句柄
+// 指向 BattleTroopLayer 槽位表中的一格；槽位被回收时代数加一，
+// 因此已移除单位的旧句柄解析结果为空，不会指向复用该槽位的新单位。
+// 代数 0 保留给空句柄。
+struct TroopHandle {
+  uint32_t index = 0;
+  uint32_t generation = 0;
+
+  bool isNull() const { return generation == 0; }
+
+  bool operator==(const TroopHandle& other) const {
+    return index == other.index && generation == other.generation;
+  }
+  bool operator!=(const TroopHandle& other) const { return !(*this == other); }
+  bool operator<(const TroopHandle& other) const {
+    return index != other.index ? index < other.index : generation < other.generation;
+  }
+};
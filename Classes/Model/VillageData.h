@@ -27,15 +27,9 @@ struct BuildingInstance {
   // 区分新建筑和升级
   bool isInitialConstruction;
 
-  // 战斗系统运行时数据
+  // 战斗系统运行时数据（战斗中的冷却、锁定目标等见 BattleBuildingState）
   int currentHP;        // 当前生命值
   bool isDestroyed;     // 是否已被摧毁
-
-  // 防御建筑锁定目标
-  mutable void* lockedTarget = nullptr;  // 锁定的兵种指针（BattleUnitSprite*）
-
-  // 攻击冷却系统
-  float attackCooldown = 0.0f;  // 当前冷却时间（秒）
 };
 
 // 村庄数据
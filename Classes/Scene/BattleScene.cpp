@@ -12,19 +12,43 @@
 #include "Controller/TrapSystem.h"
 #include "Controller/DefenseSystem.h"
 #include "Controller/DestructionTracker.h"
+#include "Controller/BattleClock.h"
 #include "Manager/VillageDataManager.h"
 #include "Manager/BuildingManager.h"
 #include "Manager/AudioManager.h"
+#include "Manager/BattleNodePool.h"
 #include "Model/BuildingConfig.h"
+#include "Model/BattleBuildingState.h"
 #include "UI/BattleProgressUI.h"
 #include "Util/FindPathUtil.h"
 #include "Util/GridMapUtils.h"
 #include "Util/RandomBattleMapGenerator.h"
+#include "Util/TroopSpatialIndex.h"
 #include "Component/DefenseBuildingAnimation.h"
 #include <iostream>
 
 USING_NS_CC;
 
+// 战斗阶段时长（秒）
+static const float FIGHTING_DURATION = 180.0f;
+
+// 节点池预热数量：墓碑同时在场的不多，爆炸特效由炸弹兵和陷阱共用
+static const int PREWARM_TOMBSTONES_PER_TYPE = 8;
+static const int PREWARM_EXPLOSIONS = 6;
+
+// 兵种ID -> 单位名
+static std::string getTroopUnitName(int troopId) {
+    switch (troopId) {
+        case 1001: return "Barbarian";
+        case 1002: return "Archer";
+        case 1003: return "Goblin";
+        case 1004: return "Giant";
+        case 1005: return "Wall_Breaker";
+        case 1006: return "Balloon";
+        default:   return "Barbarian";
+    }
+}
+
 Scene* BattleScene::createScene() {
     return BattleScene::create();
 }
@@ -159,7 +183,15 @@ void BattleScene::onEnter() {
 
 void BattleScene::update(float dt) {
     if (_currentState == BattleState::PREPARE || _currentState == BattleState::FIGHTING) {
-        _stateTimer -= dt;
+        if (_currentState == BattleState::FIGHTING) {
+            // 战斗逻辑按固定步长推进，剩余时间也按已推进的 tick 计算
+            updateBattleTicks(dt);
+            // 本帧所有 tick 的伤害合并成一次进度上报
+            DestructionTracker::getInstance()->updateProgress();
+            _stateTimer = FIGHTING_DURATION - BattleClock::getInstance()->getElapsedSeconds();
+        } else {
+            _stateTimer -= dt;
+        }
         if (_hudLayer) _hudLayer->updateTimer((int)_stateTimer);
 
         if (_stateTimer <= 0) {
@@ -171,21 +203,45 @@ void BattleScene::update(float dt) {
                 onEndBattleClicked();
             }
         }
-        
-        // 建筑防御系统和陷阱系统自动更新
-        if (_currentState == BattleState::FIGHTING) {
-            auto troopLayer = dynamic_cast<BattleTroopLayer*>(_mapLayer->getChildByTag(999));
-            if (troopLayer) {
-                DefenseSystem::getInstance()->updateBuildingDefense(troopLayer);
-                TrapSystem::getInstance()->updateTrapDetection(troopLayer);
-            }
-        }
     }
-    
-    // 回放播放逻辑
-    if (_recorder.isReplayMode() && _currentState == BattleState::FIGHTING) {
-        updateReplay(dt);
+}
+
+void BattleScene::updateBattleTicks(float dt) {
+    auto clock = BattleClock::getInstance();
+    auto troopLayer = dynamic_cast<BattleTroopLayer*>(_mapLayer->getChildByTag(999));
+
+    auto dataManager = VillageDataManager::getInstance();
+    auto& buildings = const_cast<std::vector<BuildingInstance>&>(dataManager->getAllBuildings());
+
+    // 单位显示在两个 tick 之间插值，逻辑从当前 tick 的位置继续推进
+    auto controller = BattleProcessController::getInstance();
+    controller->restoreTickPositions(troopLayer);
+
+    clock->accumulate(dt);
+    while (clock->consumeTick()) {
+        // 回放部署放在本 tick 的逻辑之前，与录制时一致
+        if (_recorder.isReplayMode()) {
+            updateReplay();
+        }
+
+        // 战斗建筑状态每个 tick 同步一次，目标查找、防御和陷阱在本 tick 内直接使用
+        BattleBuildingState::getInstance()->sync(buildings);
+
+        if (troopLayer) {
+            // 先推进单位状态机，防御和陷阱看到的是本 tick 移动后的位置
+            controller->updateTroops(troopLayer);
+
+            // 单位空间索引每个 tick 重建一次，防御和陷阱的范围查询共用
+            TroopSpatialIndex::getInstance()->rebuild(troopLayer->getAllUnits());
+            DefenseSystem::getInstance()->updateBuildingDefense(troopLayer);
+            TrapSystem::getInstance()->updateTrapDetection(troopLayer);
+        }
+
+        // 本 tick 的逻辑结束：录制时记录状态校验值，回放时比对
+        _recorder.onTickFinished(troopLayer);
     }
+
+    controller->interpolatePositions(troopLayer, clock->getInterpolationAlpha());
 }
 
 void BattleScene::switchState(BattleState newState) {
@@ -208,6 +264,10 @@ void BattleScene::switchState(BattleState newState) {
         case BattleState::PREPARE:
             CCLOG(">>> Entering PREPARE state");
             _stateTimer = 30.0f;
+            BattleClock::getInstance()->reset();
+
+            // 云层遮挡期间把本场要用的节点先建好，投放时不再逐个创建
+            prewarmNodePools();
             
             // 播放准备战斗音乐（循环）
             CCLOG(">>> Attempting to play combat planning music...");
@@ -226,7 +286,10 @@ void BattleScene::switchState(BattleState newState) {
             
         case BattleState::FIGHTING:
             CCLOG(">>> Entering FIGHTING state");
-            _stateTimer = 180.0f;
+            _stateTimer = FIGHTING_DURATION;
+
+            // 战斗时间从 0 tick 开始；准备阶段部署的兵种记为第 0 tick
+            BattleClock::getInstance()->reset();
             
             // 保存当前地图状态到回放数据
             if (!_recorder.isReplayMode()) {
@@ -477,6 +540,10 @@ void BattleScene::onReturnHomeClicked() {
         _eventDispatcher->removeEventListener(_buildingDestroyedListener);
         _buildingDestroyedListener = nullptr;
     }
+    if (_buildingsDestroyedListener) {
+        _eventDispatcher->removeEventListener(_buildingsDestroyedListener);
+        _buildingsDestroyedListener = nullptr;
+    }
     
     // 重置战斗进度UI
     if (_battleProgressUI) {
@@ -714,16 +781,7 @@ bool BattleScene::tryDeployTroopAt(const cocos2d::Vec2& touchPos) {
         return false;
     }
 
-    // 兵种ID映射
-    std::string name = "Barbarian";
-    if (troopId == 1001) name = "Barbarian";
-    else if (troopId == 1002) name = "Archer";
-    else if (troopId == 1003) name = "Goblin";
-    else if (troopId == 1004) name = "Giant";
-    else if (troopId == 1005) name = "Wall_Breaker";
-    else if (troopId == 1006) name = "Balloon";
-
-    auto unit = troopLayer->spawnUnit(name, gx, gy);
+    auto unit = troopLayer->spawnUnit(getTroopUnitName(troopId), gx, gy);
     if (!unit) {
         return false;
     }
@@ -736,9 +794,9 @@ bool BattleScene::tryDeployTroopAt(const cocos2d::Vec2& touchPos) {
     else if (troopId == 1005) AudioManager::getInstance()->playEffect("Audios/wall_breaker_deploy.mp3", 0.8f);
     else if (troopId == 1006) AudioManager::getInstance()->playEffect("Audios/balloon_deploy.mp3", 0.8f);
 
-    // 记录并启动AI
+    // 记录并登记到单位状态机
     recordTroopDeployment(troopId, gx, gy);
-    BattleProcessController::getInstance()->startUnitAI(unit, troopLayer);
+    BattleProcessController::getInstance()->registerUnit(unit);
 
     // 更新数量统计
     _remainingTroops[troopId]--;
@@ -817,6 +875,22 @@ void BattleScene::showPlacementTip(const std::string& message, const cocos2d::Ve
 
 // ========== 兵种追踪系统实现 ==========
 
+void BattleScene::prewarmNodePools() {
+    auto pool = BattleNodePool::getInstance();
+
+    // 单位按本场可投放的数量预热
+    for (const auto& pair : _remainingTroops) {
+        int troopId = pair.first;
+        int count = pair.second;
+
+        pool->prewarmUnits(getTroopUnitName(troopId), count);
+        pool->prewarmTombstones(static_cast<UnitTypeID>(troopId), std::min(count, PREWARM_TOMBSTONES_PER_TYPE));
+    }
+
+    pool->prewarmExplosions(PREWARM_EXPLOSIONS);
+    pool->logStats();
+}
+
 void BattleScene::initBattleTroops() {
     // 清空之前的数据
     _remainingTroops.clear();
@@ -888,13 +962,42 @@ void BattleScene::setupBuildingDestroyedListener() {
         CC_CALLBACK_1(BattleScene::onBuildingDestroyed, this)
     );
     _eventDispatcher->addEventListenerWithSceneGraphPriority(_buildingDestroyedListener, this);
+
+    _buildingsDestroyedListener = EventListenerCustom::create(
+        "EVENT_BUILDINGS_DESTROYED",
+        CC_CALLBACK_1(BattleScene::onBuildingsDestroyed, this)
+    );
+    _eventDispatcher->addEventListenerWithSceneGraphPriority(_buildingsDestroyedListener, this);
     CCLOG("BattleScene: Building destroyed listener setup");
 }
 
 void BattleScene::onBuildingDestroyed(cocos2d::EventCustom* event) {
     BuildingInstance* building = static_cast<BuildingInstance*>(event->getUserData());
     if (!building) return;
+
+    lootDestroyedBuilding(building);
     
+    //检查是否所有建筑都已被摧毁
+    if (_currentState == BattleState::FIGHTING) {
+        checkAllBuildingsDestroyed();
+    }
+}
+
+void BattleScene::onBuildingsDestroyed(cocos2d::EventCustom* event) {
+    auto buildings = static_cast<const std::vector<const BuildingInstance*>*>(event->getUserData());
+    if (!buildings || buildings->empty()) return;
+
+    for (const BuildingInstance* building : *buildings) {
+        lootDestroyedBuilding(building);
+    }
+
+    // 一批只检查一次
+    if (_currentState == BattleState::FIGHTING) {
+        checkAllBuildingsDestroyed();
+    }
+}
+
+void BattleScene::lootDestroyedBuilding(const BuildingInstance* building) {
     CCLOG("BattleScene: Building destroyed - ID=%d, Type=%d", building->id, building->type);
     
     // 检查是否是储存建筑
@@ -906,11 +1009,6 @@ void BattleScene::onBuildingDestroyed(cocos2d::EventCustom* event) {
         addLootedElixir(_elixirPerStorage);
         CCLOG("BattleScene: Elixir storage destroyed, looted %d elixir", _elixirPerStorage);
     }
-    
-    //检查是否所有建筑都已被摧毁
-    if (_currentState == BattleState::FIGHTING) {
-        checkAllBuildingsDestroyed();
-    }
 }
 
 void BattleScene::checkAllBuildingsDestroyed() {
@@ -987,6 +1085,13 @@ void BattleScene::onExit() {
 
     cleanupTouchListener();
 
+    // 单位即将随场景销毁，丢弃尚未返回的异步路线
+    BattleProcessController::getInstance()->cancelPendingPlans();
+    TroopSpatialIndex::getInstance()->clear();
+
+    // 池中的节点不随场景释放，离开战斗时一并释放（同时输出命中统计）
+    BattleNodePool::getInstance()->clear();
+
     if (_progressListener) {
         Director::getInstance()->getEventDispatcher()->removeEventListener(_progressListener);
         _progressListener = nullptr;
@@ -1034,11 +1139,11 @@ void BattleScene::startReplay() {
     });
 }
 
-void BattleScene::updateReplay(float dt) {
+void BattleScene::updateReplay() {
     auto troopLayer = dynamic_cast<BattleTroopLayer*>(_mapLayer->getChildByTag(999));
     if (!troopLayer) return;
 
-    _recorder.updateReplay(dt, troopLayer, [this]() {
+    _recorder.updateReplay(troopLayer, [this]() {
         CCLOG("BattleScene: All replay events deployed, preparing to show results...");
 
         this->scheduleOnce([this](float) {
@@ -81,6 +81,7 @@ private:
     std::map<int, int> _usedTroops;       // 已消耗统计
     std::map<int, int> _troopLevels;      // 兵种等级缓存
     void initBattleTroops();              // 初始化战斗兵种数据
+    void prewarmNodePools();              // 准备阶段按可投放兵种预热节点池
 
     // 资源掠夺数据
     int _lootedGold = 0;           // 已掠夺金币
@@ -90,7 +91,10 @@ private:
     int _goldPerStorage = 0;       // 每个储金罐的资源
     int _elixirPerStorage = 0;     // 每个圣水瓶的资源
     cocos2d::EventListenerCustom* _buildingDestroyedListener = nullptr;
+    cocos2d::EventListenerCustom* _buildingsDestroyedListener = nullptr;  // 一次攻击摧毁的一批建筑
     void onBuildingDestroyed(cocos2d::EventCustom* event);
+    void onBuildingsDestroyed(cocos2d::EventCustom* event);
+    void lootDestroyedBuilding(const BuildingInstance* building);  // 储存建筑被摧毁时计入掠夺
     void checkAllBuildingsDestroyed();  // 检查是否所有建筑都已被摧毁
 
     // 触摸监听和兵种部署
@@ -144,7 +148,10 @@ private:
 
     // 回放相关方法（委托给_recorder）
     void startReplay();
-    void updateReplay(float dt);
+    void updateReplay();
+
+    // 按 BattleClock 的固定步长推进战斗逻辑（防御、陷阱、回放部署）
+    void updateBattleTicks(float dt);
 
     void loadReplayMap();  // 加载回放地图
     virtual void onEnter() override;
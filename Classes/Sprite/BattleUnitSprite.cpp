@@ -3,7 +3,6 @@
 
 #include "BattleUnitSprite.h"
 #include "Util/GridMapUtils.h"
-#include "Util/FindPathUtil.h"
 #include "Model/TroopConfig.h"
 #include "Manager/AnimationManager.h"
 #include <algorithm>
@@ -11,6 +10,45 @@
 
 USING_NS_CC;
 
+namespace {
+
+// 方向向量先逆时针旋转 22.5 度，使每个扇区的起始边落在 0/45/90... 度上
+const float OCTANT_ROTATE_COS = 0.92387953f;   // cos(22.5°)
+const float OCTANT_ROTATE_SIN = 0.38268343f;   // sin(22.5°)
+
+// 旋转后向量的 (y<0, x<0, |y|>|x|) 三个比较位 -> 扇区
+const int OCTANT_LOOKUP[8] = {
+    0,  // 000: [0, 45)
+    1,  // 001: [45, 90)
+    3,  // 010: [135, 180)
+    2,  // 011: [90, 135)
+    7,  // 100: [315, 360)
+    6,  // 101: [270, 315)
+    4,  // 110: [180, 225)
+    5   // 111: [225, 270)
+};
+
+// 扇区 -> 待机/行走/攻击动画和是否水平翻转（素材只有右、右上、右下三个朝向）
+struct OctantAnimation {
+    AnimationType idle;
+    AnimationType walk;
+    AnimationType attack;
+    bool flipX;
+};
+
+const OctantAnimation OCTANT_ANIMATIONS[8] = {
+    { AnimationType::IDLE,      AnimationType::WALK,      AnimationType::ATTACK,      false },  // 右
+    { AnimationType::IDLE_UP,   AnimationType::WALK_UP,   AnimationType::ATTACK_UP,   false },  // 右上
+    { AnimationType::IDLE_UP,   AnimationType::WALK_UP,   AnimationType::ATTACK_UP,   false },  // 上
+    { AnimationType::IDLE_UP,   AnimationType::WALK_UP,   AnimationType::ATTACK_UP,   true  },  // 左上
+    { AnimationType::IDLE,      AnimationType::WALK,      AnimationType::ATTACK,      true  },  // 左
+    { AnimationType::IDLE_DOWN, AnimationType::WALK_DOWN, AnimationType::ATTACK_DOWN, true  },  // 左下
+    { AnimationType::IDLE_DOWN, AnimationType::WALK_DOWN, AnimationType::ATTACK_DOWN, false },  // 下
+    { AnimationType::IDLE_DOWN, AnimationType::WALK_DOWN, AnimationType::ATTACK_DOWN, false }   // 右下
+};
+
+} // namespace
+
 BattleUnitSprite* BattleUnitSprite::create(const std::string& unitType) {
   auto sprite = new (std::nothrow) BattleUnitSprite();
   if (sprite && sprite->init(unitType)) {
@@ -24,6 +62,7 @@ BattleUnitSprite* BattleUnitSprite::create(const std::string& unitType) {
 bool BattleUnitSprite::init(const std::string& unitType) {
     _unitType = unitType;
     _unitTypeID = parseUnitType(unitType);
+    _animTable = AnimationManager::getInstance()->getAnimationTable(unitType);
     _currentAnimation = AnimationType::IDLE;
     _isAnimating = false;
     _currentGridPos = Vec2::ZERO;
@@ -84,15 +123,7 @@ bool BattleUnitSprite::init(const std::string& unitType) {
     this->setAnchorPoint(Vec2(0.5f, 0.0f));
 
     if (_unitTypeID == UnitTypeID::BALLOON) {
-        // 气球兵添加上下飘动动画
-        auto floatUp = MoveBy::create(1.0f, Vec2(0, 10));
-        auto floatDown = MoveBy::create(1.0f, Vec2(0, -10));
-        auto floatSequence = Sequence::create(floatUp, floatDown, nullptr);
-        auto floatForever = RepeatForever::create(floatSequence);
-        floatForever->setTag(9999);
-        this->runAction(floatForever);
-
-        CCLOG("BattleUnitSprite: Balloon floating animation started");
+        startBalloonFloat();
     }
 
     float scale = getScaleForUnitType(_unitTypeID);
@@ -117,9 +148,79 @@ float BattleUnitSprite::getScaleForUnitType(UnitTypeID typeID) {
     }
 }
 
+void BattleUnitSprite::startBalloonFloat() {
+    // 气球兵添加上下飘动动画
+    auto floatUp = MoveBy::create(1.0f, Vec2(0, 10));
+    auto floatDown = MoveBy::create(1.0f, Vec2(0, -10));
+    auto floatSequence = Sequence::create(floatUp, floatDown, nullptr);
+    auto floatForever = RepeatForever::create(floatSequence);
+    floatForever->setTag(9999);
+    this->runAction(floatForever);
+
+    CCLOG("BattleUnitSprite: Balloon floating animation started");
+}
+
+void BattleUnitSprite::resetForReuse() {
+    // 回收时 removeFromParent 已清理动作和调度，这里再确保一次
+    this->stopAllActions();
+
+    _currentHP = _maxHP;
+    _currentAnimation = AnimationType::IDLE;
+    _isAnimating = false;
+    _currentGridPos = Vec2::ZERO;
+    _lastGridX = -999;
+    _lastGridY = -999;
+    _cellChanged = false;
+    _isTargetedByBuilding = false;
+    _handle = TroopHandle();
+    _lastMoveDirection = Vec2::ZERO;
+
+    this->setColor(Color3B::WHITE);
+    this->setOpacity(255);
+    this->setFlippedX(false);
+    this->setVisible(true);
+    this->setScale(getScaleForUnitType(_unitTypeID));
+
+    if (_healthBar) {
+        _healthBar->hide();
+    }
+
+    // 恢复初始画面（气球兵死亡时换成了墓碑贴图）
+    if (_unitTypeID == UnitTypeID::BALLOON) {
+        auto texture = Director::getInstance()->getTextureCache()->addImage("Animation/troop/balloon/balloon.png");
+        if (texture) {
+            this->setTexture(texture);
+            this->setTextureRect(Rect(0, 0, texture->getContentSize().width, texture->getContentSize().height));
+        }
+        startBalloonFloat();
+    } else {
+        std::string unitTypeLower = _unitType;
+        std::transform(unitTypeLower.begin(), unitTypeLower.end(),
+                       unitTypeLower.begin(), ::tolower);
+
+        auto frame = SpriteFrameCache::getInstance()->getSpriteFrameByName(unitTypeLower + "1.0.png");
+        if (frame) {
+            this->setSpriteFrame(frame);
+        }
+    }
+
+    this->scheduleUpdate();
+}
+
 void BattleUnitSprite::update(float dt) {
     Sprite::update(dt);
-    
+    refreshZOrder();
+}
+
+bool BattleUnitSprite::takeCellChange() {
+    refreshGridCell();
+
+    bool changed = _cellChanged;
+    _cellChanged = false;
+    return changed;
+}
+
+void BattleUnitSprite::refreshGridCell() {
     // 获取当前网格位置
     Vec2 currentPos = this->getPosition();
     Vec2 gridPos = GridMapUtils::pixelToGrid(currentPos);
@@ -130,14 +231,21 @@ void BattleUnitSprite::update(float dt) {
         _currentGridPos = gridPos;
         _lastGridX = currentGridX;
         _lastGridY = currentGridY;
-        
-        // 根据网格位置更新Z轴顺序以实现正确的深度渲染
-        int zOrder = GridMapUtils::calculateZOrder(currentGridX, currentGridY);
-        
-        if (_unitTypeID == UnitTypeID::BALLOON) {
-            zOrder += 1000;
-        }
-        
+        _cellChanged = true;
+    }
+}
+
+void BattleUnitSprite::refreshZOrder() {
+    // 按显示位置（可能是 tick 之间的插值位置）更新Z轴顺序以实现正确的深度渲染
+    Vec2 gridPos = GridMapUtils::pixelToGrid(this->getPosition());
+    int zOrder = GridMapUtils::calculateZOrder(static_cast<int>(std::floor(gridPos.x)),
+                                               static_cast<int>(std::floor(gridPos.y)));
+    
+    if (_unitTypeID == UnitTypeID::BALLOON) {
+        zOrder += 1000;
+    }
+    
+    if (zOrder != this->getLocalZOrder()) {
         this->setLocalZOrder(zOrder);
     }
 }
@@ -241,28 +349,28 @@ void BattleUnitSprite::playAnimation(
         return;
     }
 
-    // 其他兵种使用AnimationManager创建帧动画
-    auto animMgr = AnimationManager::getInstance();
+    // 其他兵种使用AnimationManager预构建的帧动画
+    Animation* animation = _animTable ? (*_animTable)[static_cast<int>(animType)] : nullptr;
+    if (!animation) {
+        // 未预构建（例如运行中注册的配置）时退回按需构建
+        animation = AnimationManager::getInstance()->createAnimation(_unitType, animType);
+    }
 
     _currentAnimation = animType;
     _isAnimating = true;
 
+    if (!animation) {
+        CCLOG("BattleUnitSprite: Failed to create animation");
+        _isAnimating = false;
+        return;
+    }
+
     if (loop) {
-        auto action = animMgr->createLoopAnimate(_unitType, animType);
-        if (!action) {
-            CCLOG("BattleUnitSprite: Failed to create loop animation");
-            _isAnimating = false;
-            return;
-        }
+        auto action = RepeatForever::create(Animate::create(animation));
         action->setTag(ANIMATION_TAG);
         this->runAction(action);
     } else {
-        auto animate = animMgr->createOnceAnimate(_unitType, animType);
-        if (!animate) {
-            CCLOG("BattleUnitSprite: Failed to create animation");
-            _isAnimating = false;
-            return;
-        }
+        auto animate = Animate::create(animation);
 
         if (callback) {
             auto callbackFunc = CallFunc::create([this, callback]() {
@@ -290,37 +398,9 @@ void BattleUnitSprite::playIdleAnimation() {
 
     if (_lastMoveDirection != Vec2::ZERO) {
         // 根据上次移动方向选择待机动画朝向
-        float angle = getAngleFromDirection(_lastMoveDirection);
-
-        while (angle < 0) angle += 360;
-        while (angle >= 360) angle -= 360;
-
-        // 根据角度区间选择动画类型和翻转
-        if (angle >= 337.5f || angle < 22.5f) {
-            idleAnimType = AnimationType::IDLE;
-            flipX = false;
-        } else if (angle >= 22.5f && angle < 67.5f) {
-            idleAnimType = AnimationType::IDLE_UP;
-            flipX = false;
-        } else if (angle >= 67.5f && angle < 112.5f) {
-            idleAnimType = AnimationType::IDLE_UP;
-            flipX = false;
-        } else if (angle >= 112.5f && angle < 157.5f) {
-            idleAnimType = AnimationType::IDLE_UP;
-            flipX = true;
-        } else if (angle >= 157.5f && angle < 202.5f) {
-            idleAnimType = AnimationType::IDLE;
-            flipX = true;
-        } else if (angle >= 202.5f && angle < 247.5f) {
-            idleAnimType = AnimationType::IDLE_DOWN;
-            flipX = true;
-        } else if (angle >= 247.5f && angle < 292.5f) {
-            idleAnimType = AnimationType::IDLE_DOWN;
-            flipX = false;
-        } else {
-            idleAnimType = AnimationType::IDLE_DOWN;
-            flipX = false;
-        }
+        const OctantAnimation& entry = OCTANT_ANIMATIONS[getOctant(_lastMoveDirection)];
+        idleAnimType = entry.idle;
+        flipX = entry.flipX;
     }
 
     this->setFlippedX(flipX);
@@ -335,8 +415,14 @@ void BattleUnitSprite::playAttackAnimation(const std::function<void()>& callback
   playAnimation(AnimationType::ATTACK, false, callback);
 }
 
-float BattleUnitSprite::getAngleFromDirection(const Vec2& direction) {
-  return CC_RADIANS_TO_DEGREES(atan2f(direction.y, direction.x));
+int BattleUnitSprite::getOctant(const Vec2& direction) {
+  float x = direction.x * OCTANT_ROTATE_COS - direction.y * OCTANT_ROTATE_SIN;
+  float y = direction.x * OCTANT_ROTATE_SIN + direction.y * OCTANT_ROTATE_COS;
+
+  int bits = ((y < 0.0f) ? 4 : 0)
+           | ((x < 0.0f) ? 2 : 0)
+           | ((std::fabs(y) > std::fabs(x)) ? 1 : 0);
+  return OCTANT_LOOKUP[bits];
 }
 
 void BattleUnitSprite::selectWalkAnimation(const Vec2& direction,
@@ -344,118 +430,19 @@ void BattleUnitSprite::selectWalkAnimation(const Vec2& direction,
                                            bool& outFlipX) {
   _lastMoveDirection = direction;
 
-  float angle = getAngleFromDirection(direction);
-
-  // 角度归一化到[0, 360)
-  while (angle < 0) angle += 360;
-  while (angle >= 360) angle -= 360;
-
   // 八方向选择行走动画
-  if (angle >= 337.5f || angle < 22.5f) {
-    outAnimType = AnimationType::WALK;
-    outFlipX = false;
-  } else if (angle >= 22.5f && angle < 67.5f) {
-    outAnimType = AnimationType::WALK_UP;
-    outFlipX = false;
-  } else if (angle >= 67.5f && angle < 112.5f) {
-    outAnimType = AnimationType::WALK_UP;
-    outFlipX = false;
-  } else if (angle >= 112.5f && angle < 157.5f) {
-    outAnimType = AnimationType::WALK_UP;
-    outFlipX = true;
-  } else if (angle >= 157.5f && angle < 202.5f) {
-    outAnimType = AnimationType::WALK;
-    outFlipX = true;
-  } else if (angle >= 202.5f && angle < 247.5f) {
-    outAnimType = AnimationType::WALK_DOWN;
-    outFlipX = true;
-  } else if (angle >= 247.5f && angle < 292.5f) {
-    outAnimType = AnimationType::WALK_DOWN;
-    outFlipX = false;
-  } else {
-    outAnimType = AnimationType::WALK_DOWN;
-    outFlipX = false;
-  }
+  const OctantAnimation& entry = OCTANT_ANIMATIONS[getOctant(direction)];
+  outAnimType = entry.walk;
+  outFlipX = entry.flipX;
 }
 
 void BattleUnitSprite::selectAttackAnimation(const Vec2& direction,
                                              AnimationType& outAnimType,
                                              bool& outFlipX) {
-  float angle = getAngleFromDirection(direction);
-
-  // 角度归一化到[0, 360)
-  while (angle < 0) angle += 360;
-  while (angle >= 360) angle -= 360;
-
   // 八方向选择攻击动画
-  if (angle >= 337.5f || angle < 22.5f) {
-    outAnimType = AnimationType::ATTACK;
-    outFlipX = false;
-  } else if (angle >= 22.5f && angle < 67.5f) {
-    outAnimType = AnimationType::ATTACK_UP;
-    outFlipX = false;
-  } else if (angle >= 67.5f && angle < 112.5f) {
-    outAnimType = AnimationType::ATTACK_UP;
-    outFlipX = false;
-  } else if (angle >= 112.5f && angle < 157.5f) {
-    outAnimType = AnimationType::ATTACK_UP;
-    outFlipX = true;
-  } else if (angle >= 157.5f && angle < 202.5f) {
-    outAnimType = AnimationType::ATTACK;
-    outFlipX = true;
-  } else if (angle >= 202.5f && angle < 247.5f) {
-    outAnimType = AnimationType::ATTACK_DOWN;
-    outFlipX = true;
-  } else if (angle >= 247.5f && angle < 292.5f) {
-    outAnimType = AnimationType::ATTACK_DOWN;
-    outFlipX = false;
-  } else {
-    outAnimType = AnimationType::ATTACK_DOWN;
-    outFlipX = false;
-  }
-}
-
-void BattleUnitSprite::walkToPosition(const Vec2& targetPos, float duration,
-                                      const std::function<void()>& callback) {
-  Vec2 currentPos = this->getPosition();
-  Vec2 direction = targetPos - currentPos;
-
-  if (direction.length() < 0.1f) {
-    CCLOG("BattleUnitSprite: Target too close, skipping walk");
-    if (callback) callback();
-    return;
-  }
-
-  direction.normalize();
-
-  AnimationType animType;
-  bool flipX;
-  selectWalkAnimation(direction, animType, flipX);
-
-  this->setFlippedX(flipX);
-  playAnimation(animType, true);
-
-  auto moveAction = MoveTo::create(duration, targetPos);
-
-  auto finishCallback = CallFunc::create([this, callback]() {
-    this->setFlippedX(false);
-    playIdleAnimation();
-
-    if (callback) {
-      callback();
-    }
-  });
-
-  auto sequence = Sequence::create(moveAction, finishCallback, nullptr);
-  sequence->setTag(MOVE_TAG);
-  this->runAction(sequence);
-}
-
-void BattleUnitSprite::walkByOffset(const Vec2& offset, float duration,
-                                    const std::function<void()>& callback) {
-  Vec2 currentPos = this->getPosition();
-  Vec2 targetPos = currentPos + offset;
-  walkToPosition(targetPos, duration, callback);
+  const OctantAnimation& entry = OCTANT_ANIMATIONS[getOctant(direction)];
+  outAnimType = entry.attack;
+  outFlipX = entry.flipX;
 }
 
 void BattleUnitSprite::setGridPosition(int gridX, int gridY) {
@@ -477,233 +464,37 @@ void BattleUnitSprite::teleportToGrid(int gridX, int gridY) {
         gridX, gridY, pixelPos.x, pixelPos.y);
 }
 
-void BattleUnitSprite::walkToGrid(int targetGridX, int targetGridY, float speed,
-                                  const std::function<void()>& callback) {
-  if (!GridMapUtils::isValidGridPosition(targetGridX, targetGridY)) {
-    CCLOG("BattleUnitSprite: Invalid target grid position (%d, %d)",
-          targetGridX, targetGridY);
-    if (callback) callback();
-    return;
-  }
-
-  // 计算移动距离和持续时间
-  Vec2 currentPixelPos = this->getPosition();
-  Vec2 targetPixelPos = GridMapUtils::gridToPixelCenter(targetGridX, targetGridY);
-  float distance = currentPixelPos.distance(targetPixelPos);
-  float duration = distance / speed;
+void BattleUnitSprite::faceWalkDirection(const Vec2& direction) {
+  if (direction.length() < 0.1f) return;
 
-  CCLOG("BattleUnitSprite: Walking to grid(%d, %d), distance=%.1f, duration=%.2f",
-        targetGridX, targetGridY, distance, duration);
+  Vec2 normalizedDir = direction.getNormalized();
 
-  walkToPosition(targetPixelPos, duration, [this, targetGridX, targetGridY, callback]() {
-    _currentGridPos = Vec2(targetGridX, targetGridY);
-    CCLOG("BattleUnitSprite: Arrived at grid(%d, %d)", targetGridX, targetGridY);
-
-    if (callback) {
-      callback();
-    }
-  });
-}
-
-void BattleUnitSprite::walkFromGridToGrid(int startGridX, int startGridY,
-                                          int targetGridX, int targetGridY,
-                                          float speed,
-                                          const std::function<void()>& callback) {
-  if (!GridMapUtils::isValidGridPosition(startGridX, startGridY)) {
-    CCLOG("BattleUnitSprite: Invalid start grid position (%d, %d)",
-          startGridX, startGridY);
-    if (callback) callback();
-    return;
-  }
+  AnimationType animType;
+  bool flipX;
+  selectWalkAnimation(normalizedDir, animType, flipX);
 
-  if (!GridMapUtils::isValidGridPosition(targetGridX, targetGridY)) {
-    CCLOG("BattleUnitSprite: Invalid target grid position (%d, %d)",
-          targetGridX, targetGridY);
-    if (callback) callback();
+  // 同一朝向的行走动画已在循环播放（气球兵没有帧动画，只比较朝向）
+  bool playing = _isAnimating || _unitTypeID == UnitTypeID::BALLOON;
+  if (playing && _currentAnimation == animType && isFlippedX() == flipX) {
     return;
   }
 
-  // 先传送到起点，再移动到终点
-  teleportToGrid(startGridX, startGridY);
-  walkToGrid(targetGridX, targetGridY, speed, callback);
-
-  CCLOG("BattleUnitSprite: Walking from grid(%d, %d) to grid(%d, %d)",
-        startGridX, startGridY, targetGridX, targetGridY);
+  this->setFlippedX(flipX);
+  playAnimation(animType, true);
 }
 
-void BattleUnitSprite::attackInDirection(const Vec2& direction,
-                                         const std::function<void()>& callback) {
-  Vec2 normalizedDir = direction;
-
-  if (normalizedDir.length() < 0.1f) {
-    // 方向向量过短，默认朝右攻击
-    normalizedDir = Vec2(1, 0);
-    CCLOG("BattleUnitSprite: Direction too short, defaulting to right");
-  } else {
-    normalizedDir.normalize();
+void BattleUnitSprite::playAttackToward(const Vec2& targetPos) {
+  Vec2 direction = targetPos - this->getPosition();
+  if (direction.length() < 0.1f) {
+    direction = Vec2(1, 0);
   }
 
   AnimationType animType;
   bool flipX;
-  selectAttackAnimation(normalizedDir, animType, flipX);
+  selectAttackAnimation(direction.getNormalized(), animType, flipX);
 
   this->setFlippedX(flipX);
-
-  CCLOG("BattleUnitSprite: Attacking in direction (%.2f, %.2f), angle=%.1f",
-        normalizedDir.x, normalizedDir.y, getAngleFromDirection(normalizedDir));
-
-  playAnimation(animType, false, [this, flipX, callback]() {
-    this->setFlippedX(false);
-    CCLOG("BattleUnitSprite: Attack animation completed");
-
-    if (callback) {
-      callback();
-    }
-  });
-}
-
-void BattleUnitSprite::attackTowardPosition(const Vec2& targetPos,
-                                            const std::function<void()>& callback) {
-  Vec2 currentPos = this->getPosition();
-  Vec2 direction = targetPos - currentPos;
-
-  CCLOG("BattleUnitSprite: Attacking toward position (%.0f, %.0f)",
-        targetPos.x, targetPos.y);
-
-  attackInDirection(direction, callback);
-}
-
-void BattleUnitSprite::attackTowardGrid(int targetGridX, int targetGridY,
-                                        const std::function<void()>& callback) {
-  if (!GridMapUtils::isValidGridPosition(targetGridX, targetGridY)) {
-    CCLOG("BattleUnitSprite: Invalid target grid position (%d, %d)",
-          targetGridX, targetGridY);
-    if (callback) callback();
-    return;
-  }
-
-  Vec2 targetPixelPos = GridMapUtils::gridToPixelCenter(targetGridX, targetGridY);
-
-  CCLOG("BattleUnitSprite: Attacking toward grid(%d, %d)",
-        targetGridX, targetGridY);
-
-  attackTowardPosition(targetPixelPos, callback);
-}
-
-void BattleUnitSprite::moveToTargetWithPathfinding(
-    const Vec2& targetWorldPos,
-    float speed,
-    const std::function<void()>& callback) {
-
-    Vec2 currentWorldPos = this->getPosition();
-
-    // 使用寻路工具查找路径
-    auto pathfinder = FindPathUtil::getInstance();
-    std::vector<Vec2> path = pathfinder->findPathInWorld(currentWorldPos, targetWorldPos);
-
-    if (path.empty()) {
-        CCLOG("BattleUnitSprite: No path found to target (%.0f, %.0f)",
-              targetWorldPos.x, targetWorldPos.y);
-        if (callback) callback();
-        return;
-    }
-
-    CCLOG("BattleUnitSprite: Path found with %lu waypoints", path.size());
-
-    followPath(path, speed, callback);
-}
-
-void BattleUnitSprite::moveToGridWithPathfinding(
-    int targetGridX,
-    int targetGridY,
-    float speed,
-    const std::function<void()>& callback) {
-
-    if (!GridMapUtils::isValidGridPosition(targetGridX, targetGridY)) {
-        CCLOG("BattleUnitSprite: Invalid target grid (%d, %d)", targetGridX, targetGridY);
-        if (callback) callback();
-        return;
-    }
-
-    // 网格坐标转换为世界坐标后寻路
-    Vec2 targetWorldPos = GridMapUtils::gridToPixelCenter(targetGridX, targetGridY);
-
-    moveToTargetWithPathfinding(targetWorldPos, speed, callback);
-}
-
-void BattleUnitSprite::followPath(
-    const std::vector<Vec2>& path,
-    float speed,
-    const std::function<void()>& callback) {
-
-    if (path.empty()) {
-        CCLOG("BattleUnitSprite: Empty path, nothing to follow");
-        if (callback) callback();
-        return;
-    }
-
-    this->stopActionByTag(MOVE_TAG);
-
-    Vector<FiniteTimeAction*> actions;
-
-    Vec2 currentPos = this->getPosition();
-    bool hasValidMovement = false;
-
-    // 遍历路径点创建移动动画序列
-    for (const auto& waypoint : path) {
-        Vec2 direction = waypoint - currentPos;
-        float distance = direction.length();
-
-        if (distance < 0.1f) {
-            continue;
-        }
-
-        hasValidMovement = true;
-        direction.normalize();
-
-        AnimationType animType;
-        bool flipX;
-        selectWalkAnimation(direction, animType, flipX);
-
-        // 为每个路径点创建动画和移动动作
-        auto playAnim = CallFunc::create([this, animType, flipX]() {
-            this->setFlippedX(flipX);
-            playAnimation(animType, true);
-        });
-
-        float duration = distance / speed;
-        auto moveAction = MoveTo::create(duration, waypoint);
-
-        actions.pushBack(playAnim);
-        actions.pushBack(moveAction);
-
-        currentPos = waypoint;
-    }
-
-    if (!hasValidMovement) {
-        CCLOG("BattleUnitSprite: No valid movement, adding minimum delay");
-        actions.pushBack(DelayTime::create(0.1f));
-    }
-
-    // 路径完成后恢复待机状态
-    auto finishCallback = CallFunc::create([this, callback]() {
-        this->setFlippedX(false);
-        playIdleAnimation();
-
-        CCLOG("BattleUnitSprite: Path completed");
-
-        if (callback) {
-            callback();
-        }
-    });
-
-    actions.pushBack(finishCallback);
-
-    auto sequence = Sequence::create(actions);
-    sequence->setTag(MOVE_TAG);
-    this->runAction(sequence);
-
-    CCLOG("BattleUnitSprite: Following path with %lu waypoints", path.size());
+  playAnimation(animType, false);
 }
 
 void BattleUnitSprite::takeDamage(int damage) {
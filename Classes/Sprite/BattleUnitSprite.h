@@ -8,6 +8,7 @@
 #include "Manager/AnimationManager.h"
 #include "../Util/GridMapUtils.h"
 #include "Component/HealthBarComponent.h"
+#include "Model/TroopHandle.h"
 
 USING_NS_CC;
 
@@ -28,6 +29,9 @@ public:
   virtual bool init(const std::string& unitType);
   virtual void update(float dt) override;
 
+  // 回收到节点池前后调用：恢复满血、初始画面和状态，清除句柄和锁定（不改变兵种）
+  void resetForReuse();
+
   // 基础动画控制
   void playAnimation(AnimationType animType, bool loop = false,
                      const std::function<void()>& callback = nullptr);
@@ -38,53 +42,23 @@ public:
   void playAttackAnimation(const std::function<void()>& callback = nullptr);
   void playDeathAnimation(const std::function<void()>& callback = nullptr);
 
-  // 像素坐标行走
-  void walkToPosition(const Vec2& targetPos, float duration = 2.0f,
-                      const std::function<void()>& callback = nullptr);
-  
-  void walkByOffset(const Vec2& offset, float duration = 2.0f,
-                    const std::function<void()>& callback = nullptr);
-
-  // 网格坐标行走
-  void walkToGrid(int targetGridX, int targetGridY, float speed = 100.0f,
-                  const std::function<void()>& callback = nullptr);
-  
-  void walkFromGridToGrid(int startGridX, int startGridY, 
-                         int targetGridX, int targetGridY,
-                         float speed = 100.0f,
-                         const std::function<void()>& callback = nullptr);
-
-  // 方向攻击
-  void attackInDirection(const Vec2& direction, 
-                        const std::function<void()>& callback = nullptr);
-  
-  void attackTowardPosition(const Vec2& targetPos, 
-                           const std::function<void()>& callback = nullptr);
-  
-  void attackTowardGrid(int targetGridX, int targetGridY,
-                       const std::function<void()>& callback = nullptr);
+  // 战斗表现（由 BattleProcessController 的状态机驱动，不回调逻辑）
+  // 朝向变化时才切换行走动画
+  void faceWalkDirection(const Vec2& direction);
+  // 朝目标播放一次攻击动画
+  void playAttackToward(const Vec2& targetPos);
 
   // 网格位置管理
   void setGridPosition(int gridX, int gridY);
   Vec2 getGridPosition() const { return _currentGridPos; }
   void teleportToGrid(int gridX, int gridY);
 
-  // 寻路移动
-  void moveToTargetWithPathfinding(
-      const Vec2& targetWorldPos, 
-      float speed = 100.0f,
-      const std::function<void()>& callback = nullptr);
-  
-  void moveToGridWithPathfinding(
-      int targetGridX, 
-      int targetGridY, 
-      float speed = 100.0f,
-      const std::function<void()>& callback = nullptr);
-  
-  void followPath(
-      const std::vector<Vec2>& path, 
-      float speed = 100.0f,
-      const std::function<void()>& callback = nullptr);
+  // 所在格（向下取整）
+  int getCellX() const { return _lastGridX; }
+  int getCellY() const { return _lastGridY; }
+
+  // 按当前位置刷新所在格，返回自上次调用以来是否进入过新格子（战斗 tick 中移动后调用）
+  bool takeCellChange();
 
   // 生命值系统
   void takeDamage(int damage);
@@ -97,11 +71,11 @@ public:
   UnitTypeID getUnitTypeID() const { return _unitTypeID; }
   AnimationType getCurrentAnimation() const { return _currentAnimation; }
   bool isAnimating() const { return _isAnimating; }
-  
-  // 状态标志
-  bool isChangingTarget() const { return _isChangingTarget; }
-  void setChangingTarget(bool changing) { _isChangingTarget = changing; }
-  
+
+  // 兵种层分配的句柄（未加入兵种层时为空句柄）
+  TroopHandle getHandle() const { return _handle; }
+  void setHandle(const TroopHandle& handle) { _handle = handle; }
+
   // 建筑锁定状态
   bool isTargetedByBuilding() const { return _isTargetedByBuilding; }
   void setTargetedByBuilding(bool targeted);
@@ -110,13 +84,15 @@ public:
 protected:
   std::string _unitType;
   UnitTypeID _unitTypeID = UnitTypeID::UNKNOWN;
+  const AnimationManager::AnimationTable* _animTable = nullptr;  // 本兵种的预构建动画
   AnimationType _currentAnimation;
   bool _isAnimating;
   Vec2 _currentGridPos;
   int _lastGridX = -999;
   int _lastGridY = -999;
-  bool _isChangingTarget = false;
+  bool _cellChanged = false;        // 进入新格子后尚未被 takeCellChange() 取走
   bool _isTargetedByBuilding = false;
+  TroopHandle _handle;
 
   Vec2 _lastMoveDirection = Vec2::ZERO;
   
@@ -124,14 +100,23 @@ protected:
   int _maxHP = 0;
   
   static const int ANIMATION_TAG = 1000;
-  static const int MOVE_TAG = 1001;
 
   HealthBarComponent* _healthBar = nullptr;
 
+  // 所在格变化时更新网格坐标，并记下格子变化（只在战斗 tick 中按逻辑位置调用）
+  void refreshGridCell();
+
+  // 每帧按显示位置更新Z轴顺序
+  void refreshZOrder();
+
+  // 气球兵上下飘动
+  void startBalloonFloat();
+
   void selectWalkAnimation(const Vec2& direction, AnimationType& outAnimType, bool& outFlipX);
   void selectAttackAnimation(const Vec2& direction, AnimationType& outAnimType, bool& outFlipX);
   
-  float getAngleFromDirection(const Vec2& direction);
+  // 方向所在的八方向扇区（0=右，逆时针每45度一个）
+  static int getOctant(const Vec2& direction);
   
   static UnitTypeID parseUnitType(const std::string& unitType);
   static float getScaleForUnitType(UnitTypeID typeID);
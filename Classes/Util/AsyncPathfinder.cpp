@@ -0,0 +1,181 @@
+﻿// AsyncPathfinder.cpp
+// 异步寻路服务实现：任务队列、工作线程和主线程结果分发
+
+#include "AsyncPathfinder.h"
+#include "GridMapUtils.h"
+#include <algorithm>
+#include <cmath>
+
+USING_NS_CC;
+
+AsyncPathfinder* AsyncPathfinder::_instance = nullptr;
+
+AsyncPathfinder* AsyncPathfinder::getInstance() {
+    if (!_instance) _instance = new AsyncPathfinder();
+    return _instance;
+}
+
+void AsyncPathfinder::destroyInstance() {
+    CC_SAFE_DELETE(_instance);
+}
+
+AsyncPathfinder::AsyncPathfinder()
+    : _stopping(false)
+    , _nextRequestId(1) {
+
+    Director::getInstance()->getScheduler()->schedule(
+        [this](float dt) { this->deliverResults(dt); },
+        this,
+        0.0f,
+        false,
+        "async_pathfinder_delivery"
+    );
+}
+
+AsyncPathfinder::~AsyncPathfinder() {
+    Director::getInstance()->getScheduler()->unschedule("async_pathfinder_delivery", this);
+
+    {
+        std::lock_guard<std::mutex> lock(_jobMutex);
+        _stopping = true;
+        _jobs.clear();
+    }
+    _jobCondition.notify_all();
+
+    for (auto& worker : _workers) {
+        if (worker.joinable()) worker.join();
+    }
+}
+
+bool AsyncPathfinder::isSupported() {
+    // hardware_concurrency() 返回 0 表示无法确定，按不支持处理
+    return std::thread::hardware_concurrency() >= 2;
+}
+
+void AsyncPathfinder::startWorkers() {
+    // 保留一个核心给主线程
+    int hardware = static_cast<int>(std::thread::hardware_concurrency());
+    int count = std::max(1, std::min(MAX_WORKERS, hardware - 1));
+
+    for (int i = 0; i < count; ++i) {
+        _workers.push_back(std::thread(&AsyncPathfinder::workerLoop, this));
+    }
+    CCLOG("AsyncPathfinder: Started %d worker threads", count);
+}
+
+// ===================================================================================
+// 请求与取消（主线程）
+// ===================================================================================
+
+int AsyncPathfinder::requestAttackPlan(const Vec2& unitWorldPos, const BuildingInstance& building,
+                                       int attackRange, int damagePerHit, const PlanCallback& callback) {
+    auto pathfinder = FindPathUtil::getInstance();
+
+    Job job;
+    if (!pathfinder->makeAttackArea(building, attackRange, job.area)) return 0;
+
+    Vec2 startGridPos = GridMapUtils::pixelToGrid(unitWorldPos);
+    job.startX = static_cast<int>(std::floor(startGridPos.x));
+    job.startY = static_cast<int>(std::floor(startGridPos.y));
+    job.requestId = _nextRequestId++;
+    job.snapshot = pathfinder->getGridSnapshot();
+    job.attackRange = attackRange;
+    job.damagePerHit = std::max(damagePerHit, 1);
+
+    if (_workers.empty()) {
+        startWorkers();
+    }
+
+    _callbacks[job.requestId] = callback;
+
+    {
+        std::lock_guard<std::mutex> lock(_jobMutex);
+        _jobs.push_back(job);
+    }
+    _jobCondition.notify_one();
+
+    return job.requestId;
+}
+
+void AsyncPathfinder::cancel(int requestId) {
+    if (_callbacks.erase(requestId) == 0) return;
+
+    std::lock_guard<std::mutex> lock(_jobMutex);
+    for (auto it = _jobs.begin(); it != _jobs.end(); ++it) {
+        if (it->requestId == requestId) {
+            _jobs.erase(it);
+            break;
+        }
+    }
+}
+
+void AsyncPathfinder::cancelAll() {
+    _callbacks.clear();
+    _ready.clear();
+
+    std::lock_guard<std::mutex> lock(_jobMutex);
+    _jobs.clear();
+}
+
+// ===================================================================================
+// 工作线程
+// ===================================================================================
+
+void AsyncPathfinder::workerLoop() {
+    while (true) {
+        Job job;
+        {
+            std::unique_lock<std::mutex> lock(_jobMutex);
+            _jobCondition.wait(lock, [this]() { return _stopping || !_jobs.empty(); });
+            if (_stopping) return;
+
+            job = _jobs.front();
+            _jobs.pop_front();
+        }
+
+        // 只读快照 + 本线程的搜索上下文，不触碰任何单例状态
+        PathGridView grid = job.snapshot->view();
+        AttackPlanSearch search(grid, job.area, job.startX, job.startY, job.damagePerHit, PathSearchContext::current());
+
+        Result result;
+        result.requestId = job.requestId;
+        result.found = (search.step() == AttackPlanSearch::Status::FOUND);
+        if (result.found) {
+            std::vector<int> cells;
+            search.getPath(cells);
+            FindPathUtil::buildWallBreakPlan(grid, cells, job.attackRange, result.plan);
+            result.plan.totalCost = search.getCost();
+        }
+
+        Director::getInstance()->getScheduler()->performFunctionInCocosThread([result]() {
+            AsyncPathfinder::onResultReady(result);
+        });
+    }
+}
+
+// ===================================================================================
+// 结果分发（主线程）
+// ===================================================================================
+
+void AsyncPathfinder::onResultReady(const Result& result) {
+    // 服务可能已在结果送达前销毁
+    if (!_instance) return;
+    _instance->_ready.push_back(result);
+}
+
+void AsyncPathfinder::deliverResults(float) {
+    int delivered = 0;
+    while (!_ready.empty() && delivered < MAX_RESULTS_PER_FRAME) {
+        Result result = _ready.front();
+        _ready.pop_front();
+
+        auto it = _callbacks.find(result.requestId);
+        if (it == _callbacks.end()) continue;  // 已取消
+
+        // 先移出再回调，回调中可以发起新请求
+        PlanCallback callback = it->second;
+        _callbacks.erase(it);
+        callback(result.found, result.plan);
+        delivered++;
+    }
+}
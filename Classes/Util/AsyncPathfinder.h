@@ -0,0 +1,110 @@
+﻿// AsyncPathfinder.h
+// 异步寻路服务声明：工作线程池在地图快照上执行破墙路线规划，结果回到主线程按帧限量分发
+
+#ifndef __ASYNC_PATHFINDER_H__
+#define __ASYNC_PATHFINDER_H__
+
+#include "cocos2d.h"
+#include "FindPathUtil.h"
+#include <functional>
+#include <memory>
+#include <deque>
+#include <unordered_map>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+/**
+ * @brief 异步寻路服务（单例）
+ *
+ * 工作流程：
+ * 1. 主线程调用 requestAttackPlan()：换算起点和攻击区域，取当前地图的不可变快照，
+ *    连同参数放入任务队列，立即返回请求ID
+ * 2. 工作线程取出任务，用本线程的 PathSearchContext 在快照上执行 AttackPlanSearch
+ * 3. 结果经 Scheduler::performFunctionInCocosThread 送回主线程的就绪队列
+ * 4. 主线程每帧最多分发 MAX_RESULTS_PER_FRAME 个结果，避免大量结果挤在同一帧回调
+ *
+ * 注意事项：
+ * - 除工作线程内部外，所有接口只能在主线程调用
+ * - 快照生成后地图可能继续变化（建筑被摧毁只会打开格子），
+ *   回调方应自行确认目标/城墙仍然存在
+ * - 取消的请求不会再回调
+ */
+class AsyncPathfinder {
+public:
+    typedef FindPathUtil::AttackPlanCallback PlanCallback;
+
+    // 每帧最多分发的结果数
+    static const int MAX_RESULTS_PER_FRAME = 8;
+
+    // 工作线程数上限
+    static const int MAX_WORKERS = 4;
+
+    static AsyncPathfinder* getInstance();
+    static void destroyInstance();
+
+    // 设备是否适合使用工作线程（至少两个硬件线程，一个留给主线程）
+    static bool isSupported();
+
+    /**
+     * @brief 提交破墙路线规划请求
+     * @return 请求ID（> 0）；建筑配置缺失时返回 0 且不会回调
+     */
+    int requestAttackPlan(const cocos2d::Vec2& unitWorldPos, const BuildingInstance& targetBuilding,
+                          int attackRange, int damagePerHit, const PlanCallback& callback);
+
+    // 取消请求（尚未开始的任务直接出队，已完成的结果丢弃）
+    void cancel(int requestId);
+
+    // 取消全部请求
+    void cancelAll();
+
+    // 尚未回调的请求数
+    int getPendingCount() const { return static_cast<int>(_callbacks.size()); }
+
+private:
+    AsyncPathfinder();
+    ~AsyncPathfinder();
+
+    static AsyncPathfinder* _instance;
+
+    struct Job {
+        int requestId;
+        std::shared_ptr<const FindPathUtil::GridSnapshot> snapshot;
+        int startX;
+        int startY;
+        AttackArea area;
+        int attackRange;
+        int damagePerHit;
+    };
+
+    struct Result {
+        int requestId;
+        bool found;
+        FindPathUtil::WallBreakPlan plan;
+    };
+
+    // ========== 工作线程共享（_jobMutex 保护） ==========
+    std::vector<std::thread> _workers;
+    std::mutex _jobMutex;
+    std::condition_variable _jobCondition;
+    std::deque<Job> _jobs;
+    bool _stopping;
+
+    // ========== 仅主线程访问 ==========
+    std::unordered_map<int, PlanCallback> _callbacks;
+    std::deque<Result> _ready;
+    int _nextRequestId;
+
+    void startWorkers();
+    void workerLoop();
+
+    // 工作线程完成后经 performFunctionInCocosThread 调用
+    static void onResultReady(const Result& result);
+
+    // 每帧分发就绪结果
+    void deliverResults(float dt);
+};
+
+#endif // __ASYNC_PATHFINDER_H__
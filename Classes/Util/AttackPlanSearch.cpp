@@ -0,0 +1,119 @@
+﻿// AttackPlanSearch.cpp
+// 攻击位置搜索实现：多终点 A*、破墙代价以及按展开节点数分段执行
+
+#include "AttackPlanSearch.h"
+#include <algorithm>
+
+AttackPlanSearch::AttackPlanSearch(const PathGridView& grid, const AttackArea& area,
+                                   int startX, int startY, int damagePerHit, PathSearchContext& context)
+    : _grid(grid)
+    , _area(area)
+    , _damagePerHit(damagePerHit)
+    , _context(context)
+    , _status(Status::RUNNING)
+    , _goalIndex(-1)
+    , _expanded(0)
+    , _cost(0) {
+
+    if (!_grid.isWalkable(startX, startY)) {
+        _status = Status::FAILED;
+        return;
+    }
+
+    _context.beginQuery(_grid.width * _grid.height);
+
+    int startIndex = startY * _grid.width + startX;
+    _context.touch(startIndex).g = 0;
+    _context.pushOrDecrease(startIndex, heuristic(startX, startY));
+}
+
+int AttackPlanSearch::heuristic(int x, int y) const {
+    // 到扩展矩形的八方向距离。所有攻击格都在矩形内，因此可采纳
+    int dx = std::max(0, std::max(_area.minX - x, x - _area.maxX));
+    int dy = std::max(0, std::max(_area.minY - y, y - _area.maxY));
+    return 10 * (dx + dy) - 6 * std::min(dx, dy);
+}
+
+int AttackPlanSearch::wallBreakCost(int index) const {
+    int hp = _grid.wallHP[index];
+    if (hp <= 0) return 0;
+
+    // 打穿所需攻击次数（向上取整）
+    int hits = (hp + _damagePerHit - 1) / _damagePerHit;
+    return hits * WALL_COST_PER_HIT;
+}
+
+void AttackPlanSearch::finish(Status status) {
+    _status = status;
+    if (status == Status::FOUND) {
+        _cost = _context.touch(_goalIndex).g;
+    }
+    _context.endQuery();
+}
+
+AttackPlanSearch::Status AttackPlanSearch::step(int maxExpansions) {
+    if (_status != Status::RUNNING) return _status;
+
+    const int dirs[8][2] = {
+        {0, 1}, {0, -1}, {-1, 0}, {1, 0},
+        {-1, -1}, {1, -1}, {-1, 1}, {1, 1}
+    };
+    bool breakWalls = _damagePerHit > 0;
+    int width = _grid.width;
+
+    for (int budget = maxExpansions; budget > 0; --budget) {
+        if (_context.isOpenEmpty()) {
+            finish(Status::FAILED);
+            return _status;
+        }
+
+        int currIndex = _context.popMin();
+        _expanded++;
+
+        int cx = currIndex % width;
+        int cy = currIndex / width;
+
+        // 第一个出堆的攻击格就是代价最小的攻击位置
+        if (_area.contains(cx, cy)) {
+            _goalIndex = currIndex;
+            finish(Status::FOUND);
+            return _status;
+        }
+
+        int currentG = _context.touch(currIndex).g;
+
+        for (int i = 0; i < 8; ++i) {
+            int nx = cx + dirs[i][0];
+            int ny = cy + dirs[i][1];
+            if (!_grid.isPassable(nx, ny, breakWalls)) continue;
+
+            int neighborIndex = ny * width + nx;
+            PathSearchContext::Node& neighbor = _context.touch(neighborIndex);
+            if (neighbor.closed) continue;
+
+            int moveCost = (dirs[i][0] != 0 && dirs[i][1] != 0) ? 14 : 10;
+            if (breakWalls) {
+                moveCost += wallBreakCost(neighborIndex);
+            }
+            int tentativeG = currentG + moveCost;
+
+            if (tentativeG < neighbor.g) {
+                neighbor.parent = currIndex;
+                neighbor.g = tentativeG;
+                _context.pushOrDecrease(neighborIndex, tentativeG + heuristic(nx, ny));
+            }
+        }
+    }
+
+    return _status;
+}
+
+void AttackPlanSearch::getPath(std::vector<int>& outPath) const {
+    outPath.clear();
+    if (_status != Status::FOUND) return;
+
+    for (int traceIndex = _goalIndex; traceIndex != -1; traceIndex = _context.touch(traceIndex).parent) {
+        outPath.push_back(traceIndex);
+    }
+    std::reverse(outPath.begin(), outPath.end());
+}
@@ -0,0 +1,112 @@
+﻿// AttackPlanSearch.h
+// 攻击位置搜索声明：以建筑攻击区域内所有格子为终点的多终点 A*，可选把城墙按破墙代价计入，支持分段执行
+
+#ifndef __ATTACK_PLAN_SEARCH_H__
+#define __ATTACK_PLAN_SEARCH_H__
+
+#include "PathSearchContext.h"
+#include <vector>
+#include <cstdint>
+#include <climits>
+
+/**
+ * @brief 只读网格视图
+ *
+ * 搜索只通过它读取地图，既可以指向 FindPathUtil 的实时地图，
+ * 也可以指向工作线程持有的不可变快照。
+ * 格子值与 FindPathUtil::GridType 一致：0 = 空地，2 = 城墙，其余不可通行。
+ */
+struct PathGridView {
+    static const uint8_t CELL_EMPTY = 0;
+    static const uint8_t CELL_WALL = 2;
+
+    const uint8_t* cells;       // 网格类型
+    const int* wallOwner;       // 城墙格所属建筑ID（非城墙为0）
+    const int* wallHP;          // 城墙格剩余血量（非城墙为0）
+    int width;
+    int height;
+
+    bool inBounds(int x, int y) const { return x >= 0 && x < width && y >= 0 && y < height; }
+    bool isWalkable(int x, int y) const { return inBounds(x, y) && cells[y * width + x] == CELL_EMPTY; }
+    bool isPassable(int x, int y, bool breakWalls) const {
+        if (!inBounds(x, y)) return false;
+        uint8_t cell = cells[y * width + x];
+        return cell == CELL_EMPTY || (breakWalls && cell == CELL_WALL);
+    }
+};
+
+/**
+ * @brief 攻击区域：建筑向外扩展攻击范围后的矩形，去掉建筑本身
+ *
+ * 矩形内、建筑外的格子到建筑的切比雪夫距离都在攻击范围内
+ */
+struct AttackArea {
+    int minX, minY, maxX, maxY;     // 扩展后的矩形（含边界）
+    int bX, bY, bW, bH;             // 建筑占地
+
+    bool isInsideBuilding(int x, int y) const {
+        return x >= bX && x < bX + bW && y >= bY && y < bY + bH;
+    }
+    bool contains(int x, int y) const {
+        return x >= minX && x <= maxX && y >= minY && y <= maxY && !isInsideBuilding(x, y);
+    }
+};
+
+/**
+ * @brief 多终点攻击位置搜索
+ *
+ * 1. 攻击区域内所有可通行格都是终点，启发式为到扩展矩形的八方向距离（可采纳），
+ *    第一个出堆的终点就是代价最小的攻击位置；开放列表耗尽即说明不可达
+ * 2. damagePerHit > 0 时城墙可通行，进入城墙格额外付出
+ *    ceil(剩余血量 / damagePerHit) * WALL_COST_PER_HIT 的破墙代价
+ * 3. step() 可以限制本次最多展开的节点数，未完成的搜索下次调用继续，
+ *    用于分帧规划；一次性搜索直接 step() 到底即可
+ *
+ * 搜索状态保存在传入的 PathSearchContext 中，
+ * 同一个上下文在搜索完成前不能用于其他查询。本类不依赖引擎。
+ */
+class AttackPlanSearch {
+public:
+    // 每次攻击约1秒，单位以100像素/秒移动约走3格，折合直线移动代价30
+    static const int WALL_COST_PER_HIT = 30;
+
+    enum class Status : uint8_t {
+        RUNNING = 0,    // 尚未完成，需要继续 step()
+        FOUND = 1,      // 找到攻击位置
+        FAILED = 2      // 不可达
+    };
+
+    AttackPlanSearch(const PathGridView& grid, const AttackArea& area,
+                     int startX, int startY, int damagePerHit, PathSearchContext& context);
+
+    // 继续搜索，最多展开 maxExpansions 个节点
+    Status step(int maxExpansions = INT_MAX);
+
+    Status getStatus() const { return _status; }
+
+    // 搜索至今展开的节点数
+    int getExpanded() const { return _expanded; }
+
+    // 找到时：整条路线的代价（含破墙）
+    int getCost() const { return _cost; }
+
+    // 找到时：输出从起点到攻击位置的格子索引序列（含起点）
+    void getPath(std::vector<int>& outPath) const;
+
+private:
+    PathGridView _grid;
+    AttackArea _area;
+    int _damagePerHit;
+    PathSearchContext& _context;
+
+    Status _status;
+    int _goalIndex;
+    int _expanded;
+    int _cost;
+
+    int heuristic(int x, int y) const;
+    int wallBreakCost(int index) const;
+    void finish(Status status);
+};
+
+#endif // __ATTACK_PLAN_SEARCH_H__
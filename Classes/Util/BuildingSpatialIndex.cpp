@@ -0,0 +1,345 @@
+﻿// BuildingSpatialIndex.cpp
+// 建筑空间索引实现：建立分桶网格、移除摧毁建筑和按环扩展的最近邻查询
+
+#include "BuildingSpatialIndex.h"
+#include "GridMapUtils.h"
+#include "../Model/VillageData.h"
+#include "../Model/BuildingConfig.h"
+#include "../Model/BattleBuildingState.h"
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+
+USING_NS_CC;
+
+BuildingSpatialIndex::BuildingSpatialIndex()
+    : _originX(0.0f)
+    , _originY(0.0f)
+    , _cols(0)
+    , _rows(0)
+    , _maxFootprint(0)
+    , _sourceData(nullptr)
+    , _sourceSize(0)
+    , _sourceVersion(0) {
+
+    for (auto& grid : _grids) {
+        grid.count = 0;
+    }
+}
+
+BuildingCategory BuildingSpatialIndex::categoryOf(int buildingType) {
+    if (buildingType == 303) return BuildingCategory::WALL;
+    if (buildingType == 301 || buildingType == 302) return BuildingCategory::DEFENSE;
+    if (buildingType == 1 || buildingType == 202 || buildingType == 203 ||
+        buildingType == 204 || buildingType == 205) {
+        return BuildingCategory::RESOURCE;
+    }
+    return BuildingCategory::OTHER;
+}
+
+void BuildingSpatialIndex::clear() {
+    for (auto& grid : _grids) {
+        grid.buckets.clear();
+        grid.count = 0;
+    }
+    _locations.clear();
+    _cols = 0;
+    _rows = 0;
+    _maxFootprint = 0;
+    _sourceData = nullptr;
+    _sourceSize = 0;
+    _sourceVersion = 0;
+}
+
+bool BuildingSpatialIndex::isBuiltFor(const std::vector<BuildingInstance>& buildings) const {
+    return _sourceVersion == 0 && _sourceData == buildings.data() && _sourceSize == buildings.size();
+}
+
+bool BuildingSpatialIndex::isBuiltFor(const BattleBuildingState& state) const {
+    return _sourceVersion != 0 && _sourceVersion == state.getVersion();
+}
+
+// ===================================================================================
+// 建立索引
+// ===================================================================================
+
+void BuildingSpatialIndex::build(const std::vector<BuildingInstance>& buildings) {
+    clear();
+    _sourceData = buildings.data();
+    _sourceSize = buildings.size();
+
+    // 先算出所有中心，再确定桶网格的范围
+    std::vector<Entry> entries;
+    std::vector<int> categories;
+    entries.reserve(buildings.size());
+    categories.reserve(buildings.size());
+
+    for (size_t i = 0; i < buildings.size(); ++i) {
+        const BuildingInstance& building = buildings[i];
+        if (building.isDestroyed || building.currentHP <= 0) continue;
+        if (building.state == BuildingInstance::State::PLACING) continue;
+        if (building.type >= 400 && building.type < 500) continue;
+
+        BuildingCategory category = categoryOf(building.type);
+
+        Entry entry;
+        entry.building = &building;
+        entry.order = static_cast<int>(i);
+        entry.gridX = building.gridX;
+        entry.gridY = building.gridY;
+        entry.gridWidth = 1;
+        entry.gridHeight = 1;
+
+        if (category == BuildingCategory::WALL) {
+            entry.center = GridMapUtils::gridToPixelCenter(building.gridX, building.gridY);
+        } else {
+            auto config = BuildingConfig::getInstance()->getConfig(building.type);
+            if (!config) continue;
+            entry.center = GridMapUtils::getBuildingCenterPixel(
+                building.gridX, building.gridY,
+                config->gridWidth, config->gridHeight
+            );
+            entry.gridWidth = config->gridWidth;
+            entry.gridHeight = config->gridHeight;
+        }
+
+        entries.push_back(entry);
+        categories.push_back(static_cast<int>(category));
+    }
+
+    insertEntries(entries, categories);
+}
+
+void BuildingSpatialIndex::build(const BattleBuildingState& state) {
+    clear();
+    _sourceVersion = state.getVersion();
+
+    // 中心和类别在战斗状态里已算好，只需按存活和类别筛选
+    std::vector<Entry> entries;
+    std::vector<int> categories;
+    entries.reserve(state.size());
+    categories.reserve(state.size());
+
+    const uint32_t categoryMask = BATTLE_RESOURCE | BATTLE_DEFENSE | BATTLE_WALL | BATTLE_OTHER;
+
+    for (int i = 0; i < state.size(); ++i) {
+        if (!state.isAlive(i)) continue;
+
+        uint32_t flags = state.getFlags(i) & categoryMask;
+        if (!flags) continue;  // 陷阱
+
+        int category = 0;
+        while (!(flags & (1u << category))) category++;
+
+        Entry entry;
+        entry.building = &state.getBuilding(i);
+        entry.center = state.getWorldCenter(i);
+        entry.order = i;
+        entry.gridX = entry.building->gridX;
+        entry.gridY = entry.building->gridY;
+        entry.gridWidth = state.getGridWidth(i);
+        entry.gridHeight = state.getGridHeight(i);
+
+        entries.push_back(entry);
+        categories.push_back(category);
+    }
+
+    insertEntries(entries, categories);
+}
+
+void BuildingSpatialIndex::insertEntries(const std::vector<Entry>& entries, const std::vector<int>& categories) {
+    if (entries.empty()) return;
+
+    float minX = FLT_MAX, minY = FLT_MAX, maxX = -FLT_MAX, maxY = -FLT_MAX;
+    for (const Entry& entry : entries) {
+        minX = std::min(minX, entry.center.x);
+        minY = std::min(minY, entry.center.y);
+        maxX = std::max(maxX, entry.center.x);
+        maxY = std::max(maxY, entry.center.y);
+        _maxFootprint = std::max(_maxFootprint, std::max(entry.gridWidth, entry.gridHeight));
+    }
+
+    _originX = minX;
+    _originY = minY;
+    _cols = static_cast<int>((maxX - minX) / BUCKET_SIZE) + 1;
+    _rows = static_cast<int>((maxY - minY) / BUCKET_SIZE) + 1;
+
+    for (auto& grid : _grids) {
+        grid.buckets.assign(_cols * _rows, std::vector<Entry>());
+    }
+
+    for (size_t k = 0; k < entries.size(); ++k) {
+        const Entry& entry = entries[k];
+        int bucket = bucketRow(entry.center.y) * _cols + bucketCol(entry.center.x);
+
+        CategoryGrid& grid = _grids[categories[k]];
+        grid.buckets[bucket].push_back(entry);
+        grid.count++;
+
+        _locations[entry.building] = std::make_pair(categories[k], bucket);
+    }
+}
+
+void BuildingSpatialIndex::remove(const BuildingInstance* building) {
+    auto it = _locations.find(building);
+    if (it == _locations.end()) return;
+
+    CategoryGrid& grid = _grids[it->second.first];
+    std::vector<Entry>& bucket = grid.buckets[it->second.second];
+    for (size_t k = 0; k < bucket.size(); ++k) {
+        if (bucket[k].building == building) {
+            bucket[k] = bucket.back();
+            bucket.pop_back();
+            grid.count--;
+            break;
+        }
+    }
+    _locations.erase(it);
+}
+
+int BuildingSpatialIndex::getCount(BuildingCategory category) const {
+    return _grids[static_cast<int>(category)].count;
+}
+
+// ===================================================================================
+// 最近邻查询
+// ===================================================================================
+
+int BuildingSpatialIndex::bucketCol(float x) const {
+    return static_cast<int>(std::floor((x - _originX) / BUCKET_SIZE));
+}
+
+int BuildingSpatialIndex::bucketRow(float y) const {
+    return static_cast<int>(std::floor((y - _originY) / BUCKET_SIZE));
+}
+
+const BuildingInstance* BuildingSpatialIndex::findNearest(const Vec2& worldPos, int categoryMask) const {
+    const Entry* best = nullptr;
+    float bestDistSq = FLT_MAX;
+
+    for (int c = 0; c < static_cast<int>(BuildingCategory::COUNT); ++c) {
+        if (!(categoryMask & (1 << c))) continue;
+        if (_grids[c].count == 0) continue;
+        searchCategory(_grids[c], worldPos, best, bestDistSq);
+    }
+
+    return best ? best->building : nullptr;
+}
+
+void BuildingSpatialIndex::searchCategory(const CategoryGrid& grid, const Vec2& worldPos,
+                                          const Entry*& best, float& bestDistSq) const {
+    // 查询点可能在桶网格之外，桶坐标不截断
+    int qc = bucketCol(worldPos.x);
+    int qr = bucketRow(worldPos.y);
+
+    // 覆盖整个桶网格所需的最大环数
+    int maxRing = std::max(std::max(std::abs(qc), std::abs(qc - (_cols - 1))),
+                           std::max(std::abs(qr), std::abs(qr - (_rows - 1))));
+
+    for (int ring = 0; ring <= maxRing; ++ring) {
+        int rowBegin = std::max(qr - ring, 0);
+        int rowEnd = std::min(qr + ring, _rows - 1);
+
+        for (int row = rowBegin; row <= rowEnd; ++row) {
+            // 环的上下两行取整行，中间各行只取左右两端
+            bool fullRow = (row == qr - ring || row == qr + ring);
+            int step = fullRow ? 1 : std::max(2 * ring, 1);
+
+            for (int col = qc - ring; col <= qc + ring; col += step) {
+                if (col < 0 || col >= _cols) continue;
+
+                for (const Entry& entry : grid.buckets[row * _cols + col]) {
+                    const BuildingInstance* building = entry.building;
+                    if (building->isDestroyed || building->currentHP <= 0) continue;
+
+                    float distSq = worldPos.distanceSquared(entry.center);
+                    if (distSq < bestDistSq || (distSq == bestDistSq && best && entry.order < best->order)) {
+                        bestDistSq = distSq;
+                        best = &entry;
+                    }
+                }
+            }
+        }
+
+        // 更外圈的桶到查询点的距离至少是到当前方块边界的距离
+        if (best) {
+            float left = worldPos.x - (_originX + (qc - ring) * BUCKET_SIZE);
+            float right = (_originX + (qc + ring + 1) * BUCKET_SIZE) - worldPos.x;
+            float bottom = worldPos.y - (_originY + (qr - ring) * BUCKET_SIZE);
+            float top = (_originY + (qr + ring + 1) * BUCKET_SIZE) - worldPos.y;
+            float margin = std::min(std::min(left, right), std::min(bottom, top));
+            if (bestDistSq < margin * margin) return;
+        }
+    }
+}
+
+// ===================================================================================
+// 范围查询
+// ===================================================================================
+
+void BuildingSpatialIndex::findInRadius(const Vec2& gridCenter, float radius, int categoryMask,
+                                        std::vector<const BuildingInstance*>& out) const {
+    out.clear();
+    if (_cols == 0 || radius <= 0.0f) return;
+
+    // 与圆相交的占地矩形一定落在圆的外接方块向外扩展最大占地边长的范围内，
+    // 其中心也一定在该范围四个角映射到世界坐标后的包围盒内
+    int minGX = static_cast<int>(std::floor(gridCenter.x - radius)) - _maxFootprint;
+    int minGY = static_cast<int>(std::floor(gridCenter.y - radius)) - _maxFootprint;
+    int maxGX = static_cast<int>(std::ceil(gridCenter.x + radius)) + _maxFootprint;
+    int maxGY = static_cast<int>(std::ceil(gridCenter.y + radius)) + _maxFootprint;
+
+    const Vec2 corners[4] = {
+        GridMapUtils::gridToPixel(minGX, minGY),
+        GridMapUtils::gridToPixel(maxGX, minGY),
+        GridMapUtils::gridToPixel(minGX, maxGY),
+        GridMapUtils::gridToPixel(maxGX, maxGY)
+    };
+    float minX = FLT_MAX, minY = FLT_MAX, maxX = -FLT_MAX, maxY = -FLT_MAX;
+    for (const Vec2& corner : corners) {
+        minX = std::min(minX, corner.x);
+        minY = std::min(minY, corner.y);
+        maxX = std::max(maxX, corner.x);
+        maxY = std::max(maxY, corner.y);
+    }
+
+    int colBegin = std::max(bucketCol(minX), 0);
+    int colEnd = std::min(bucketCol(maxX), _cols - 1);
+    int rowBegin = std::max(bucketRow(minY), 0);
+    int rowEnd = std::min(bucketRow(maxY), _rows - 1);
+
+    float radiusSq = radius * radius;
+    std::vector<const Entry*> hits;
+
+    for (int c = 0; c < static_cast<int>(BuildingCategory::COUNT); ++c) {
+        if (!(categoryMask & (1 << c))) continue;
+        const CategoryGrid& grid = _grids[c];
+        if (grid.count == 0) continue;
+
+        for (int row = rowBegin; row <= rowEnd; ++row) {
+            for (int col = colBegin; col <= colEnd; ++col) {
+                for (const Entry& entry : grid.buckets[row * _cols + col]) {
+                    const BuildingInstance* building = entry.building;
+                    if (building->isDestroyed || building->currentHP <= 0) continue;
+
+                    // 圆心到占地矩形的最近距离
+                    float dx = std::max(0.0f, std::max(entry.gridX - gridCenter.x,
+                                                       gridCenter.x - (entry.gridX + entry.gridWidth)));
+                    float dy = std::max(0.0f, std::max(entry.gridY - gridCenter.y,
+                                                       gridCenter.y - (entry.gridY + entry.gridHeight)));
+                    if (dx * dx + dy * dy <= radiusSq) {
+                        hits.push_back(&entry);
+                    }
+                }
+            }
+        }
+    }
+
+    // 桶内顺序会因移除而变化，按建筑列表顺序输出保证结果稳定
+    std::sort(hits.begin(), hits.end(), [](const Entry* a, const Entry* b) { return a->order < b->order; });
+
+    out.reserve(hits.size());
+    for (const Entry* entry : hits) {
+        out.push_back(entry->building);
+    }
+}
@@ -0,0 +1,132 @@
+﻿// BuildingSpatialIndex.h
+// 建筑空间索引声明：按类别分桶的均匀网格，预存建筑中心和占地，按环扩展查找最近建筑，按占地做范围查询
+
+#ifndef __BUILDING_SPATIAL_INDEX_H__
+#define __BUILDING_SPATIAL_INDEX_H__
+
+#include "cocos2d.h"
+#include <vector>
+#include <unordered_map>
+
+struct BuildingInstance;
+class BattleBuildingState;
+
+// 目标类别（陷阱不参与索引）
+enum class BuildingCategory {
+    RESOURCE = 0,   // 大本营、资源生产和储存建筑
+    DEFENSE = 1,    // 防御建筑
+    WALL = 2,       // 城墙
+    OTHER = 3,      // 其余建筑
+    COUNT = 4
+};
+
+/**
+ * @brief 存活建筑的空间索引
+ *
+ * 1. build() 遍历一次建筑列表，查一次配置、算一次中心坐标，按类别放入像素空间的均匀网格
+ * 2. findNearest() 从查询点所在的桶开始一圈圈向外扩展，
+ *    已找到的最近距离不超过下一圈的最小可能距离时停止
+ * 3. remove() 在建筑被摧毁时把它从桶中移除，查询代价只与附近的建筑数有关
+ * 4. findInRadius() 只检查可能与圆相交的桶，再按占地矩形到圆心的距离筛选（溅射伤害）
+ *
+ * 距离与原线性扫描一致：世界坐标下到建筑中心的直线距离（城墙取所在格中心），
+ * 距离相同时取建筑列表中靠前的一个。
+ * 索引保存的是建筑列表中的指针，列表重新加载后必须重新 build()。
+ */
+class BuildingSpatialIndex {
+public:
+    // 桶的边长（像素），约 4~5 格
+    static const int BUCKET_SIZE = 128;
+
+    BuildingSpatialIndex();
+
+    // 按建筑列表重建索引（跳过已摧毁、放置中的建筑和陷阱）
+    void build(const std::vector<BuildingInstance>& buildings);
+
+    // 按战斗建筑状态重建索引（直接使用其中预先算好的中心和类别）
+    void build(const BattleBuildingState& state);
+
+    // 清空索引
+    void clear();
+
+    // 移除建筑（被摧毁时调用），不在索引中则忽略
+    void remove(const BuildingInstance* building);
+
+    // 索引是否对应该建筑列表（列表地址或长度变化即失效）
+    bool isBuiltFor(const std::vector<BuildingInstance>& buildings) const;
+
+    // 索引是否由该战斗建筑状态的当前版本建立
+    bool isBuiltFor(const BattleBuildingState& state) const;
+
+    /**
+     * @brief 查找最近的存活建筑
+     * @param categoryMask 参与查找的类别位掩码（categoryBit 的组合）
+     * @return 没有符合条件的建筑时返回 nullptr
+     */
+    const BuildingInstance* findNearest(const cocos2d::Vec2& worldPos, int categoryMask) const;
+
+    /**
+     * @brief 查找占地与圆相交的存活建筑
+     * @param gridCenter 圆心（网格坐标，可带小数）
+     * @param radius 半径（格子单位）
+     * @param out 结果按建筑列表中的顺序排列（先清空）
+     */
+    void findInRadius(const cocos2d::Vec2& gridCenter, float radius, int categoryMask,
+                      std::vector<const BuildingInstance*>& out) const;
+
+    // 某类别在 findNearest 中对应的掩码位
+    static int categoryBit(BuildingCategory category) { return 1 << static_cast<int>(category); }
+
+    // 建筑类型所属类别
+    static BuildingCategory categoryOf(int buildingType);
+
+    // 某类别当前的建筑数
+    int getCount(BuildingCategory category) const;
+
+private:
+    struct Entry {
+        const BuildingInstance* building;
+        cocos2d::Vec2 center;       // 预先计算的中心坐标
+        int order;                  // 在建筑列表中的下标，距离相同时比较
+        int gridX;                  // 占地矩形（网格坐标）
+        int gridY;
+        int gridWidth;
+        int gridHeight;
+    };
+
+    struct CategoryGrid {
+        std::vector<std::vector<Entry>> buckets;
+        int count;
+    };
+
+    CategoryGrid _grids[static_cast<int>(BuildingCategory::COUNT)];
+
+    // 桶网格覆盖的像素范围
+    float _originX;
+    float _originY;
+    int _cols;
+    int _rows;
+
+    // 最大占地边长，范围查询据此扩大桶的检查范围
+    int _maxFootprint;
+
+    // 建筑 -> (类别, 桶下标)，用于移除
+    std::unordered_map<const BuildingInstance*, std::pair<int, int>> _locations;
+
+    // 建立索引时的建筑列表
+    const BuildingInstance* _sourceData;
+    size_t _sourceSize;
+    unsigned int _sourceVersion;    // 由战斗建筑状态建立时为其版本号，否则为 0
+
+    // 按中心确定桶网格范围并放入各类别的桶
+    void insertEntries(const std::vector<Entry>& entries, const std::vector<int>& categories);
+
+    int bucketCol(float x) const;
+    int bucketRow(float y) const;
+
+    // 在单个类别中按环扩展查找，结果与 bestDistSq/bestOrder 比较后更新
+    void searchCategory(const CategoryGrid& grid, const cocos2d::Vec2& worldPos,
+                        const Entry*& best, float& bestDistSq) const;
+};
+
+#endif // __BUILDING_SPATIAL_INDEX_H__
@@ -9,6 +9,12 @@
 #include "../Manager/BuildingManager.h"
 #include "../Model/BuildingConfig.h"
 #include "../Scene/VillageScene.h"
+#include "FindPathUtil.h"
+#include "GridMapUtils.h"
+#include "RandomBattleMapGenerator.h"
+#include <algorithm>
+#include <chrono>
+#include <random>
 
 USING_NS_CC;
 
@@ -202,3 +208,237 @@ void DebugHelper::forceSave() {
     dataManager->saveToFile("village.json");
     CCLOG("DebugHelper: Force saved to village.json");
 }
+
+// ========== 性能测试实现 ==========
+
+std::string DebugHelper::benchmarkPathfindingMapUpdate(int rounds) {
+    auto pathfinder = FindPathUtil::getInstance();
+    BattleMapData mapData = RandomBattleMapGenerator::generate(3);
+
+    // 需要逐个摧毁的建筑（陷阱不在寻路地图中）
+    std::vector<size_t> victims;
+    int wallCount = 0;
+    for (size_t i = 0; i < mapData.buildings.size(); ++i) {
+        int type = mapData.buildings[i].type;
+        if (type >= 400 && type < 500) continue;
+        victims.push_back(i);
+        if (type == 303) wallCount++;
+    }
+
+    typedef std::chrono::steady_clock Clock;
+    double fullMs = 0.0;
+    double incrementalMs = 0.0;
+
+    for (int round = 0; round < rounds; ++round) {
+        // 旧方案：每次摧毁都全量重建
+        std::vector<BuildingInstance> buildings = mapData.buildings;
+        pathfinder->rebuildPathfindingMap(buildings);
+        auto start = Clock::now();
+        for (size_t idx : victims) {
+            buildings[idx].isDestroyed = true;
+            buildings[idx].currentHP = 0;
+            pathfinder->rebuildPathfindingMap(buildings);
+        }
+        fullMs += std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+
+        // 新方案：只清除被摧毁建筑的占地
+        buildings = mapData.buildings;
+        pathfinder->rebuildPathfindingMap(buildings);
+        start = Clock::now();
+        for (size_t idx : victims) {
+            buildings[idx].isDestroyed = true;
+            buildings[idx].currentHP = 0;
+            pathfinder->markBuildingRemoved(buildings[idx]);
+        }
+        incrementalMs += std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+    }
+
+    // 恢复为当前数据（村庄或战斗地图）
+    pathfinder->updatePathfindingMap();
+
+    std::string summary = StringUtils::format(
+        "地图更新(%d建筑/%d城墙, %d轮): 全量 %.3fms, 增量 %.3fms",
+        (int)victims.size(), wallCount, rounds, fullMs, incrementalMs);
+
+    CCLOG("DebugHelper: [Benchmark] map update - %zu destructions x %d rounds", victims.size(), rounds);
+    CCLOG("  Full rebuild:  total %.3f ms, %.4f ms per destruction",
+          fullMs, victims.empty() ? 0.0 : fullMs / (victims.size() * rounds));
+    CCLOG("  Incremental:   total %.3f ms, %.4f ms per destruction",
+          incrementalMs, victims.empty() ? 0.0 : incrementalMs / (victims.size() * rounds));
+
+    return summary;
+}
+
+std::string DebugHelper::benchmarkHierarchicalPathfinding(int queriesPerSize) {
+    typedef std::chrono::steady_clock Clock;
+    typedef FindPathUtil::SearchMode SearchMode;
+
+    auto pathfinder = FindPathUtil::getInstance();
+    const int mapSizes[] = { 44, 128, 256 };
+    const int baseSize = GridMapUtils::GRID_WIDTH;
+
+    // 路径长度（直线10/对角14）
+    auto pathCost = [](const std::vector<Vec2>& path) {
+        int cost = 0;
+        for (size_t i = 1; i < path.size(); ++i) {
+            bool diagonal = path[i].x != path[i - 1].x && path[i].y != path[i - 1].y;
+            cost += diagonal ? 14 : 10;
+        }
+        return cost;
+    };
+
+    std::mt19937 rng(20240101);
+    std::string summary;
+
+    for (int size : mapSizes) {
+        // 用随机村庄平铺铺满大地图，最后一行/列的村庄只保留完整落在地图内的建筑
+        std::vector<BuildingInstance> buildings;
+        int tiles = (size + baseSize - 1) / baseSize;
+        for (int tx = 0; tx < tiles; ++tx) {
+            for (int ty = 0; ty < tiles; ++ty) {
+                BattleMapData tile = RandomBattleMapGenerator::generate(3);
+                for (auto building : tile.buildings) {
+                    auto config = BuildingConfig::getInstance()->getConfig(building.type);
+                    if (!config) continue;
+
+                    building.gridX += tx * baseSize;
+                    building.gridY += ty * baseSize;
+                    if (building.gridX + config->gridWidth > size || building.gridY + config->gridHeight > size) continue;
+
+                    buildings.push_back(building);
+                }
+            }
+        }
+
+        pathfinder->setMapSize(size, size);
+        pathfinder->rebuildPathfindingMap(buildings);
+
+        // 选取相距较远的可通行起终点
+        std::vector<std::pair<Vec2, Vec2>> queries;
+        std::uniform_int_distribution<int> coord(0, size - 1);
+        int attempts = 0;
+        while ((int)queries.size() < queriesPerSize && attempts++ < queriesPerSize * 1000) {
+            int sx = coord(rng), sy = coord(rng), ex = coord(rng), ey = coord(rng);
+            if (std::max(std::abs(ex - sx), std::abs(ey - sy)) < size / 2) continue;
+            if (!pathfinder->isWalkable(sx, sy) || !pathfinder->isWalkable(ex, ey)) continue;
+            queries.push_back(std::make_pair(Vec2(sx, sy), Vec2(ex, ey)));
+        }
+
+        // 第一次分层查询包含抽象图构建，单独计时
+        auto start = Clock::now();
+        if (!queries.empty()) {
+            pathfinder->findPathGrid(queries[0].first, queries[0].second, SearchMode::HIERARCHICAL);
+        }
+        CC_UNUSED double buildMs = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+
+        double flatMs = 0.0;
+        double hpaMs = 0.0;
+        double jpsMs = 0.0;
+        long long flatCost = 0;
+        long long flatExpanded = 0;
+        long long jpsExpanded = 0;
+        int jpsMismatch = 0;
+        long long hpaCost = 0;
+        int solved = 0;
+
+        for (const auto& query : queries) {
+            start = Clock::now();
+            std::vector<Vec2> flatPath = pathfinder->findPathGrid(query.first, query.second, SearchMode::ASTAR);
+            flatMs += std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+            flatExpanded += pathfinder->getSearchStats().nodesExpanded;
+
+            start = Clock::now();
+            std::vector<Vec2> hpaPath = pathfinder->findPathGrid(query.first, query.second, SearchMode::HIERARCHICAL);
+            hpaMs += std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+
+            start = Clock::now();
+            std::vector<Vec2> jpsPath = pathfinder->findPathGrid(query.first, query.second, SearchMode::JPS);
+            jpsMs += std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+            jpsExpanded += pathfinder->getSearchStats().nodesExpanded;
+
+            // JPS 必须与 A* 同样最优
+            if (flatPath.empty() != jpsPath.empty() ||
+                (!flatPath.empty() && pathCost(flatPath) != pathCost(jpsPath))) {
+                jpsMismatch++;
+            }
+
+            if (!flatPath.empty() && !hpaPath.empty()) {
+                flatCost += pathCost(flatPath);
+                hpaCost += pathCost(hpaPath);
+                solved++;
+            }
+        }
+
+        CC_UNUSED double lengthRatio = flatCost > 0 ? (double)hpaCost / flatCost : 1.0;
+
+        // 战斗中城墙陆续被摧毁：每摧毁一堵墙做一次分层查询
+        std::vector<size_t> walls;
+        for (size_t i = 0; i < buildings.size(); ++i) {
+            if (buildings[i].type == 303) walls.push_back(i);
+        }
+        std::shuffle(walls.begin(), walls.end(), rng);
+        int removals = queries.empty() ? 0 : std::min(static_cast<int>(walls.size()), queriesPerSize);
+
+        // 局部更新：摧毁只重建受影响的簇（计时含地图增量更新）
+        std::vector<BuildingInstance> battleBuildings = buildings;
+        pathfinder->rebuildPathfindingMap(battleBuildings);
+        if (!queries.empty()) {
+            // 先建好抽象图，之后只剩局部更新
+            pathfinder->findPathGrid(queries[0].first, queries[0].second, SearchMode::HIERARCHICAL);
+        }
+
+        double incrementalMs = 0.0;
+        std::vector<int> incrementalCosts;
+        for (int i = 0; i < removals; ++i) {
+            BuildingInstance& wall = battleBuildings[walls[i]];
+            wall.isDestroyed = true;
+            wall.currentHP = 0;
+            const auto& query = queries[i % queries.size()];
+
+            start = Clock::now();
+            pathfinder->markBuildingRemoved(wall);
+            std::vector<Vec2> path = pathfinder->findPathGrid(query.first, query.second, SearchMode::HIERARCHICAL);
+            incrementalMs += std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+            incrementalCosts.push_back(path.empty() ? -1 : pathCost(path));
+        }
+
+        // 整体重建：同样的摧毁顺序，每次查询前抽象图都要重建（地图重建不计时）
+        battleBuildings = buildings;
+        double rebuildMs = 0.0;
+        int rebuildMismatch = 0;
+        for (int i = 0; i < removals; ++i) {
+            BuildingInstance& wall = battleBuildings[walls[i]];
+            wall.isDestroyed = true;
+            wall.currentHP = 0;
+            const auto& query = queries[i % queries.size()];
+
+            pathfinder->rebuildPathfindingMap(battleBuildings);
+            start = Clock::now();
+            std::vector<Vec2> path = pathfinder->findPathGrid(query.first, query.second, SearchMode::HIERARCHICAL);
+            rebuildMs += std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+
+            if ((path.empty() ? -1 : pathCost(path)) != incrementalCosts[i]) rebuildMismatch++;
+        }
+
+        CCLOG("DebugHelper: [Benchmark] %dx%d map, %zu queries (%d solved)", size, size, queries.size(), solved);
+        CCLOG("  Flat A*: %.3f ms total, %.4f ms per query, %.1f nodes expanded per query",
+              flatMs, queries.empty() ? 0.0 : flatMs / queries.size(),
+              queries.empty() ? 0.0 : (double)flatExpanded / queries.size());
+        CCLOG("  JPS:     %.3f ms total, %.4f ms per query, %.1f nodes expanded per query (%d cost mismatches)",
+              jpsMs, queries.empty() ? 0.0 : jpsMs / queries.size(),
+              queries.empty() ? 0.0 : (double)jpsExpanded / queries.size(), jpsMismatch);
+        CCLOG("  HPA*:    %.3f ms total, %.4f ms per query (abstract graph build %.3f ms)",
+              hpaMs, queries.empty() ? 0.0 : hpaMs / queries.size(), buildMs);
+        CCLOG("  HPA* path length ratio: %.3f", lengthRatio);
+        CCLOG("  HPA* with %d wall removals: incremental %.3f ms, full rebuild %.3f ms (%d cost mismatches)",
+              removals, incrementalMs, rebuildMs, rebuildMismatch);
+
+        summary += StringUtils::format("%d: A* %.2fms / JPS %.2fms / HPA* %.2fms, 破墙后 增量 %.2fms / 重建 %.2fms  ",
+                                       size, flatMs, jpsMs, hpaMs, incrementalMs, rebuildMs);
+    }
+
+    // 恢复为当前数据（尺寸也一并恢复）
+    pathfinder->updatePathfindingMap();
+
+    return summary;
+}
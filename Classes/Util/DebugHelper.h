@@ -120,4 +120,37 @@ public:
      * - 避免数据丢失
      */
     static void forceSave();
+
+    // ========== 性能测试 ==========
+
+    /**
+     * @brief 寻路地图更新基准测试：全量重建 vs 增量更新
+     * @param rounds 重复轮数
+     * @return 结果摘要（同时输出到日志）
+     *
+     * 测试方式：
+     * 1. 生成一张随机战斗地图（拷贝，不影响当前数据）
+     * 2. 按顺序逐个摧毁所有非陷阱建筑（城墙占绝大多数）
+     * 3. 旧方案：每摧毁一个调用一次 rebuildPathfindingMap()
+     * 4. 新方案：每摧毁一个调用一次 markBuildingRemoved()
+     * 5. 结束后用当前村庄/战斗数据恢复寻路地图
+     */
+    static std::string benchmarkPathfindingMapUpdate(int rounds = 20);
+
+    /**
+     * @brief 网格寻路基准测试：普通 A* vs 跳点搜索 vs HPA*
+     * @param queriesPerSize 每种地图尺寸的查询次数
+     * @return 结果摘要（同时输出到日志）
+     *
+     * 测试方式：
+     * 1. 分别生成 44x44、128x128、256x256 地图，大地图由随机村庄平铺铺满（超出边界的建筑丢弃）
+     * 2. 用固定种子选取相距至少半张地图的可通行起终点
+     * 3. 同一组查询分别用 SearchMode::ASTAR、JPS 和 HIERARCHICAL 计时，
+     *    统计 A* / JPS 的展开节点数、JPS 与 A* 的代价是否一致，
+     *    以及 HPA* 路径相对最优路径的长度比
+     * 4. 模拟战斗：每摧毁一堵城墙做一次分层查询，
+     *    分别计时局部更新抽象图和整体重建抽象图，并核对两者的路径代价
+     * 5. 结束后恢复为当前数据的寻路地图
+     */
+    static std::string benchmarkHierarchicalPathfinding(int queriesPerSize = 50);
 };
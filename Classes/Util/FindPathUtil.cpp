@@ -5,7 +5,7 @@
 #include "../Manager/VillageDataManager.h"
 #include "../Model/BuildingConfig.h"
 #include "GridMapUtils.h"
-#include <queue>
+#include "PathSearchContext.h"
 #include <algorithm>
 #include <cmath>
 
@@ -24,28 +24,27 @@ void FindPathUtil::destroyInstance() {
 
 FindPathUtil::FindPathUtil()
     : _mapWidth(GridMapUtils::GRID_WIDTH)
-    , _mapHeight(GridMapUtils::GRID_HEIGHT) {
+    , _mapHeight(GridMapUtils::GRID_HEIGHT)
+    , _mapEpoch(0)
+    , _wallVersion(0)
+    , _hierarchyEpoch(0) {
     
     int mapSize = _mapWidth * _mapHeight;
     
     // 初始化寻路地图数组
     _pathfindingMap.resize(mapSize, 0);
+    _wallOwner.resize(mapSize, 0);
+    _wallHP.resize(mapSize, 0);
+    rebuildComponents();
     
-    // 预分配A*算法所需的内存，避免频繁分配
-    _gScore.resize(mapSize, INT_MAX);
-    _cameFrom.resize(mapSize, -1);
-    _closedSet.resize(mapSize, false);
-    
-    CCLOG("FindPathUtil: Initialized with optimized memory pools (map size: %dx%d = %d cells)", 
+    // A* 的临时数据放在每线程的 PathSearchContext 中，按需扩容
+    CCLOG("FindPathUtil: Initialized (map size: %dx%d = %d cells)", 
           _mapWidth, _mapHeight, mapSize);
     CCLOG("  -> Pathfinding map will be updated by VillageDataManager");
 }
 
 FindPathUtil::~FindPathUtil() {
     _pathfindingMap.clear();
-    _gScore.clear();
-    _cameFrom.clear();
-    _closedSet.clear();
 }
 
 // ===================================================================================
@@ -58,98 +57,334 @@ std::vector<Vec2> FindPathUtil::findPathToAttackBuilding(const Vec2& unitWorldPo
     int startX = static_cast<int>(std::floor(startGridPos.x));
     int startY = static_cast<int>(std::floor(startGridPos.y));
 
-    // 获取目标建筑的配置信息
+    // 目标建筑周围的攻击区域（建筑配置缺失时无法攻击）
+    AttackArea area;
+    if (!makeAttackArea(building, attackRange, area)) return {};
+
+    if (!isWalkable(startX, startY)) return {};
+
+    // 已经站在攻击位置：返回当前格中心，让单位站定后进入战斗
+    if (area.contains(startX, startY)) {
+        return { GridMapUtils::gridToPixelCenter(startX, startY) };
+    }
+
+    // 所有攻击格都不在单位所在区域（被城墙围住）：无需搜索
+    if (!isAttackAreaReachable(startX, startY, building, attackRange)) {
+        return {};
+    }
+
+    // 一次搜索同时以所有攻击格为终点
+    AttackPlanSearch search(getGridView(), area, startX, startY, 0, PathSearchContext::current());
+    if (search.step() != AttackPlanSearch::Status::FOUND) {
+        return {};
+    }
+
+    std::vector<int> cells;
+    search.getPath(cells);
+    return toSmoothedWorldPath(cells, false);
+}
+
+bool FindPathUtil::makeAttackArea(const BuildingInstance& building, int attackRange, AttackArea& outArea) const {
     auto config = BuildingConfig::getInstance()->getConfig(building.type);
-    if (!config) return {};
+    if (!config) return false;
+
+    outArea.bX = building.gridX;
+    outArea.bY = building.gridY;
+    outArea.bW = config->gridWidth;
+    outArea.bH = config->gridHeight;
+
+    // 向外扩展攻击范围后的矩形；矩形内、建筑外的格子到建筑的切比雪夫距离都在攻击范围内
+    outArea.minX = outArea.bX - attackRange;
+    outArea.minY = outArea.bY - attackRange;
+    outArea.maxX = outArea.bX + outArea.bW + attackRange - 1;
+    outArea.maxY = outArea.bY + outArea.bH + attackRange - 1;
+    return true;
+}
 
-    int bX = building.gridX;
-    int bY = building.gridY;
-    int bW = config->gridWidth;
-    int bH = config->gridHeight;
+// ===================================================================================
+// 破墙寻路
+// ===================================================================================
 
-    // 候选攻击位置结构
-    struct CandidateSpot {
-        int x, y;
-        float distSq;  // 到起点的距离平方
-    };
-    std::vector<CandidateSpot> candidates;
+bool FindPathUtil::planPathWithWallBreaking(const Vec2& unitWorldPos, const BuildingInstance& building, int attackRange, int damagePerHit, WallBreakPlan& outPlan) {
+    outPlan = WallBreakPlan();
 
-    // 搜索建筑周围符合攻击范围的所有可行位置
-    for (int x = bX - attackRange; x <= bX + bW + attackRange - 1; ++x) {
-        for (int y = bY - attackRange; y <= bY + bH + attackRange - 1; ++y) {
-            // 跳过建筑内部的格子
-            if (x >= bX && x < bX + bW && y >= bY && y < bY + bH) continue;
+    Vec2 startGridPos = GridMapUtils::pixelToGrid(unitWorldPos);
+    int startX = static_cast<int>(std::floor(startGridPos.x));
+    int startY = static_cast<int>(std::floor(startGridPos.y));
 
-            // 计算到建筑的切比雪夫距离（最大坐标差）
-            int distToBuilding = 0;
-            
-            if (x < bX) {
-                distToBuilding = std::max(distToBuilding, bX - x);
-            } else if (x >= bX + bW) {
-                distToBuilding = std::max(distToBuilding, x - (bX + bW) + 1);
-            }
-            
-            if (y < bY) {
-                distToBuilding = std::max(distToBuilding, bY - y);
-            } else if (y >= bY + bH) {
-                distToBuilding = std::max(distToBuilding, y - (bY + bH) + 1);
-            }
-            
-            // 检查距离是否符合攻击范围要求
-            if (attackRange == 0) {
-                if (distToBuilding != 0) continue;
-            } else {
-                if (distToBuilding > attackRange || distToBuilding == 0) continue;
+    AttackArea area;
+    if (!makeAttackArea(building, attackRange, area)) return false;
+    if (!isWalkable(startX, startY)) return false;
+
+    if (area.contains(startX, startY)) {
+        outPlan.path.push_back(GridMapUtils::gridToPixelCenter(startX, startY));
+        return true;
+    }
+
+    AttackPlanSearch search(getGridView(), area, startX, startY, std::max(damagePerHit, 1), PathSearchContext::current());
+    if (search.step() != AttackPlanSearch::Status::FOUND) {
+        return false;
+    }
+
+    std::vector<int> cells;
+    search.getPath(cells);
+    buildWallBreakPlan(getGridView(), cells, attackRange, outPlan);
+    outPlan.totalCost = search.getCost();
+    return true;
+}
+
+void FindPathUtil::buildWallBreakPlan(const PathGridView& grid, const std::vector<int>& cells, int attackRange, WallBreakPlan& outPlan) {
+    outPlan.path.clear();
+    outPlan.wallBuildingId = 0;
+    outPlan.wallGridX = -1;
+    outPlan.wallGridY = -1;
+
+    int width = grid.width;
+
+    // 已经站在攻击位置：返回当前格中心，让单位站定后进入战斗
+    if (cells.size() == 1) {
+        outPlan.path.push_back(GridMapUtils::gridToPixelCenter(cells[0] % width, cells[0] / width));
+        return;
+    }
+
+    // 路线上的第一格城墙
+    size_t wallStep = 0;
+    for (size_t k = 1; k < cells.size(); ++k) {
+        if (grid.cells[cells[k]] == PathGridView::CELL_WALL) {
+            wallStep = k;
+            break;
+        }
+    }
+
+    size_t pathEnd = cells.size();
+    if (wallStep > 0) {
+        outPlan.wallBuildingId = grid.wallOwner[cells[wallStep]];
+        outPlan.wallGridX = cells[wallStep] % width;
+        outPlan.wallGridY = cells[wallStep] / width;
+
+        // 走到第一个能打到这格城墙的位置即可（远程单位不必贴墙）
+        int range = std::max(attackRange, 1);
+        pathEnd = wallStep;
+        for (size_t k = 0; k < wallStep; ++k) {
+            int x = cells[k] % width;
+            int y = cells[k] / width;
+            if (std::max(std::abs(x - outPlan.wallGridX), std::abs(y - outPlan.wallGridY)) <= range) {
+                pathEnd = k + 1;
+                break;
             }
+        }
+    }
 
-            // 检查该位置是否可通行
-            if (isWalkable(x, y)) {
-                float dx = static_cast<float>(x - startX);
-                float dy = static_cast<float>(y - startY);
-                float distSq = dx * dx + dy * dy;
-                candidates.push_back({ x, y, distSq });
+    // 拉直后转换为世界坐标路径（跳过起点）；截断后的路线不含城墙格
+    std::vector<int> walkCells(cells.begin(), cells.begin() + pathEnd);
+    std::vector<int> corners;
+    PathSmoothing::stringPull(grid, walkCells, false, corners);
+    for (size_t k = 1; k < corners.size(); ++k) {
+        outPlan.path.push_back(GridMapUtils::gridToPixelCenter(corners[k] % width, corners[k] / width));
+    }
+}
+
+void FindPathUtil::markBuildingDamaged(const BuildingInstance& building) {
+    if (building.type != 303) return;
+    if (building.isDestroyed || building.currentHP <= 0) return;
+
+    auto config = BuildingConfig::getInstance()->getConfig(building.type);
+    if (!config) return;
+
+    for (int x = building.gridX; x < building.gridX + config->gridWidth; ++x) {
+        for (int y = building.gridY; y < building.gridY + config->gridHeight; ++y) {
+            if (x < 0 || x >= _mapWidth || y < 0 || y >= _mapHeight) continue;
+
+            int index = toIndex(x, y);
+            if (_wallOwner[index] == building.id && _wallHP[index] != building.currentHP) {
+                _wallHP[index] = building.currentHP;
+                ++_wallVersion;
             }
         }
     }
+}
 
-    if (candidates.empty()) {
-        return {};
+// ===================================================================================
+// 网格快照
+// ===================================================================================
+
+PathGridView FindPathUtil::getGridView() const {
+    PathGridView grid = { _pathfindingMap.data(), _wallOwner.data(), _wallHP.data(), _mapWidth, _mapHeight };
+    return grid;
+}
+
+std::shared_ptr<const FindPathUtil::GridSnapshot> FindPathUtil::getGridSnapshot() {
+    if (_snapshot && _snapshot->epoch == _mapEpoch && _snapshot->wallVersion == _wallVersion) {
+        return _snapshot;
     }
 
-    // 按距离排序，优先尝试最近的位置
-    std::sort(candidates.begin(), candidates.end(), [](const CandidateSpot& a, const CandidateSpot& b) {
-        return a.distSq < b.distSq;
-    });
+    // 旧快照可能仍被工作线程持有，总是新建一份而不是原地修改
+    std::shared_ptr<GridSnapshot> snapshot = std::make_shared<GridSnapshot>();
+    snapshot->width = _mapWidth;
+    snapshot->height = _mapHeight;
+    snapshot->epoch = _mapEpoch;
+    snapshot->wallVersion = _wallVersion;
+    snapshot->cells = _pathfindingMap;
+    snapshot->wallOwner = _wallOwner;
+    snapshot->wallHP = _wallHP;
+
+    _snapshot = snapshot;
+    return _snapshot;
+}
 
-    // 尝试前5个最近的候选位置
-    int attempts = std::min((int)candidates.size(), 5);
+// ===================================================================================
+// 共享流场寻路
+// ===================================================================================
 
-    for (int i = 0; i < attempts; ++i) {
-        int targetX = candidates[i].x;
-        int targetY = candidates[i].y;
+std::vector<Vec2> FindPathUtil::findPathByFlowField(const Vec2& unitWorldPos, const BuildingInstance& building, int attackRange, bool ignoreWalls) {
+    Vec2 startGridPos = GridMapUtils::pixelToGrid(unitWorldPos);
+    int startX = static_cast<int>(std::floor(startGridPos.x));
+    int startY = static_cast<int>(std::floor(startGridPos.y));
 
-        // 使用A*算法查找路径
-        std::vector<Vec2> gridPath = findPathGrid(Vec2(startX, startY), Vec2(targetX, targetY));
+    if (!isPassable(startX, startY, ignoreWalls)) return {};
 
-        if (!gridPath.empty()) {
-            // 转换为世界坐标路径（跳过起点）
-            std::vector<Vec2> worldPath;
-            worldPath.reserve(gridPath.size());
+    const FlowField* field = getFlowField(building, attackRange, ignoreWalls);
+    if (!field) return {};
 
-            for (size_t k = 1; k < gridPath.size(); ++k) {
-                worldPath.push_back(GridMapUtils::gridToPixelCenter((int)gridPath[k].x, (int)gridPath[k].y));
-            }
+    int index = toIndex(startX, startY);
+    if (field->distance[index] == INT_MAX) {
+        return {};  // 目标从当前位置不可达
+    }
 
-            // 如果路径为空但有目标点，至少返回目标点
-            if (worldPath.empty() && gridPath.size() >= 1) {
-                worldPath.push_back(GridMapUtils::gridToPixelCenter(targetX, targetY));
-            }
+    std::vector<Vec2> worldPath;
 
-            return worldPath;
+    // 已经站在攻击格上：返回当前格中心，让单位站定后进入战斗
+    if (field->distance[index] == 0) {
+        worldPath.push_back(GridMapUtils::gridToPixelCenter(startX, startY));
+        return worldPath;
+    }
+
+    // 沿流场下一步一直走到攻击格（距离严格递减，必然终止）
+    std::vector<int> cells(1, index);
+    while (field->nextStep[index] != -1) {
+        index = field->nextStep[index];
+        cells.push_back(index);
+    }
+
+    return toSmoothedWorldPath(cells, ignoreWalls);
+}
+
+bool FindPathUtil::getFlowFieldNextStep(int gridX, int gridY, const BuildingInstance& building, int attackRange, bool ignoreWalls, int& nextX, int& nextY) {
+    if (!isPassable(gridX, gridY, ignoreWalls)) return false;
+
+    const FlowField* field = getFlowField(building, attackRange, ignoreWalls);
+    if (!field) return false;
+
+    int next = field->nextStep[toIndex(gridX, gridY)];
+    if (next == -1) return false;
+
+    fromIndex(next, nextX, nextY);
+    return true;
+}
+
+void FindPathUtil::clearFlowFieldCache() {
+    _flowFieldCache.clear();
+}
+
+uint64_t FindPathUtil::makeFlowFieldKey(int buildingId, int attackRange, bool ignoreWalls) {
+    // 高32位：建筑ID；低位：攻击范围和城墙模式
+    return (static_cast<uint64_t>(static_cast<uint32_t>(buildingId)) << 32)
+        | (static_cast<uint64_t>(static_cast<uint16_t>(attackRange)) << 1)
+        | (ignoreWalls ? 1u : 0u);
+}
+
+const FindPathUtil::FlowField* FindPathUtil::getFlowField(const BuildingInstance& building, int attackRange, bool ignoreWalls) {
+    uint64_t key = makeFlowFieldKey(building.id, attackRange, ignoreWalls);
+
+    auto it = _flowFieldCache.find(key);
+    if (it != _flowFieldCache.end()) {
+        // 地图在构建后发生过变化（建筑被摧毁），原地重建
+        if (it->second.epoch != _mapEpoch) {
+            buildFlowField(it->second, building, attackRange, ignoreWalls);
+        }
+        return &it->second;
+    }
+
+    if (!BuildingConfig::getInstance()->getConfig(building.type)) return nullptr;
+
+    if (_flowFieldCache.size() >= MAX_CACHED_FLOW_FIELDS) {
+        _flowFieldCache.clear();
+    }
+
+    FlowField& field = _flowFieldCache[key];
+    buildFlowField(field, building, attackRange, ignoreWalls);
+    return &field;
+}
+
+void FindPathUtil::collectAttackCells(const BuildingInstance& building, int attackRange, bool ignoreWalls, std::vector<int>& outCells) const {
+    AttackArea area;
+    if (!makeAttackArea(building, attackRange, area)) return;
+
+    // 与 findPathToAttackBuilding 的目标规则保持一致：建筑外、切比雪夫距离在攻击范围内
+    for (int x = area.minX; x <= area.maxX; ++x) {
+        for (int y = area.minY; y <= area.maxY; ++y) {
+            if (area.isInsideBuilding(x, y)) continue;
+            if (!isPassable(x, y, ignoreWalls)) continue;
+            outCells.push_back(toIndex(x, y));
+        }
+    }
+}
+
+void FindPathUtil::buildFlowField(FlowField& field, const BuildingInstance& building, int attackRange, bool ignoreWalls) const {
+    int mapSize = _mapWidth * _mapHeight;
+    field.distance.assign(mapSize, INT_MAX);
+    field.nextStep.assign(mapSize, -1);
+    field.epoch = _mapEpoch;
+
+    std::vector<int> sources;
+    collectAttackCells(building, attackRange, ignoreWalls, sources);
+    if (sources.empty()) return;
+
+    // 与 A* 共用每线程的搜索上下文（f 即代价，不需要启发式）
+    PathSearchContext& ctx = PathSearchContext::current();
+    ctx.beginQuery(mapSize);
+
+    for (int source : sources) {
+        field.distance[source] = 0;
+        ctx.touch(source).g = 0;
+        ctx.pushOrDecrease(source, 0);
+    }
+
+    const int dirs[8][2] = {
+        {0, 1}, {0, -1}, {-1, 0}, {1, 0},
+        {-1, -1}, {1, -1}, {-1, 1}, {1, 1}
+    };
+
+    // 8方向移动代价对称，反向扩展得到的就是每格走向最近攻击格的最短代价
+    while (!ctx.isOpenEmpty()) {
+        int currIndex = ctx.popMin();
+        int currentDist = field.distance[currIndex];
+
+        int cx, cy;
+        fromIndex(currIndex, cx, cy);
+
+        for (int i = 0; i < 8; ++i) {
+            int nx = cx + dirs[i][0];
+            int ny = cy + dirs[i][1];
+            if (!isPassable(nx, ny, ignoreWalls)) continue;
+
+            int neighborIndex = toIndex(nx, ny);
+            PathSearchContext::Node& neighbor = ctx.touch(neighborIndex);
+            if (neighbor.closed) continue;
+
+            int moveCost = (dirs[i][0] != 0 && dirs[i][1] != 0) ? 14 : 10;
+            int newDist = currentDist + moveCost;
+
+            if (newDist < field.distance[neighborIndex]) {
+                field.distance[neighborIndex] = newDist;
+                field.nextStep[neighborIndex] = currIndex;
+                neighbor.g = newDist;
+                ctx.pushOrDecrease(neighborIndex, newDist);
+            }
         }
     }
 
-    return {};
+    ctx.endQuery();
 }
 
 // ===================================================================================
@@ -157,11 +392,51 @@ std::vector<Vec2> FindPathUtil::findPathToAttackBuilding(const Vec2& unitWorldPo
 // ===================================================================================
 
 void FindPathUtil::updatePathfindingMap() {
+    auto dataManager = VillageDataManager::getInstance();
+
+    // 战斗地图尺寸由地图数据决定，村庄固定为默认网格
+    int width = GridMapUtils::GRID_WIDTH;
+    int height = GridMapUtils::GRID_HEIGHT;
+    if (dataManager->isInBattleMode()) {
+        width = dataManager->getBattleGridWidth();
+        height = dataManager->getBattleGridHeight();
+    }
+    if (width != _mapWidth || height != _mapHeight) {
+        setMapSize(width, height);
+    }
+
+    rebuildPathfindingMap(dataManager->getAllBuildings());
+}
+
+void FindPathUtil::setMapSize(int width, int height) {
+    if (width <= 0 || height <= 0) return;
+
+    _mapWidth = width;
+    _mapHeight = height;
+
+    int mapSize = _mapWidth * _mapHeight;
+    _pathfindingMap.assign(mapSize, 0);
+    _wallOwner.assign(mapSize, 0);
+    _wallHP.assign(mapSize, 0);
+
+    // 尺寸变化后所有缓存都作废
+    clearFlowFieldCache();
+    _hierarchy.clear();
+    rebuildComponents();
+    ++_mapEpoch;
+
+    CCLOG("FindPathUtil: Map resized to %dx%d", _mapWidth, _mapHeight);
+}
+
+void FindPathUtil::rebuildPathfindingMap(const std::vector<BuildingInstance>& buildings) {
+    // 整张地图重建，旧地图的流场全部丢弃
+    clearFlowFieldCache();
+    ++_mapEpoch;
+
     // 清空地图数据
     std::fill(_pathfindingMap.begin(), _pathfindingMap.end(), 0);
-
-    auto dataManager = VillageDataManager::getInstance();
-    const auto& buildings = dataManager->getAllBuildings();
+    std::fill(_wallOwner.begin(), _wallOwner.end(), 0);
+    std::fill(_wallHP.begin(), _wallHP.end(), 0);
 
     for (const auto& b : buildings) {
         // 跳过正在放置的建筑
@@ -188,11 +463,204 @@ void FindPathUtil::updatePathfindingMap() {
         for (int x = b.gridX; x < b.gridX + config->gridWidth; ++x) {
             for (int y = b.gridY; y < b.gridY + config->gridHeight; ++y) {
                 if (x >= 0 && x < _mapWidth && y >= 0 && y < _mapHeight) {
-                    _pathfindingMap[toIndex(x, y)] = static_cast<uint8_t>(gridType);
+                    int index = toIndex(x, y);
+                    _pathfindingMap[index] = static_cast<uint8_t>(gridType);
+                    if (gridType == GridType::WALL) {
+                        _wallOwner[index] = b.id;
+                        _wallHP[index] = b.currentHP;
+                    }
                 }
             }
         }
     }
+
+    rebuildComponents();
+}
+
+void FindPathUtil::markBuildingRemoved(const BuildingInstance& building) {
+    markBuildingsRemoved(std::vector<const BuildingInstance*>(1, &building));
+}
+
+void FindPathUtil::markBuildingsRemoved(const std::vector<const BuildingInstance*>& buildings) {
+    std::vector<int> opened;
+    for (const BuildingInstance* building : buildings) {
+        clearBuildingCells(*building, opened);
+    }
+
+    // 打开的格子并入相邻区域（所有格子都清空后再处理，占地内部以及同批建筑之间也能互相连上）
+    for (int index : opened) {
+        openComponentCell(index);
+    }
+
+    // 网格有变化才递增版本号，流场在下次查询时按需重建
+    if (!opened.empty()) {
+        // 抽象图与地图同步时记下打开的格子，下次分层查询只更新这些格子所在的簇
+        bool hierarchyInSync = _hierarchy.isBuilt() && _hierarchyEpoch == _mapEpoch;
+        ++_mapEpoch;
+        if (hierarchyInSync) {
+            _hierarchyPendingCells.insert(_hierarchyPendingCells.end(), opened.begin(), opened.end());
+            _hierarchyEpoch = _mapEpoch;
+        }
+    }
+}
+
+void FindPathUtil::clearBuildingCells(const BuildingInstance& building, std::vector<int>& opened) {
+    // 陷阱和放置中的建筑本来就不在寻路地图里
+    if (building.type >= 400 && building.type < 500) return;
+    if (building.state == BuildingInstance::State::PLACING) return;
+
+    auto config = BuildingConfig::getInstance()->getConfig(building.type);
+    if (!config) return;
+
+    // 只清除该建筑的占地格子（建筑之间不重叠）
+    for (int x = building.gridX; x < building.gridX + config->gridWidth; ++x) {
+        for (int y = building.gridY; y < building.gridY + config->gridHeight; ++y) {
+            if (x < 0 || x >= _mapWidth || y < 0 || y >= _mapHeight) continue;
+
+            int index = toIndex(x, y);
+            _wallOwner[index] = 0;
+            _wallHP[index] = 0;
+
+            uint8_t& cell = _pathfindingMap[index];
+            if (cell != static_cast<uint8_t>(GridType::EMPTY)) {
+                cell = static_cast<uint8_t>(GridType::EMPTY);
+                opened.push_back(index);
+            }
+        }
+    }
+}
+
+// ===================================================================================
+// 连通区域
+// ===================================================================================
+
+void FindPathUtil::rebuildComponents() {
+    int mapSize = _mapWidth * _mapHeight;
+    _cellComponent.assign(mapSize, -1);
+    _componentParent.clear();
+
+    std::vector<int> stack;
+    for (int seed = 0; seed < mapSize; ++seed) {
+        if (_cellComponent[seed] != -1) continue;
+        if (_pathfindingMap[seed] != static_cast<uint8_t>(GridType::EMPTY)) continue;
+
+        // 新区域：8方向洪泛（寻路允许斜穿障碍角，斜向相邻即连通）
+        int component = static_cast<int>(_componentParent.size());
+        _componentParent.push_back(component);
+        _cellComponent[seed] = component;
+        stack.push_back(seed);
+
+        while (!stack.empty()) {
+            int index = stack.back();
+            stack.pop_back();
+
+            int cx, cy;
+            fromIndex(index, cx, cy);
+            for (int dy = -1; dy <= 1; ++dy) {
+                for (int dx = -1; dx <= 1; ++dx) {
+                    if (!isWalkable(cx + dx, cy + dy)) continue;
+                    int neighborIndex = toIndex(cx + dx, cy + dy);
+                    if (_cellComponent[neighborIndex] != -1) continue;
+                    _cellComponent[neighborIndex] = component;
+                    stack.push_back(neighborIndex);
+                }
+            }
+        }
+    }
+}
+
+void FindPathUtil::openComponentCell(int index) {
+    int cx, cy;
+    fromIndex(index, cx, cy);
+
+    int component = -1;
+    for (int dy = -1; dy <= 1; ++dy) {
+        for (int dx = -1; dx <= 1; ++dx) {
+            if (dx == 0 && dy == 0) continue;
+            if (!isWalkable(cx + dx, cy + dy)) continue;
+
+            int neighborComponent = _cellComponent[toIndex(cx + dx, cy + dy)];
+            if (neighborComponent == -1) continue;  // 同一建筑中尚未处理的格子
+
+            int root = findComponentRoot(neighborComponent);
+            if (component == -1) {
+                component = root;
+            } else if (root != component) {
+                _componentParent[root] = component;
+            }
+        }
+    }
+
+    // 四周都不可通行：自成一个新区域
+    if (component == -1) {
+        component = static_cast<int>(_componentParent.size());
+        _componentParent.push_back(component);
+    }
+    _cellComponent[index] = component;
+}
+
+int FindPathUtil::findComponentRoot(int component) const {
+    while (_componentParent[component] != component) {
+        _componentParent[component] = _componentParent[_componentParent[component]];
+        component = _componentParent[component];
+    }
+    return component;
+}
+
+int FindPathUtil::getComponentId(int gridX, int gridY) const {
+    if (!isWalkable(gridX, gridY)) return -1;
+    return findComponentRoot(_cellComponent[toIndex(gridX, gridY)]);
+}
+
+bool FindPathUtil::isReachable(int startX, int startY, int endX, int endY) const {
+    int startComponent = getComponentId(startX, startY);
+    return startComponent != -1 && startComponent == getComponentId(endX, endY);
+}
+
+bool FindPathUtil::isAttackAreaReachable(int startX, int startY, const BuildingInstance& building, int attackRange) const {
+    int startComponent = getComponentId(startX, startY);
+    if (startComponent == -1) return false;
+
+    AttackArea area;
+    if (!makeAttackArea(building, attackRange, area)) return false;
+
+    for (int y = area.minY; y <= area.maxY; ++y) {
+        for (int x = area.minX; x <= area.maxX; ++x) {
+            if (area.isInsideBuilding(x, y)) continue;
+            if (getComponentId(x, y) == startComponent) return true;
+        }
+    }
+    return false;
+}
+
+std::vector<Vec2> FindPathUtil::getSeparatingWalls(int componentA, int componentB) const {
+    std::vector<Vec2> walls;
+    if (componentA < 0 || componentB < 0 || componentA == componentB) return walls;
+
+    componentA = findComponentRoot(componentA);
+    componentB = findComponentRoot(componentB);
+    if (componentA == componentB) return walls;
+
+    for (int y = 0; y < _mapHeight; ++y) {
+        for (int x = 0; x < _mapWidth; ++x) {
+            if (_pathfindingMap[toIndex(x, y)] != static_cast<uint8_t>(GridType::WALL)) continue;
+
+            bool touchesA = false;
+            bool touchesB = false;
+            for (int dy = -1; dy <= 1 && !(touchesA && touchesB); ++dy) {
+                for (int dx = -1; dx <= 1; ++dx) {
+                    int component = getComponentId(x + dx, y + dy);
+                    if (component == componentA) touchesA = true;
+                    else if (component == componentB) touchesB = true;
+                }
+            }
+
+            if (touchesA && touchesB) {
+                walls.push_back(Vec2(x, y));
+            }
+        }
+    }
+    return walls;
 }
 
 bool FindPathUtil::isWalkable(int gridX, int gridY) const {
@@ -200,6 +668,14 @@ bool FindPathUtil::isWalkable(int gridX, int gridY) const {
     return _pathfindingMap[toIndex(gridX, gridY)] == static_cast<uint8_t>(GridType::EMPTY);
 }
 
+bool FindPathUtil::isPassable(int gridX, int gridY, bool ignoreWalls) const {
+    if (gridX < 0 || gridX >= _mapWidth || gridY < 0 || gridY >= _mapHeight) return false;
+
+    uint8_t cellType = _pathfindingMap[toIndex(gridX, gridY)];
+    if (cellType == static_cast<uint8_t>(GridType::EMPTY)) return true;
+    return ignoreWalls && cellType == static_cast<uint8_t>(GridType::WALL);
+}
+
 // ===================================================================================
 // 忽略城墙的寻路（炸弹人专用）
 // ===================================================================================
@@ -221,24 +697,8 @@ std::vector<Vec2> FindPathUtil::findPathIgnoringWalls(const Vec2& startWorldPos,
         return {};
     }
     
-    // 移除起点
-    if (gridPath.size() > 1) {
-        gridPath.erase(gridPath.begin());
-    }
-    
-    // 转换为世界坐标
-    std::vector<Vec2> worldPath;
-    worldPath.reserve(gridPath.size());
-    
-    for (const auto& gridPos : gridPath) {
-        Vec2 worldPos = GridMapUtils::gridToPixelCenter(
-            static_cast<int>(gridPos.x), 
-            static_cast<int>(gridPos.y)
-        );
-        worldPath.push_back(worldPos);
-    }
-    
-    return worldPath;
+    // 拉直并转换为世界坐标（移除起点）
+    return toSmoothedWorldPath(gridPathToCells(gridPath), true);
 }
 
 // ===================================================================================
@@ -246,16 +706,6 @@ std::vector<Vec2> FindPathUtil::findPathIgnoringWalls(const Vec2& startWorldPos,
 // ===================================================================================
 
 std::vector<Vec2> FindPathUtil::aStarSearch(int startX, int startY, int endX, int endY, bool ignoreWalls) {
-    // A*节点结构
-    struct AStarNode {
-        int x, y;
-        int fCost;  // 总代价：g + h
-
-        bool operator>(const AStarNode& other) const {
-            return fCost > other.fCost;
-        }
-    };
-    
     // 根据ignoreWalls参数定义通行性判断逻辑
     auto isWalkableInternal = [&](int gridX, int gridY) -> bool {
         if (gridX < 0 || gridX >= _mapWidth || gridY < 0 || gridY >= _mapHeight) return false;
@@ -278,17 +728,14 @@ std::vector<Vec2> FindPathUtil::aStarSearch(int startX, int startY, int endX, in
     if (!isWalkableInternal(endX, endY)) return {};
     if (startX == endX && startY == endY) return {};
 
-    // 复用预分配的内存，只重置数据
-    std::fill(_gScore.begin(), _gScore.end(), INT_MAX);
-    std::fill(_cameFrom.begin(), _cameFrom.end(), -1);
-    std::fill(_closedSet.begin(), _closedSet.end(), false);
-
-    // 优先队列（最小堆）
-    std::priority_queue<AStarNode, std::vector<AStarNode>, std::greater<AStarNode>> openSet;
+    // 每线程的搜索上下文：代数递增代替清空数组，开放列表支持降键
+    PathSearchContext& ctx = PathSearchContext::current();
+    ctx.beginQuery(_mapWidth * _mapHeight);
 
     int startIndex = toIndex(startX, startY);
-    _gScore[startIndex] = 0;
-    openSet.push({ startX, startY, heuristic(startX, startY, endX, endY) });
+    int endIndex = toIndex(endX, endY);
+    ctx.touch(startIndex).g = 0;
+    ctx.pushOrDecrease(startIndex, heuristic(startX, startY, endX, endY));
 
     // 8方向移动
     const int dirs[8][2] = {
@@ -296,55 +743,133 @@ std::vector<Vec2> FindPathUtil::aStarSearch(int startX, int startY, int endX, in
         {-1, -1}, {1, -1}, {-1, 1}, {1, 1}     // 对角线
     };
 
-    while (!openSet.empty()) {
-        AStarNode current = openSet.top();
-        openSet.pop();
+    std::vector<Vec2> path;
 
-        int currIndex = toIndex(current.x, current.y);
+    while (!ctx.isOpenEmpty()) {
+        int currIndex = ctx.popMin();
 
         // 到达终点，重建路径
-        if (current.x == endX && current.y == endY) {
-            std::vector<Vec2> path;
+        if (currIndex == endIndex) {
             int traceIndex = currIndex;
             
             while (traceIndex != -1) {
                 int tx, ty;
                 fromIndex(traceIndex, tx, ty);
                 path.push_back(Vec2(tx, ty));
-                traceIndex = _cameFrom[traceIndex];
+                traceIndex = ctx.touch(traceIndex).parent;
             }
             
             std::reverse(path.begin(), path.end());
-            return path;
+            break;
         }
 
-        // 跳过已访问的节点
-        if (_closedSet[currIndex]) continue;
-        _closedSet[currIndex] = true;
+        int cx, cy;
+        fromIndex(currIndex, cx, cy);
+        int currentG = ctx.touch(currIndex).g;
 
         // 遍历8个邻居
         for (int i = 0; i < 8; ++i) {
-            int nx = current.x + dirs[i][0];
-            int ny = current.y + dirs[i][1];
+            int nx = cx + dirs[i][0];
+            int ny = cy + dirs[i][1];
 
             if (!isWalkableInternal(nx, ny)) continue;
 
+            int neighborIndex = toIndex(nx, ny);
+            PathSearchContext::Node& neighbor = ctx.touch(neighborIndex);
+            if (neighbor.closed) continue;
+
             // 对角线移动代价14，直线移动代价10（近似√2*10≈14）
             int moveCost = (dirs[i][0] != 0 && dirs[i][1] != 0) ? 14 : 10;
-            int tentativeG = _gScore[currIndex] + moveCost;
-            int neighborIndex = toIndex(nx, ny);
+            int tentativeG = currentG + moveCost;
 
-            // 如果找到更优路径，更新节点
-            if (tentativeG < _gScore[neighborIndex]) {
-                _cameFrom[neighborIndex] = currIndex;
-                _gScore[neighborIndex] = tentativeG;
-                int f = tentativeG + heuristic(nx, ny, endX, endY);
-                openSet.push({ nx, ny, f });
+            // 如果找到更优路径，更新节点（已在堆中则降键）
+            if (tentativeG < neighbor.g) {
+                neighbor.parent = currIndex;
+                neighbor.g = tentativeG;
+                ctx.pushOrDecrease(neighborIndex, tentativeG + heuristic(nx, ny, endX, endY));
             }
         }
     }
 
-    return {};  // 无路径
+    ctx.endQuery();
+    return path;  // 为空表示无路径
+}
+
+// ===================================================================================
+// 分层寻路（HPA*）
+// ===================================================================================
+
+void FindPathUtil::ensureHierarchy() {
+    if (_hierarchy.isBuilt() && _hierarchyEpoch == _mapEpoch) {
+        if (!_hierarchyPendingCells.empty()) {
+            _hierarchy.updateCells(_hierarchyPendingCells);
+            _hierarchyPendingCells.clear();
+        }
+        return;
+    }
+
+    // 地图被全量重建过，抽象图也整体重建
+    _hierarchy.build(&_pathfindingMap, _mapWidth, _mapHeight);
+    _hierarchyEpoch = _mapEpoch;
+    _hierarchyPendingCells.clear();
+}
+
+std::vector<Vec2> FindPathUtil::hierarchicalSearch(int startX, int startY, int endX, int endY) {
+    ensureHierarchy();
+
+    std::vector<int> cells;
+    if (!_hierarchy.findPath(startX, startY, endX, endY, cells)) {
+        // 抽象图只保证近似，查不到时用精确搜索兜底确认
+        return jumpPointSearch(startX, startY, endX, endY);
+    }
+
+    std::vector<Vec2> path;
+    path.reserve(cells.size());
+    for (int cell : cells) {
+        int x, y;
+        fromIndex(cell, x, y);
+        path.push_back(Vec2(x, y));
+    }
+    return path;
+}
+
+// ===================================================================================
+// 跳点搜索（JPS）
+// ===================================================================================
+
+std::vector<Vec2> FindPathUtil::jumpPointSearch(int startX, int startY, int endX, int endY) {
+    std::vector<int> cells;
+    if (!JumpPointSearch::findPath(_pathfindingMap, _mapWidth, _mapHeight, startX, startY, endX, endY, cells)) {
+        return {};
+    }
+
+    std::vector<Vec2> path;
+    path.reserve(cells.size());
+    for (int cell : cells) {
+        int x, y;
+        fromIndex(cell, x, y);
+        path.push_back(Vec2(x, y));
+    }
+    return path;
+}
+
+std::vector<Vec2> FindPathUtil::searchGrid(int startX, int startY, int endX, int endY, SearchMode mode) {
+    // 起终点不在同一连通区域：不可达，不必洪泛整个区域
+    if (!isReachable(startX, startY, endX, endY)) return {};
+
+    if (mode == SearchMode::AUTO) {
+        int distance = std::max(std::abs(endX - startX), std::abs(endY - startY));
+        mode = (distance >= HIERARCHICAL_MIN_DISTANCE) ? SearchMode::HIERARCHICAL : SearchMode::JPS;
+    }
+
+    switch (mode) {
+    case SearchMode::HIERARCHICAL:
+        return hierarchicalSearch(startX, startY, endX, endY);
+    case SearchMode::JPS:
+        return jumpPointSearch(startX, startY, endX, endY);
+    default:
+        return aStarSearch(startX, startY, endX, endY);
+    }
 }
 
 // ===================================================================================
@@ -359,8 +884,38 @@ int FindPathUtil::heuristic(int x1, int y1, int x2, int y2) const {
     return 10 * (dx + dy) - 6 * std::min(dx, dy);
 }
 
-std::vector<Vec2> FindPathUtil::findPathGrid(const Vec2& startGrid, const Vec2& endGrid) {
-    return aStarSearch((int)startGrid.x, (int)startGrid.y, (int)endGrid.x, (int)endGrid.y);
+std::vector<int> FindPathUtil::gridPathToCells(const std::vector<Vec2>& gridPath) const {
+    std::vector<int> cells;
+    cells.reserve(gridPath.size());
+    for (const auto& gridPos : gridPath) {
+        cells.push_back(toIndex(static_cast<int>(gridPos.x), static_cast<int>(gridPos.y)));
+    }
+    return cells;
+}
+
+std::vector<Vec2> FindPathUtil::toSmoothedWorldPath(const std::vector<int>& cells, bool allowWalls) const {
+    // 只有起点：返回当前格中心，与"已在目标位置"的约定一致
+    if (cells.size() == 1) {
+        int x, y;
+        fromIndex(cells[0], x, y);
+        return { GridMapUtils::gridToPixelCenter(x, y) };
+    }
+
+    std::vector<int> corners;
+    PathSmoothing::stringPull(getGridView(), cells, allowWalls, corners);
+
+    std::vector<Vec2> worldPath;
+    worldPath.reserve(corners.size());
+    for (size_t k = 1; k < corners.size(); ++k) {
+        int x, y;
+        fromIndex(corners[k], x, y);
+        worldPath.push_back(GridMapUtils::gridToPixelCenter(x, y));
+    }
+    return worldPath;
+}
+
+std::vector<Vec2> FindPathUtil::findPathGrid(const Vec2& startGrid, const Vec2& endGrid, SearchMode mode) {
+    return searchGrid((int)startGrid.x, (int)startGrid.y, (int)endGrid.x, (int)endGrid.y, mode);
 }
 
 std::vector<Vec2> FindPathUtil::findPath(const Vec2& startGridPos, const Vec2& endGridPos) {
@@ -369,7 +924,7 @@ std::vector<Vec2> FindPathUtil::findPath(const Vec2& startGridPos, const Vec2& e
     int endX = static_cast<int>(endGridPos.x);
     int endY = static_cast<int>(endGridPos.y);
     
-    return aStarSearch(startX, startY, endX, endY);
+    return searchGrid(startX, startY, endX, endY, SearchMode::AUTO);
 }
 
 std::vector<Vec2> FindPathUtil::findPathInWorld(const Vec2& startWorldPos, const Vec2& endWorldPos) {
@@ -383,28 +938,12 @@ std::vector<Vec2> FindPathUtil::findPathInWorld(const Vec2& startWorldPos, const
     int endY = static_cast<int>(std::floor(endGridPos.y));
     
     // 寻路
-    std::vector<Vec2> gridPath = aStarSearch(startX, startY, endX, endY);
+    std::vector<Vec2> gridPath = searchGrid(startX, startY, endX, endY, SearchMode::AUTO);
     
     if (gridPath.empty()) {
         return {};
     }
     
-    // 移除起点
-    if (gridPath.size() > 1) {
-        gridPath.erase(gridPath.begin());
-    }
-    
-    // 转换为世界坐标
-    std::vector<Vec2> worldPath;
-    worldPath.reserve(gridPath.size());
-    
-    for (const auto& gridPos : gridPath) {
-        Vec2 worldPos = GridMapUtils::gridToPixelCenter(
-            static_cast<int>(gridPos.x), 
-            static_cast<int>(gridPos.y)
-        );
-        worldPath.push_back(worldPos);
-    }
-    
-    return worldPath;
+    // 拉直并转换为世界坐标（移除起点）
+    return toSmoothedWorldPath(gridPathToCells(gridPath), false);
 }
@@ -3,8 +3,15 @@
 
 #include "cocos2d.h"
 #include "../Model/VillageData.h"
+#include "HierarchicalPathGraph.h"
+#include "PathSearchContext.h"
+#include "JumpPointSearch.h"
+#include "AttackPlanSearch.h"
+#include "PathSmoothing.h"
 #include <vector>
 #include <unordered_map>
+#include <memory>
+#include <functional>
 
 class FindPathUtil {
 public:
@@ -16,6 +23,17 @@ public:
         DECORATION = 3
     };
 
+    // 寻路算法选择（按查询指定）
+    enum class SearchMode : uint8_t {
+        AUTO = 0,           // 自动：长距离查询走分层寻路，其余走跳点搜索
+        ASTAR = 1,          // 普通网格 A*（最优路径）
+        HIERARCHICAL = 2,   // 分层寻路 HPA*（近似最优，只访问少量抽象节点）
+        JPS = 3             // 跳点搜索（与 A* 同为最优路径，空旷地形展开节点少得多）
+    };
+
+    // 切比雪夫距离达到该格数时 AUTO 模式改用分层寻路（44x44 地图上不会触发）
+    static const int HIERARCHICAL_MIN_DISTANCE = 48;
+
     static FindPathUtil* getInstance();
     static void destroyInstance();
 
@@ -23,26 +41,136 @@ public:
     // 🔥 核心接口：智能寻找攻击路径 🔥
     // 输入：单位当前世界坐标，目标建筑实例，攻击范围（1=近战，2=弓箭手）
     // 输出：一系列世界坐标点（路径），如果无法到达返回空
+    // 所有有效攻击格同时作为终点做一次搜索，返回代价最小的攻击位置；
+    // 已在攻击位置时返回当前格中心
+    // 世界坐标路径都经过拉直（PathSmoothing），只含拐点和终点
     // =============================================================
     std::vector<cocos2d::Vec2> findPathToAttackBuilding(const cocos2d::Vec2& unitWorldPos, const BuildingInstance& targetBuilding, int attackRange = 1);
 
+    // =============================================================
+    // 破墙寻路：城墙按"打穿所需时间"折算为通行代价，一次搜索同时比较绕路和破墙
+    // 代价 = 移动代价 + 打穿城墙所需攻击次数 * AttackPlanSearch::WALL_COST_PER_HIT
+    // =============================================================
+    struct WallBreakPlan {
+        std::vector<cocos2d::Vec2> path;    // 世界坐标路径（不含起点）：无需破墙时通往攻击位置，否则通往第一堵墙的攻击位置
+        int wallBuildingId;                 // 路线上第一堵要打的城墙ID，0 表示绕路即可
+        int wallGridX;                      // 第一堵城墙的网格坐标
+        int wallGridY;
+        int totalCost;                      // 整条路线的代价（含破墙）
+
+        WallBreakPlan() : wallBuildingId(0), wallGridX(-1), wallGridY(-1), totalCost(0) {}
+    };
+
+    // 异步/分帧规划完成回调；found 为 false 表示目标不可达
+    typedef std::function<void(bool found, const WallBreakPlan& plan)> AttackPlanCallback;
+
+    // 规划到达目标攻击位置的最优路线（允许破墙）
+    // damagePerHit 为单位每次攻击的伤害；无法到达（地图外或被非城墙建筑封死）返回false
+    bool planPathWithWallBreaking(const cocos2d::Vec2& unitWorldPos, const BuildingInstance& targetBuilding, int attackRange, int damagePerHit, WallBreakPlan& outPlan);
+
+    // 把搜索得到的格子路线整理为破墙计划：找出第一堵墙，并截到第一个能打到它的位置
+    // 只读取 grid，可在任意线程调用
+    static void buildWallBreakPlan(const PathGridView& grid, const std::vector<int>& cells, int attackRange, WallBreakPlan& outPlan);
+
+    // 城墙受到伤害后同步剩余血量（影响破墙代价）
+    void markBuildingDamaged(const BuildingInstance& building);
+
+    // 计算建筑的攻击区域，建筑配置缺失时返回false
+    bool makeAttackArea(const BuildingInstance& building, int attackRange, AttackArea& outArea) const;
+
+    // =============================================================
+    // 网格快照：供工作线程在主线程继续修改地图时安全地只读搜索
+    // =============================================================
+    struct GridSnapshot {
+        int width;
+        int height;
+        uint32_t epoch;                 // 对应的地图版本号
+        uint32_t wallVersion;           // 对应的城墙血量版本号
+        std::vector<uint8_t> cells;
+        std::vector<int> wallOwner;
+        std::vector<int> wallHP;
+
+        PathGridView view() const {
+            PathGridView grid = { cells.data(), wallOwner.data(), wallHP.data(), width, height };
+            return grid;
+        }
+    };
+
+    // 当前地图的不可变快照（地图与城墙血量都未变化时复用同一份）
+    std::shared_ptr<const GridSnapshot> getGridSnapshot();
+
+    // 当前实时地图的只读视图（仅限主线程使用）
+    PathGridView getGridView() const;
+
+    // =============================================================
+    // 共享流场寻路：同一目标的所有单位共用一张距离场
+    // 按 (建筑ID, 攻击范围, 城墙模式) 缓存，以全部有效攻击格为源做一次多源 Dijkstra，
+    // 之后任意单位读取下一步都是 O(1)。地图更新时缓存自动失效。
+    // 输出格式与 findPathToAttackBuilding 相同（不含起点的世界坐标路径）
+    // =============================================================
+    std::vector<cocos2d::Vec2> findPathByFlowField(const cocos2d::Vec2& unitWorldPos, const BuildingInstance& targetBuilding, int attackRange = 1, bool ignoreWalls = false);
+
+    // 读取流场中某格的下一步（网格坐标）
+    // 返回false表示该格已在攻击位置或无法到达目标
+    bool getFlowFieldNextStep(int gridX, int gridY, const BuildingInstance& targetBuilding, int attackRange, bool ignoreWalls, int& nextX, int& nextY);
+
+    // 清空流场缓存
+    void clearFlowFieldCache();
+
     // 计算"破墙路径"的长度（把城墙当作可通行）
     std::vector<cocos2d::Vec2> findPathIgnoringWalls(const cocos2d::Vec2& startWorldPos, const cocos2d::Vec2& endWorldPos);
 
     // 重新同步地图数据（当建筑位置改变时调用）
     void updatePathfindingMap();
 
+    // 按给定建筑列表全量重建寻路地图
+    void rebuildPathfindingMap(const std::vector<BuildingInstance>& buildings);
+
+    // 增量更新：建筑被摧毁后只清除它占用的格子，代价与建筑占地成正比
+    void markBuildingRemoved(const BuildingInstance& building);
+
+    // 批量增量更新：一次爆炸摧毁的多个建筑一起清除，区域合并和版本号递增只做一次
+    void markBuildingsRemoved(const std::vector<const BuildingInstance*>& buildings);
+
+    // 当前线程最近一次/累计的寻路统计（展开节点数、耗时）
+    const PathSearchStats& getSearchStats() const { return PathSearchContext::current().getStats(); }
+
+    // 地图版本号：网格每次变化都会递增，路径/流场缓存据此判断是否过期
+    uint32_t getMapEpoch() const { return _mapEpoch; }
+
+    // 地图尺寸（运行时属性，战斗地图可大于 44x44）
+    void setMapSize(int width, int height);
+    int getMapWidth() const { return _mapWidth; }
+    int getMapHeight() const { return _mapHeight; }
+
     // 辅助：判断某格是否可走
     bool isWalkable(int gridX, int gridY) const;
 
+    // =============================================================
+    // 连通区域：可通行格按8方向连通性划分区域，地图变化时同步更新
+    // 起终点不在同一区域的查询 O(1) 返回不可达
+    // =============================================================
+
+    // 某格所在区域ID，不可通行返回 -1（ID 只在地图下次变化前有效）
+    int getComponentId(int gridX, int gridY) const;
+
+    // 两格是否连通
+    bool isReachable(int startX, int startY, int endX, int endY) const;
+
+    // 建筑是否有可到达的攻击位置
+    bool isAttackAreaReachable(int startX, int startY, const BuildingInstance& targetBuilding, int attackRange) const;
+
+    // 同时与两个区域相邻的城墙格（网格坐标），拆掉其中任意一格即可连通两区域
+    std::vector<cocos2d::Vec2> getSeparatingWalls(int componentA, int componentB) const;
+
     //  基础寻路接口（网格坐标）
     std::vector<cocos2d::Vec2> findPath(const cocos2d::Vec2& startGridPos, const cocos2d::Vec2& endGridPos);
     
-    //  基础寻路接口（世界坐标）
+    //  基础寻路接口（世界坐标，拉直后只含拐点和终点）
     std::vector<cocos2d::Vec2> findPathInWorld(const cocos2d::Vec2& startWorldPos, const cocos2d::Vec2& endWorldPos);
     
-    // 辅助：获取两点间的基础 A* 路径 (网格坐标 -> 网格坐标)
-    std::vector<cocos2d::Vec2> findPathGrid(const cocos2d::Vec2& startGrid, const cocos2d::Vec2& endGrid);
+    // 辅助：获取两点间的基础路径 (网格坐标 -> 网格坐标，含起点)
+    std::vector<cocos2d::Vec2> findPathGrid(const cocos2d::Vec2& startGrid, const cocos2d::Vec2& endGrid, SearchMode mode = SearchMode::AUTO);
 
 private:
     FindPathUtil();
@@ -53,15 +181,86 @@ private:
     int _mapWidth;
     int _mapHeight;
     std::vector<uint8_t> _pathfindingMap; // 扁平化的一维数组存储地图数据
+    uint32_t _mapEpoch;                   // 地图版本号
+
+    // 流场：每格到最近攻击位置的代价以及下一步
+    struct FlowField {
+        std::vector<int> distance;      // 到最近攻击格的代价，INT_MAX 表示不可达
+        std::vector<int> nextStep;      // 下一步的格子索引，-1 表示已在攻击格或不可达
+        uint32_t epoch;                 // 构建时的地图版本号，与当前不一致即过期
+    };
+
+    // 流场缓存上限，超过后整体清空（目标建筑数量有限，正常不会触发）
+    static const size_t MAX_CACHED_FLOW_FIELDS = 64;
+
+    std::unordered_map<uint64_t, FlowField> _flowFieldCache;
+
+    // 流场缓存键：建筑ID + 攻击范围 + 城墙模式
+    static uint64_t makeFlowFieldKey(int buildingId, int attackRange, bool ignoreWalls);
+
+    // 获取（必要时构建）目标建筑的流场，建筑配置缺失时返回nullptr
+    const FlowField* getFlowField(const BuildingInstance& building, int attackRange, bool ignoreWalls);
+
+    // 多源 Dijkstra 构建流场
+    void buildFlowField(FlowField& field, const BuildingInstance& building, int attackRange, bool ignoreWalls) const;
+
+    // 每格城墙所属建筑ID及剩余血量（非城墙格为0），用于破墙代价
+    std::vector<int> _wallOwner;
+    std::vector<int> _wallHP;
+    uint32_t _wallVersion;              // 城墙血量每次变化递增
+
+    // 最近一次生成的快照
+    std::shared_ptr<const GridSnapshot> _snapshot;
+
+    // 收集建筑周围所有有效攻击格（格子索引）
+    void collectAttackCells(const BuildingInstance& building, int attackRange, bool ignoreWalls, std::vector<int>& outCells) const;
+
+    // 连通区域标记：每格的区域编号（-1 = 不可通行）+ 区域并查集
+    // 建筑被摧毁只会打开格子，因此增量更新只需要合并区域
+    std::vector<int> _cellComponent;
+    mutable std::vector<int> _componentParent;
+
+    // 全量重新标记连通区域
+    void rebuildComponents();
+
+    // 格子变为可通行后，加入相邻区域（必要时合并）
+    void openComponentCell(int index);
+
+    // 清除建筑占用的格子，新打开的格子追加到 opened
+    void clearBuildingCells(const BuildingInstance& building, std::vector<int>& opened);
+
+    // 并查集查根（路径减半）
+    int findComponentRoot(int component) const;
+
+    // 根据城墙模式判断格子是否可通行
+    bool isPassable(int gridX, int gridY, bool ignoreWalls) const;
+
+    // 分层寻路抽象图：全量重建地图后惰性重建，建筑被摧毁时只局部更新
+    HierarchicalPathGraph _hierarchy;
+    uint32_t _hierarchyEpoch;
+    std::vector<int> _hierarchyPendingCells;    // 已打开、尚未同步到抽象图的格子
+
+    // 确保抽象图与当前地图一致
+    void ensureHierarchy();
+
+    // 按模式分发的网格寻路（不含忽略城墙模式）
+    std::vector<cocos2d::Vec2> searchGrid(int startX, int startY, int endX, int endY, SearchMode mode);
+
+    // 分层寻路实现，失败时回退到跳点搜索
+    std::vector<cocos2d::Vec2> hierarchicalSearch(int startX, int startY, int endX, int endY);
+
+    // 跳点搜索实现
+    std::vector<cocos2d::Vec2> jumpPointSearch(int startX, int startY, int endX, int endY);
 
-    //  性能优化：复用的 A* 数据结构（避免频繁分配）
-    std::vector<int> _gScore;           // G值缓存
-    std::vector<int> _cameFrom;         // 路径回溯表
-    std::vector<bool> _closedSet;       // 已访问集合
-    
     // 内部 A* 算法实现
     std::vector<cocos2d::Vec2> aStarSearch(int startX, int startY, int endX, int endY, bool ignoreWalls = false);
 
+    // 网格坐标路径转换为格子索引序列
+    std::vector<int> gridPathToCells(const std::vector<cocos2d::Vec2>& gridPath) const;
+
+    // 拉直格子路径（含起点）并转换为世界坐标路径（不含起点）
+    std::vector<cocos2d::Vec2> toSmoothedWorldPath(const std::vector<int>& cells, bool allowWalls) const;
+
     // 启发式函数
     int heuristic(int x1, int y1, int x2, int y2) const;
 
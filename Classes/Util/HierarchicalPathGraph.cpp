@@ -0,0 +1,502 @@
+﻿// HierarchicalPathGraph.cpp
+// 分层寻路（HPA*）实现，负责抽象图构建、簇内细化和抽象层 A* 搜索
+
+#include "HierarchicalPathGraph.h"
+#include <queue>
+#include <unordered_map>
+#include <algorithm>
+#include <climits>
+#include <cstdlib>
+
+namespace {
+    // 与 FindPathUtil 保持一致的8方向及代价
+    const int kDirs[8][2] = {
+        {0, 1}, {0, -1}, {-1, 0}, {1, 0},
+        {-1, -1}, {1, -1}, {-1, 1}, {1, 1}
+    };
+
+    // 入口长度达到该值时放置两个过渡点（两端），否则只在中点放一个
+    const int kLongEntranceLength = 6;
+
+    int octileDistance(int x1, int y1, int x2, int y2) {
+        int dx = std::abs(x1 - x2);
+        int dy = std::abs(y1 - y2);
+        return 10 * (dx + dy) - 6 * std::min(dx, dy);
+    }
+
+    typedef std::pair<int, int> QueueEntry;   // (代价, 索引)
+    typedef std::priority_queue<QueueEntry, std::vector<QueueEntry>, std::greater<QueueEntry>> MinQueue;
+}
+
+HierarchicalPathGraph::HierarchicalPathGraph(int clusterSize)
+    : _clusterSize(clusterSize > 1 ? clusterSize : DEFAULT_CLUSTER_SIZE)
+    , _width(0)
+    , _height(0)
+    , _clustersX(0)
+    , _clustersY(0)
+    , _cells(nullptr) {
+}
+
+void HierarchicalPathGraph::clear() {
+    _cells = nullptr;
+    _nodes.clear();
+    _clusterNodes.clear();
+    _cellToNode.clear();
+    _freeNodes.clear();
+}
+
+// ===================================================================================
+// 抽象图构建
+// ===================================================================================
+
+void HierarchicalPathGraph::build(const std::vector<uint8_t>* cells, int width, int height) {
+    clear();
+    if (!cells || width <= 0 || height <= 0) return;
+    if (static_cast<int>(cells->size()) < width * height) return;
+
+    _cells = cells;
+    _width = width;
+    _height = height;
+    _clustersX = (width + _clusterSize - 1) / _clusterSize;
+    _clustersY = (height + _clusterSize - 1) / _clusterSize;
+
+    _cellToNode.assign(width * height, -1);
+    _clusterNodes.assign(_clustersX * _clustersY, std::vector<int>());
+
+    // 1. 簇间入口：竖直边界（左右相邻的簇）
+    for (int cy = 0; cy < _clustersY; ++cy) {
+        for (int cx = 0; cx + 1 < _clustersX; ++cx) {
+            scanBorder(cy * _clustersX + cx, true);
+        }
+    }
+
+    // 2. 簇间入口：水平边界（上下相邻的簇）
+    for (int cx = 0; cx < _clustersX; ++cx) {
+        for (int cy = 0; cy + 1 < _clustersY; ++cy) {
+            scanBorder(cy * _clustersX + cx, false);
+        }
+    }
+
+    // 3. 簇内边：同一簇内的节点两两连通代价
+    for (int cluster = 0; cluster < static_cast<int>(_clusterNodes.size()); ++cluster) {
+        buildClusterEdges(cluster);
+    }
+}
+
+void HierarchicalPathGraph::updateCells(const std::vector<int>& changedCells) {
+    if (!isBuilt() || changedCells.empty()) return;
+
+    // 边界以左侧/下方的簇编码：cluster * 2 + (0 = 竖直边界, 1 = 水平边界)
+    std::vector<int> borders;
+    std::vector<int> clusters;
+
+    for (int cell : changedCells) {
+        int x = cell % _width;
+        int y = cell / _width;
+        int cx = x / _clusterSize;
+        int cy = y / _clusterSize;
+        int cluster = cy * _clustersX + cx;
+        clusters.push_back(cluster);
+
+        // 只有落在簇边缘一行/一列上的格子才会改变入口
+        int localX = x - cx * _clusterSize;
+        int localY = y - cy * _clusterSize;
+        if (localX == _clusterSize - 1 && cx + 1 < _clustersX) borders.push_back(cluster * 2);
+        if (localX == 0 && cx > 0) borders.push_back((cluster - 1) * 2);
+        if (localY == _clusterSize - 1 && cy + 1 < _clustersY) borders.push_back(cluster * 2 + 1);
+        if (localY == 0 && cy > 0) borders.push_back((cluster - _clustersX) * 2 + 1);
+    }
+
+    std::sort(borders.begin(), borders.end());
+    borders.erase(std::unique(borders.begin(), borders.end()), borders.end());
+
+    // 1. 拆掉受影响边界上的旧过渡边，边界两侧的簇都要重算簇内边
+    for (int key : borders) {
+        int clusterA = key / 2;
+        int clusterB = (key % 2 == 0) ? clusterA + 1 : clusterA + _clustersX;
+        removeTransitions(clusterA, clusterB);
+        removeTransitions(clusterB, clusterA);
+        clusters.push_back(clusterA);
+        clusters.push_back(clusterB);
+    }
+
+    // 2. 按新网格重新扫描这些边界
+    for (int key : borders) {
+        scanBorder(key / 2, key % 2 == 0);
+    }
+
+    // 3. 重算簇内边
+    std::sort(clusters.begin(), clusters.end());
+    clusters.erase(std::unique(clusters.begin(), clusters.end()), clusters.end());
+    for (int cluster : clusters) {
+        rebuildClusterEdges(cluster);
+    }
+}
+
+void HierarchicalPathGraph::scanBorder(int cluster, bool vertical) {
+    int cx = cluster % _clustersX;
+    int cy = cluster / _clustersX;
+
+    if (vertical) {
+        int y0 = cy * _clusterSize;
+        int length = std::min(_clusterSize, _height - y0);
+        int x = (cx + 1) * _clusterSize - 1;
+        scanEntrance(x, y0, x + 1, y0, 0, 1, length);
+    } else {
+        int x0 = cx * _clusterSize;
+        int length = std::min(_clusterSize, _width - x0);
+        int y = (cy + 1) * _clusterSize - 1;
+        scanEntrance(x0, y, x0, y + 1, 1, 0, length);
+    }
+}
+
+void HierarchicalPathGraph::removeTransitions(int fromCluster, int toCluster) {
+    for (int id : _clusterNodes[fromCluster]) {
+        std::vector<Edge>& edges = _nodes[id].edges;
+        edges.erase(std::remove_if(edges.begin(), edges.end(), [&](const Edge& e) {
+            return _nodes[e.to].cluster == toCluster;
+        }), edges.end());
+    }
+}
+
+void HierarchicalPathGraph::buildClusterEdges(int cluster) {
+    const std::vector<int>& members = _clusterNodes[cluster];
+    if (members.size() < 2) return;
+
+    for (int from : members) {
+        clusterDijkstra(cluster, _nodes[from].cell, -1);
+        for (int to : members) {
+            if (to == from) continue;
+            int cost = localDistanceTo(cluster, _nodes[to].cell);
+            if (cost != INT_MAX) {
+                _nodes[from].edges.push_back({ to, cost });
+            }
+        }
+    }
+}
+
+void HierarchicalPathGraph::rebuildClusterEdges(int cluster) {
+    std::vector<int>& members = _clusterNodes[cluster];
+
+    // 回收的节点保留 cluster 字段，同簇其他节点指向它的簇内边仍能被识别并删除
+    size_t kept = 0;
+    for (int id : members) {
+        Node& node = _nodes[id];
+        node.edges.erase(std::remove_if(node.edges.begin(), node.edges.end(), [&](const Edge& e) {
+            return _nodes[e.to].cluster == cluster;
+        }), node.edges.end());
+
+        // 只剩簇内边的节点已不在任何入口上
+        if (node.edges.empty()) {
+            _cellToNode[node.cell] = -1;
+            node.cell = -1;
+            _freeNodes.push_back(id);
+            continue;
+        }
+        members[kept++] = id;
+    }
+    members.resize(kept);
+
+    buildClusterEdges(cluster);
+}
+
+void HierarchicalPathGraph::scanEntrance(int ax, int ay, int bx, int by, int stepX, int stepY, int length) {
+    auto cellA = [&](int i) { return (ay + i * stepY) * _width + ax + i * stepX; };
+    auto cellB = [&](int i) { return (by + i * stepY) * _width + bx + i * stepX; };
+
+    std::vector<char> open(length, 0);
+    for (int i = 0; i < length; ++i) {
+        open[i] = isWalkable(ax + i * stepX, ay + i * stepY) && isWalkable(bx + i * stepX, by + i * stepY);
+    }
+
+    // 直线入口：连续的可通行格对
+    int runStart = -1;
+    for (int i = 0; i <= length; ++i) {
+        if (i < length && open[i]) {
+            if (runStart < 0) runStart = i;
+            continue;
+        }
+        if (runStart < 0) continue;
+
+        int runEnd = i - 1;
+        if (runEnd - runStart + 1 >= kLongEntranceLength) {
+            addTransition(cellA(runStart), cellB(runStart), 10);
+            addTransition(cellA(runEnd), cellB(runEnd), 10);
+        } else {
+            int mid = (runStart + runEnd) / 2;
+            addTransition(cellA(mid), cellB(mid), 10);
+        }
+        runStart = -1;
+    }
+
+    // 斜向入口：只能斜穿边界的位置（两侧都不属于直线入口时才需要，否则已经连通）
+    for (int i = 0; i + 1 < length; ++i) {
+        if (open[i] || open[i + 1]) continue;
+
+        if (isWalkable(ax + i * stepX, ay + i * stepY) && isWalkable(bx + (i + 1) * stepX, by + (i + 1) * stepY)) {
+            addTransition(cellA(i), cellB(i + 1), 14);
+        }
+        if (isWalkable(ax + (i + 1) * stepX, ay + (i + 1) * stepY) && isWalkable(bx + i * stepX, by + i * stepY)) {
+            addTransition(cellA(i + 1), cellB(i), 14);
+        }
+    }
+}
+
+void HierarchicalPathGraph::addTransition(int cellA, int cellB, int cost) {
+    int a = getOrCreateNode(cellA);
+    int b = getOrCreateNode(cellB);
+    _nodes[a].edges.push_back({ b, cost });
+    _nodes[b].edges.push_back({ a, cost });
+}
+
+int HierarchicalPathGraph::getOrCreateNode(int cell) {
+    if (_cellToNode[cell] != -1) return _cellToNode[cell];
+
+    Node node;
+    node.cell = cell;
+    node.cluster = clusterOf(cell % _width, cell / _width);
+
+    int id;
+    if (_freeNodes.empty()) {
+        id = static_cast<int>(_nodes.size());
+        _nodes.push_back(node);
+    } else {
+        id = _freeNodes.back();
+        _freeNodes.pop_back();
+        _nodes[id] = node;
+    }
+    _clusterNodes[node.cluster].push_back(id);
+    _cellToNode[cell] = id;
+    return id;
+}
+
+// ===================================================================================
+// 簇内搜索
+// ===================================================================================
+
+void HierarchicalPathGraph::clusterDijkstra(int cluster, int startCell, int stopCell) {
+    int x0, y0, x1, y1;
+    getClusterRect(cluster, x0, y0, x1, y1);
+    int clusterWidth = x1 - x0;
+    int localSize = clusterWidth * (y1 - y0);
+
+    _localDist.assign(localSize, INT_MAX);
+    _localParent.assign(localSize, -1);
+
+    int startLocal = (startCell / _width - y0) * clusterWidth + (startCell % _width - x0);
+    int stopLocal = -1;
+    if (stopCell >= 0) {
+        stopLocal = (stopCell / _width - y0) * clusterWidth + (stopCell % _width - x0);
+    }
+
+    MinQueue openSet;
+    _localDist[startLocal] = 0;
+    openSet.push(QueueEntry(0, startLocal));
+
+    while (!openSet.empty()) {
+        QueueEntry current = openSet.top();
+        openSet.pop();
+
+        int local = current.second;
+        if (current.first > _localDist[local]) continue;
+        if (local == stopLocal) return;
+
+        int cx = x0 + local % clusterWidth;
+        int cy = y0 + local / clusterWidth;
+
+        for (int i = 0; i < 8; ++i) {
+            int nx = cx + kDirs[i][0];
+            int ny = cy + kDirs[i][1];
+            if (nx < x0 || nx >= x1 || ny < y0 || ny >= y1) continue;
+            if (!isWalkable(nx, ny)) continue;
+
+            int moveCost = (kDirs[i][0] != 0 && kDirs[i][1] != 0) ? 14 : 10;
+            int newDist = current.first + moveCost;
+            int neighborLocal = (ny - y0) * clusterWidth + (nx - x0);
+
+            if (newDist < _localDist[neighborLocal]) {
+                _localDist[neighborLocal] = newDist;
+                _localParent[neighborLocal] = local;
+                openSet.push(QueueEntry(newDist, neighborLocal));
+            }
+        }
+    }
+}
+
+int HierarchicalPathGraph::localDistanceTo(int cluster, int cell) const {
+    int x0, y0, x1, y1;
+    getClusterRect(cluster, x0, y0, x1, y1);
+    int local = (cell / _width - y0) * (x1 - x0) + (cell % _width - x0);
+    return _localDist[local];
+}
+
+bool HierarchicalPathGraph::refineSegment(int cluster, int fromCell, int toCell, std::vector<int>& outPath) {
+    if (fromCell == toCell) return true;
+
+    clusterDijkstra(cluster, fromCell, toCell);
+
+    int x0, y0, x1, y1;
+    getClusterRect(cluster, x0, y0, x1, y1);
+    int clusterWidth = x1 - x0;
+
+    int local = (toCell / _width - y0) * clusterWidth + (toCell % _width - x0);
+    if (_localDist[local] == INT_MAX) return false;
+
+    // 回溯到起点（不含起点）
+    std::vector<int> segment;
+    while (_localParent[local] != -1) {
+        segment.push_back((y0 + local / clusterWidth) * _width + (x0 + local % clusterWidth));
+        local = _localParent[local];
+    }
+
+    outPath.insert(outPath.end(), segment.rbegin(), segment.rend());
+    return true;
+}
+
+// ===================================================================================
+// 分层查询
+// ===================================================================================
+
+bool HierarchicalPathGraph::findPath(int startX, int startY, int endX, int endY, std::vector<int>& outPath, int* outExpanded) {
+    outPath.clear();
+    if (outExpanded) *outExpanded = 0;
+
+    if (!isBuilt()) return false;
+    if (!isWalkable(startX, startY) || !isWalkable(endX, endY)) return false;
+    if (startX == endX && startY == endY) return false;
+
+    int startCell = startY * _width + startX;
+    int endCell = endY * _width + endX;
+    int startCluster = clusterOf(startX, startY);
+    int endCluster = clusterOf(endX, endY);
+
+    // 起点/终点作为两个虚拟节点接入抽象图
+    const int startNode = static_cast<int>(_nodes.size());
+    const int goalNode = startNode + 1;
+
+    std::vector<Edge> startEdges;
+    clusterDijkstra(startCluster, startCell, -1);
+    for (int id : _clusterNodes[startCluster]) {
+        int cost = localDistanceTo(startCluster, _nodes[id].cell);
+        if (cost != INT_MAX) startEdges.push_back({ id, cost });
+    }
+    if (startCluster == endCluster) {
+        int direct = localDistanceTo(startCluster, endCell);
+        if (direct != INT_MAX) startEdges.push_back({ goalNode, direct });
+    }
+
+    // 终点簇内各节点到终点的代价（代价对称，从终点出发计算）
+    std::unordered_map<int, int> goalEdges;
+    clusterDijkstra(endCluster, endCell, -1);
+    for (int id : _clusterNodes[endCluster]) {
+        int cost = localDistanceTo(endCluster, _nodes[id].cell);
+        if (cost != INT_MAX) goalEdges[id] = cost;
+    }
+
+    auto cellOfNode = [&](int id) -> int {
+        if (id == startNode) return startCell;
+        if (id == goalNode) return endCell;
+        return _nodes[id].cell;
+    };
+    auto heuristicOf = [&](int id) -> int {
+        int cell = cellOfNode(id);
+        return octileDistance(cell % _width, cell / _width, endX, endY);
+    };
+
+    // 抽象层 A*（只记录访问过的节点）
+    std::unordered_map<int, int> gScore;
+    std::unordered_map<int, int> cameFrom;
+    MinQueue openSet;
+
+    gScore[startNode] = 0;
+    openSet.push(QueueEntry(heuristicOf(startNode), startNode));
+
+    int expanded = 0;
+    bool found = false;
+
+    while (!openSet.empty()) {
+        QueueEntry current = openSet.top();
+        openSet.pop();
+
+        int id = current.second;
+        int g = gScore[id];
+        if (current.first > g + heuristicOf(id)) continue;  // 过期条目
+
+        if (id == goalNode) {
+            found = true;
+            break;
+        }
+        expanded++;
+
+        auto relax = [&](int to, int cost) {
+            int tentative = g + cost;
+            auto it = gScore.find(to);
+            if (it == gScore.end() || tentative < it->second) {
+                gScore[to] = tentative;
+                cameFrom[to] = id;
+                openSet.push(QueueEntry(tentative + heuristicOf(to), to));
+            }
+        };
+
+        if (id == startNode) {
+            for (const Edge& e : startEdges) relax(e.to, e.cost);
+            continue;
+        }
+
+        for (const Edge& e : _nodes[id].edges) relax(e.to, e.cost);
+
+        auto goalIt = goalEdges.find(id);
+        if (goalIt != goalEdges.end()) relax(goalNode, goalIt->second);
+    }
+
+    if (outExpanded) *outExpanded = expanded;
+    if (!found) return false;
+
+    // 回溯抽象路径
+    std::vector<int> abstractPath;
+    for (int id = goalNode; ; id = cameFrom[id]) {
+        abstractPath.push_back(cellOfNode(id));
+        if (id == startNode) break;
+    }
+    std::reverse(abstractPath.begin(), abstractPath.end());
+
+    // 细化：同簇的相邻抽象点走簇内路径，跨簇的相邻抽象点本身就是相邻格子
+    outPath.push_back(startCell);
+    for (size_t i = 0; i + 1 < abstractPath.size(); ++i) {
+        int fromCell = abstractPath[i];
+        int toCell = abstractPath[i + 1];
+        int fromCluster = clusterOf(fromCell % _width, fromCell / _width);
+        int toCluster = clusterOf(toCell % _width, toCell / _width);
+
+        if (fromCluster == toCluster) {
+            if (!refineSegment(fromCluster, fromCell, toCell, outPath)) {
+                outPath.clear();
+                return false;
+            }
+        } else {
+            outPath.push_back(toCell);
+        }
+    }
+
+    return true;
+}
+
+// ===================================================================================
+// 辅助函数
+// ===================================================================================
+
+bool HierarchicalPathGraph::isWalkable(int x, int y) const {
+    if (x < 0 || x >= _width || y < 0 || y >= _height) return false;
+    return (*_cells)[y * _width + x] == 0;
+}
+
+int HierarchicalPathGraph::clusterOf(int x, int y) const {
+    return (y / _clusterSize) * _clustersX + (x / _clusterSize);
+}
+
+void HierarchicalPathGraph::getClusterRect(int cluster, int& x0, int& y0, int& x1, int& y1) const {
+    x0 = (cluster % _clustersX) * _clusterSize;
+    y0 = (cluster / _clustersX) * _clusterSize;
+    x1 = std::min(x0 + _clusterSize, _width);
+    y1 = std::min(y0 + _clusterSize, _height);
+}
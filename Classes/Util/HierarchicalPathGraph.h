@@ -0,0 +1,114 @@
+﻿// HierarchicalPathGraph.h
+// 分层寻路（HPA*）抽象图声明，将网格划分为簇并在簇边界的入口之间建立抽象边
+
+#ifndef __HIERARCHICAL_PATH_GRAPH_H__
+#define __HIERARCHICAL_PATH_GRAPH_H__
+
+#include <vector>
+#include <cstdint>
+
+/**
+ * @brief 分层寻路抽象图（HPA*）
+ *
+ * 原理：
+ * 1. 把网格按 clusterSize x clusterSize 划分为若干簇
+ * 2. 相邻簇的公共边界上，两侧都可通行的连续格子构成一个入口，
+ *    入口较短时取中点、较长时取两端作为过渡点，过渡点两侧各建一个抽象节点
+ * 3. 同一簇内的抽象节点之间做簇内 Dijkstra，得到簇内边及代价
+ * 4. 查询时把起点/终点临时接入所在簇，在抽象图上做 A*，
+ *    再把每条抽象边细化成簇内的网格路径
+ *
+ * 长距离查询只会访问几百个抽象节点，而不是整张大地图。
+ * 路径为近似最优（过渡点位置固定），查不到时调用方应回退到普通 A*。
+ *
+ * 网格约定与 FindPathUtil 一致：格子值为 0 表示可通行，8方向移动，直线10/对角14。
+ * 本类不依赖引擎，只持有网格数据的指针。网格大范围变化后重新 build()；
+ * 少量格子变化（建筑被摧毁）时用 updateCells()，只重扫这些格子所在的簇、
+ * 它们所在的簇边界入口，以及边界两侧簇的簇内边。
+ */
+class HierarchicalPathGraph {
+public:
+    static const int DEFAULT_CLUSTER_SIZE = 10;
+
+    explicit HierarchicalPathGraph(int clusterSize = DEFAULT_CLUSTER_SIZE);
+
+    // 根据网格构建抽象图（cells 需在查询期间保持有效）
+    void build(const std::vector<uint8_t>* cells, int width, int height);
+
+    // 清空抽象图
+    void clear();
+
+    // 网格中这些格子的值已变化（格子索引），局部更新抽象图
+    void updateCells(const std::vector<int>& changedCells);
+
+    bool isBuilt() const { return _cells != nullptr; }
+    int getNodeCount() const { return static_cast<int>(_nodes.size() - _freeNodes.size()); }
+    int getClusterSize() const { return _clusterSize; }
+
+    /**
+     * @brief 分层寻路
+     * @param outPath 输出格子索引序列（含起点和终点）
+     * @param outExpanded 可选，输出抽象层展开的节点数
+     * @return 是否找到路径
+     */
+    bool findPath(int startX, int startY, int endX, int endY, std::vector<int>& outPath, int* outExpanded = nullptr);
+
+private:
+    struct Edge {
+        int to;
+        int cost;
+    };
+
+    struct Node {
+        int cell;                   // 所在格子索引，-1 表示已回收
+        int cluster;                // 所在簇
+        std::vector<Edge> edges;    // 出边（簇间边 + 簇内边）
+    };
+
+    int _clusterSize;
+    int _width;
+    int _height;
+    int _clustersX;
+    int _clustersY;
+    const std::vector<uint8_t>* _cells;
+
+    std::vector<Node> _nodes;
+    std::vector<std::vector<int>> _clusterNodes;   // 每个簇包含的抽象节点
+    std::vector<int> _cellToNode;                  // 格子 -> 抽象节点，-1 表示不是节点
+    std::vector<int> _freeNodes;                   // 已回收、可复用的节点ID
+
+    // 簇内 Dijkstra 的复用缓冲区（以簇内局部坐标索引）
+    std::vector<int> _localDist;
+    std::vector<int> _localParent;
+
+    bool isWalkable(int x, int y) const;
+    int clusterOf(int x, int y) const;
+    void getClusterRect(int cluster, int& x0, int& y0, int& x1, int& y1) const;
+
+    int getOrCreateNode(int cell);
+    void addTransition(int cellA, int cellB, int cost);
+    void scanEntrance(int ax, int ay, int bx, int by, int stepX, int stepY, int length);
+
+    // 扫描簇与右侧（vertical）或上方相邻簇之间的边界入口
+    void scanBorder(int cluster, bool vertical);
+
+    // 删除 fromCluster 中节点指向 toCluster 的过渡边
+    void removeTransitions(int fromCluster, int toCluster);
+
+    // 计算簇内节点两两之间的簇内边
+    void buildClusterEdges(int cluster);
+
+    // 删除簇内边并回收不再是过渡点的节点，然后重新计算簇内边
+    void rebuildClusterEdges(int cluster);
+
+    // 在簇内从 startCell 做 Dijkstra，stopCell 非 -1 时到达即停止
+    void clusterDijkstra(int cluster, int startCell, int stopCell);
+
+    // 读取最近一次 clusterDijkstra 的结果
+    int localDistanceTo(int cluster, int cell) const;
+
+    // 把簇内一条抽象边细化为网格路径（追加到 outPath，不含起点）
+    bool refineSegment(int cluster, int fromCell, int toCell, std::vector<int>& outPath);
+};
+
+#endif // __HIERARCHICAL_PATH_GRAPH_H__
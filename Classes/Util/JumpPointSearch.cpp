@@ -0,0 +1,205 @@
+﻿// JumpPointSearch.cpp
+// 跳点搜索实现：跳跃扫描、邻居剪枝以及跳点路径展开为逐格路径
+
+#include "JumpPointSearch.h"
+#include "PathSearchContext.h"
+#include <algorithm>
+#include <cstdlib>
+
+namespace {
+
+// 八方向距离启发式，与 FindPathUtil::heuristic 相同
+inline int octile(int x1, int y1, int x2, int y2) {
+    int dx = std::abs(x1 - x2);
+    int dy = std::abs(y1 - y2);
+    return 10 * (dx + dy) - 6 * std::min(dx, dy);
+}
+
+inline int sign(int v) {
+    return (v > 0) - (v < 0);
+}
+
+} // namespace
+
+JumpPointSearch::JumpPointSearch(const std::vector<uint8_t>& cells, int width, int height, int endX, int endY)
+    : _cells(cells)
+    , _width(width)
+    , _height(height)
+    , _endX(endX)
+    , _endY(endY) {
+}
+
+bool JumpPointSearch::isWalkable(int x, int y) const {
+    if (x < 0 || x >= _width || y < 0 || y >= _height) return false;
+    return _cells[y * _width + x] == 0;
+}
+
+// ===================================================================================
+// 跳跃扫描
+// ===================================================================================
+
+bool JumpPointSearch::jump(int x, int y, int dx, int dy, int& outX, int& outY) const {
+    while (true) {
+        x += dx;
+        y += dy;
+        if (!isWalkable(x, y)) return false;
+
+        if (x == _endX && y == _endY) break;
+
+        if (dx != 0 && dy != 0) {
+            // 斜向：身后一侧被挡住时，斜前方那一格只能经由这里最优到达
+            if ((!isWalkable(x - dx, y) && isWalkable(x - dx, y + dy)) ||
+                (!isWalkable(x, y - dy) && isWalkable(x + dx, y - dy))) {
+                break;
+            }
+
+            // 斜向每走一步都要先沿两个分量方向试跳，有跳点则当前格也是跳点
+            int jx, jy;
+            if (jump(x, y, dx, 0, jx, jy) || jump(x, y, 0, dy, jx, jy)) break;
+        } else if (dx != 0) {
+            // 水平：上下侧被挡住而斜前方可走
+            if ((!isWalkable(x, y + 1) && isWalkable(x + dx, y + 1)) ||
+                (!isWalkable(x, y - 1) && isWalkable(x + dx, y - 1))) {
+                break;
+            }
+        } else {
+            // 垂直：左右侧被挡住而斜前方可走
+            if ((!isWalkable(x + 1, y) && isWalkable(x + 1, y + dy)) ||
+                (!isWalkable(x - 1, y) && isWalkable(x - 1, y + dy))) {
+                break;
+            }
+        }
+    }
+
+    outX = x;
+    outY = y;
+    return true;
+}
+
+// ===================================================================================
+// 邻居剪枝
+// ===================================================================================
+
+int JumpPointSearch::collectDirections(int x, int y, int dx, int dy, int outDirs[8][2]) const {
+    int count = 0;
+    auto add = [&](int ddx, int ddy) {
+        outDirs[count][0] = ddx;
+        outDirs[count][1] = ddy;
+        count++;
+    };
+
+    if (dx == 0 && dy == 0) {
+        // 起点：8方向全部搜索
+        for (int ddy = -1; ddy <= 1; ++ddy) {
+            for (int ddx = -1; ddx <= 1; ++ddx) {
+                if (ddx != 0 || ddy != 0) add(ddx, ddy);
+            }
+        }
+        return count;
+    }
+
+    if (dx != 0 && dy != 0) {
+        // 自然邻居：两个分量方向 + 原斜向
+        add(dx, 0);
+        add(0, dy);
+        add(dx, dy);
+        // 强迫邻居
+        if (!isWalkable(x - dx, y)) add(-dx, dy);
+        if (!isWalkable(x, y - dy)) add(dx, -dy);
+    } else if (dx != 0) {
+        add(dx, 0);
+        if (!isWalkable(x, y + 1)) add(dx, 1);
+        if (!isWalkable(x, y - 1)) add(dx, -1);
+    } else {
+        add(0, dy);
+        if (!isWalkable(x + 1, y)) add(1, dy);
+        if (!isWalkable(x - 1, y)) add(-1, dy);
+    }
+    return count;
+}
+
+// ===================================================================================
+// 主搜索
+// ===================================================================================
+
+bool JumpPointSearch::findPath(const std::vector<uint8_t>& cells, int width, int height,
+                               int startX, int startY, int endX, int endY,
+                               std::vector<int>& outPath) {
+    outPath.clear();
+
+    JumpPointSearch search(cells, width, height, endX, endY);
+    if (!search.isWalkable(startX, startY) || !search.isWalkable(endX, endY)) return false;
+    if (startX == endX && startY == endY) return false;
+
+    PathSearchContext& ctx = PathSearchContext::current();
+    ctx.beginQuery(width * height);
+
+    int startIndex = startY * width + startX;
+    int endIndex = endY * width + endX;
+    ctx.touch(startIndex).g = 0;
+    ctx.pushOrDecrease(startIndex, octile(startX, startY, endX, endY));
+
+    bool found = false;
+    int dirs[8][2];
+
+    while (!ctx.isOpenEmpty()) {
+        int currIndex = ctx.popMin();
+        if (currIndex == endIndex) {
+            found = true;
+            break;
+        }
+
+        int cx = currIndex % width;
+        int cy = currIndex / width;
+        const PathSearchContext::Node& current = ctx.touch(currIndex);
+        int currentG = current.g;
+
+        // 来向由前驱跳点推出（跳点之间一定是纯直线或纯斜线）
+        int dx = 0, dy = 0;
+        if (current.parent != -1) {
+            dx = sign(cx - current.parent % width);
+            dy = sign(cy - current.parent / width);
+        }
+
+        int dirCount = search.collectDirections(cx, cy, dx, dy, dirs);
+        for (int i = 0; i < dirCount; ++i) {
+            int jx, jy;
+            if (!search.jump(cx, cy, dirs[i][0], dirs[i][1], jx, jy)) continue;
+
+            int jumpIndex = jy * width + jx;
+            PathSearchContext::Node& node = ctx.touch(jumpIndex);
+            if (node.closed) continue;
+
+            int tentativeG = currentG + octile(cx, cy, jx, jy);
+            if (tentativeG < node.g) {
+                node.g = tentativeG;
+                node.parent = currIndex;
+                ctx.pushOrDecrease(jumpIndex, tentativeG + octile(jx, jy, endX, endY));
+            }
+        }
+    }
+
+    if (found) {
+        // 回溯跳点，并把每段展开成逐格路径
+        int traceIndex = endIndex;
+        outPath.push_back(traceIndex);
+        while (true) {
+            int parent = ctx.touch(traceIndex).parent;
+            if (parent == -1) break;
+
+            int x = traceIndex % width, y = traceIndex / width;
+            int px = parent % width, py = parent / width;
+            int stepX = sign(px - x), stepY = sign(py - y);
+            while (x != px || y != py) {
+                x += stepX;
+                y += stepY;
+                outPath.push_back(y * width + x);
+            }
+            traceIndex = parent;
+        }
+        std::reverse(outPath.begin(), outPath.end());
+    }
+
+    ctx.endQuery();
+    return found;
+}
@@ -0,0 +1,56 @@
+﻿// JumpPointSearch.h
+// 跳点搜索（JPS）声明，在均匀代价的8方向网格上跳过对称路径，只展开跳点
+
+#ifndef __JUMP_POINT_SEARCH_H__
+#define __JUMP_POINT_SEARCH_H__
+
+#include <vector>
+#include <cstdint>
+
+/**
+ * @brief 跳点搜索（Jump Point Search）
+ *
+ * 原理：
+ * 1. 空地上大量路径代价相同（先斜后直 / 先直后斜），A* 会把它们全部展开
+ * 2. JPS 沿当前方向"跳跃"扫描，只有遇到终点或强迫邻居（旁边有障碍导致
+ *    绕行变成唯一最优走法）时才停下来作为跳点入堆
+ * 3. 展开跳点时按来向剪枝，只保留自然邻居和强迫邻居
+ *
+ * 移动规则与 FindPathUtil::aStarSearch 完全一致：8方向、直线10/对角14、
+ * 允许斜穿障碍角。因此得到的路径代价与 A* 相同（都是最优），
+ * 只是在代价相同的多条路径中可能选择不同的一条。
+ *
+ * 开放列表和节点池复用当前线程的 PathSearchContext，统计信息同样记录在其中。
+ * 本类不依赖引擎，格子值为 0 表示可通行。
+ */
+class JumpPointSearch {
+public:
+    /**
+     * @brief 跳点搜索
+     * @param cells 网格数据（0 = 可通行）
+     * @param outPath 输出逐格的格子索引序列（含起点和终点）
+     * @return 是否找到路径
+     */
+    static bool findPath(const std::vector<uint8_t>& cells, int width, int height,
+                         int startX, int startY, int endX, int endY,
+                         std::vector<int>& outPath);
+
+private:
+    const std::vector<uint8_t>& _cells;
+    int _width;
+    int _height;
+    int _endX;
+    int _endY;
+
+    JumpPointSearch(const std::vector<uint8_t>& cells, int width, int height, int endX, int endY);
+
+    bool isWalkable(int x, int y) const;
+
+    // 从 (x, y) 沿 (dx, dy) 跳跃，找到跳点返回 true 并写入 outX/outY
+    bool jump(int x, int y, int dx, int dy, int& outX, int& outY) const;
+
+    // 按来向收集剪枝后的搜索方向（dx = dy = 0 表示起点，8方向全部保留）
+    int collectDirections(int x, int y, int dx, int dy, int outDirs[8][2]) const;
+};
+
+#endif // __JUMP_POINT_SEARCH_H__
@@ -0,0 +1,162 @@
+﻿// PathPlanningQueue.cpp
+// 分帧路线规划队列实现：预算控制、断点续搜和完成回调
+
+#include "PathPlanningQueue.h"
+#include "GridMapUtils.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+
+USING_NS_CC;
+
+PathPlanningQueue* PathPlanningQueue::_instance = nullptr;
+
+PathPlanningQueue* PathPlanningQueue::getInstance() {
+    if (!_instance) _instance = new PathPlanningQueue();
+    return _instance;
+}
+
+void PathPlanningQueue::destroyInstance() {
+    CC_SAFE_DELETE(_instance);
+}
+
+PathPlanningQueue::PathPlanningQueue()
+    : _nextRequestId(1)
+    , _frame(0) {
+
+    _stats.expansionBudget = DEFAULT_EXPANSION_BUDGET;
+
+    Director::getInstance()->getScheduler()->schedule(
+        [this](float dt) { this->update(dt); },
+        this,
+        0.0f,
+        false,
+        "path_planning_queue_update"
+    );
+}
+
+PathPlanningQueue::~PathPlanningQueue() {
+    Director::getInstance()->getScheduler()->unschedule("path_planning_queue_update", this);
+}
+
+void PathPlanningQueue::setBudget(int maxExpansions) {
+    _stats.expansionBudget = std::max(maxExpansions, 1);
+}
+
+// ===================================================================================
+// 请求与取消
+// ===================================================================================
+
+int PathPlanningQueue::enqueueAttackPlan(const Vec2& unitWorldPos, const BuildingInstance& building,
+                                         int attackRange, int damagePerHit, const PlanCallback& callback) {
+    auto pathfinder = FindPathUtil::getInstance();
+
+    AttackArea area;
+    if (!pathfinder->makeAttackArea(building, attackRange, area)) return 0;
+
+    Vec2 startGridPos = GridMapUtils::pixelToGrid(unitWorldPos);
+    int startX = static_cast<int>(std::floor(startGridPos.x));
+    int startY = static_cast<int>(std::floor(startGridPos.y));
+
+    std::unique_ptr<Request> request(new Request());
+    request->requestId = _nextRequestId++;
+    request->enqueueFrame = _frame;
+    request->snapshot = pathfinder->getGridSnapshot();
+    request->attackRange = attackRange;
+    request->callback = callback;
+
+    if (_freeContexts.empty()) {
+        request->context.reset(new PathSearchContext());
+    } else {
+        request->context = std::move(_freeContexts.back());
+        _freeContexts.pop_back();
+    }
+
+    request->search.reset(new AttackPlanSearch(request->snapshot->view(), area, startX, startY,
+                                               std::max(damagePerHit, 1), *request->context));
+
+    int requestId = request->requestId;
+    _requests.push_back(std::move(request));
+    _stats.queueDepth = getQueueDepth();
+    return requestId;
+}
+
+void PathPlanningQueue::cancel(int requestId) {
+    for (auto it = _requests.begin(); it != _requests.end(); ++it) {
+        if ((*it)->requestId == requestId) {
+            recycle(**it);
+            _requests.erase(it);
+            break;
+        }
+    }
+    _stats.queueDepth = getQueueDepth();
+}
+
+void PathPlanningQueue::cancelAll() {
+    for (auto& request : _requests) {
+        recycle(*request);
+    }
+    _requests.clear();
+    _stats.queueDepth = 0;
+}
+
+void PathPlanningQueue::recycle(Request& request) {
+    request.search.reset();
+    if (request.context) {
+        _freeContexts.push_back(std::move(request.context));
+    }
+}
+
+// ===================================================================================
+// 每帧推进
+// ===================================================================================
+
+void PathPlanningQueue::update(float) {
+    typedef std::chrono::steady_clock Clock;
+    auto frameStart = Clock::now();
+
+    _frame++;
+
+    int expanded = 0;
+    int completed = 0;
+    int maxWait = 0;
+
+    while (!_requests.empty()) {
+        if (expanded >= _stats.expansionBudget) break;
+
+        // 队首即等待最久的请求（未完成的搜索留在队首）
+        Request& request = *_requests.front();
+        int before = request.search->getExpanded();
+        int slice = std::min(SLICE_EXPANSIONS, _stats.expansionBudget - expanded);
+        AttackPlanSearch::Status status = request.search->step(slice);
+        expanded += request.search->getExpanded() - before;
+
+        if (status == AttackPlanSearch::Status::RUNNING) continue;
+
+        bool found = (status == AttackPlanSearch::Status::FOUND);
+        FindPathUtil::WallBreakPlan plan;
+        if (found) {
+            std::vector<int> cells;
+            request.search->getPath(cells);
+            FindPathUtil::buildWallBreakPlan(request.snapshot->view(), cells, request.attackRange, plan);
+            plan.totalCost = request.search->getCost();
+        }
+
+        maxWait = std::max(maxWait, static_cast<int>(_frame - request.enqueueFrame));
+        completed++;
+
+        // 先出队再回调，回调中可以排入新请求
+        PlanCallback callback = request.callback;
+        recycle(request);
+        _requests.pop_front();
+        callback(found, plan);
+    }
+
+    _stats.queueDepth = getQueueDepth();
+    _stats.expansionsLastFrame = expanded;
+    _stats.microsLastFrame = std::chrono::duration<double, std::micro>(Clock::now() - frameStart).count();
+    _stats.completedLastFrame = completed;
+    _stats.maxWaitFrames = maxWait;
+    _stats.totalCompleted += completed;
+    _stats.totalExpanded += expanded;
+}
@@ -0,0 +1,117 @@
+﻿// PathPlanningQueue.h
+// 分帧路线规划队列声明：按等待时间排队，每帧在节点预算内推进搜索，未完成的搜索下一帧继续
+
+#ifndef __PATH_PLANNING_QUEUE_H__
+#define __PATH_PLANNING_QUEUE_H__
+
+#include "cocos2d.h"
+#include "FindPathUtil.h"
+#include <deque>
+#include <memory>
+#include <vector>
+
+/**
+ * @brief 分帧规划统计
+ */
+struct PathPlanningQueueStats {
+    int queueDepth;                 // 当前排队（含进行中）的请求数
+    int expansionsLastFrame;        // 上一帧展开的节点数
+    double microsLastFrame;         // 上一帧规划耗时（微秒，仅统计，不参与预算判断）
+    int completedLastFrame;         // 上一帧完成的请求数
+    int maxWaitFrames;              // 上一帧完成的请求中最长的等待帧数
+
+    int expansionBudget;            // 每帧节点预算
+
+    long long totalCompleted;       // 累计完成请求数
+    long long totalExpanded;        // 累计展开节点数
+
+    PathPlanningQueueStats()
+        : queueDepth(0)
+        , expansionsLastFrame(0)
+        , microsLastFrame(0.0)
+        , completedLastFrame(0)
+        , maxWaitFrames(0)
+        , expansionBudget(0)
+        , totalCompleted(0)
+        , totalExpanded(0) {}
+};
+
+/**
+ * @brief 分帧路线规划队列（单例，仅主线程）
+ *
+ * 工作方式：
+ * 1. enqueueAttackPlan() 为请求取地图快照、创建可分段执行的 AttackPlanSearch，放入队尾
+ * 2. 每帧从队首（等待最久的请求）开始推进搜索，
+ *    每推进 SLICE_EXPANSIONS 个节点检查一次预算，节点数用尽即停止
+ * 3. 未完成的搜索保留在队首，下一帧继续，因此不会被后来的请求插队
+ * 4. 完成的请求在当帧回调
+ *
+ * 一大批单位同时重新规划（例如大型建筑被摧毁）时，
+ * 每帧的寻路开销被限制在预算内，代价是部分单位晚几帧拿到路线。
+ *
+ * 预算只按展开节点数计算：同样的请求序列每帧推进的进度相同，与设备快慢无关。
+ * 耗时只作为统计（microsLastFrame）上报。
+ */
+class PathPlanningQueue {
+public:
+    typedef FindPathUtil::AttackPlanCallback PlanCallback;
+
+    // 默认每帧节点预算
+    static const int DEFAULT_EXPANSION_BUDGET = 4000;
+
+    // 每次检查预算之间推进的节点数
+    static const int SLICE_EXPANSIONS = 256;
+
+    static PathPlanningQueue* getInstance();
+    static void destroyInstance();
+
+    /**
+     * @brief 排队一个破墙路线规划请求
+     * @return 请求ID（> 0）；建筑配置缺失时返回 0 且不会回调
+     */
+    int enqueueAttackPlan(const cocos2d::Vec2& unitWorldPos, const BuildingInstance& targetBuilding,
+                          int attackRange, int damagePerHit, const PlanCallback& callback);
+
+    // 取消请求（不会再回调）
+    void cancel(int requestId);
+
+    // 取消全部请求
+    void cancelAll();
+
+    // 设置每帧节点预算
+    void setBudget(int maxExpansions);
+
+    int getQueueDepth() const { return static_cast<int>(_requests.size()); }
+    const PathPlanningQueueStats& getStats() const { return _stats; }
+
+private:
+    PathPlanningQueue();
+    ~PathPlanningQueue();
+
+    static PathPlanningQueue* _instance;
+
+    struct Request {
+        int requestId;
+        unsigned int enqueueFrame;                                      // 入队时的帧号
+        std::shared_ptr<const FindPathUtil::GridSnapshot> snapshot;     // 跨帧搜索期间地图保持一致
+        std::unique_ptr<PathSearchContext> context;                     // 每个进行中的搜索独占一个上下文
+        std::unique_ptr<AttackPlanSearch> search;
+        int attackRange;
+        PlanCallback callback;
+    };
+
+    std::deque<std::unique_ptr<Request>> _requests;
+    std::vector<std::unique_ptr<PathSearchContext>> _freeContexts;     // 复用的搜索上下文
+    int _nextRequestId;
+    unsigned int _frame;
+
+    PathPlanningQueueStats _stats;
+
+    // 每帧推进搜索
+    void update(float dt);
+
+    // 请求结束后回收其搜索上下文
+    void recycle(Request& request);
+};
+
+#endif // __PATH_PLANNING_QUEUE_H__
@@ -0,0 +1,131 @@
+﻿// PathSearchContext.cpp
+// 寻路搜索上下文实现，包含代数复用的节点池和带降键操作的 4 叉堆
+
+#include "PathSearchContext.h"
+
+PathSearchContext& PathSearchContext::current() {
+    static thread_local PathSearchContext context;
+    return context;
+}
+
+PathSearchContext::PathSearchContext()
+    : _generation(0) {
+}
+
+// ===================================================================================
+// 查询生命周期
+// ===================================================================================
+
+void PathSearchContext::beginQuery(int cellCount) {
+    if (static_cast<int>(_nodes.size()) < cellCount) {
+        Node blank = { INT_MAX, INT_MAX, -1, -1, 0, false };
+        _nodes.resize(cellCount, blank);
+    }
+
+    // 代数回绕时才真正清空一次节点池
+    if (++_generation == 0) {
+        for (auto& node : _nodes) node.generation = 0;
+        _generation = 1;
+    }
+
+    _heap.clear();
+    _stats.nodesExpanded = 0;
+    _stats.nodesPushed = 0;
+    _queryStart = std::chrono::steady_clock::now();
+}
+
+void PathSearchContext::endQuery() {
+    auto elapsed = std::chrono::steady_clock::now() - _queryStart;
+    _stats.elapsedMicros = std::chrono::duration<double, std::micro>(elapsed).count();
+
+    _stats.totalQueries++;
+    _stats.totalExpanded += _stats.nodesExpanded;
+    _stats.totalMicros += _stats.elapsedMicros;
+}
+
+PathSearchContext::Node& PathSearchContext::touch(int index) {
+    Node& node = _nodes[index];
+    if (node.generation != _generation) {
+        node.g = INT_MAX;
+        node.f = INT_MAX;
+        node.parent = -1;
+        node.heapIndex = -1;
+        node.generation = _generation;
+        node.closed = false;
+    }
+    return node;
+}
+
+// ===================================================================================
+// 带索引的 4 叉堆
+// ===================================================================================
+
+void PathSearchContext::pushOrDecrease(int index, int f) {
+    Node& node = touch(index);
+    node.f = f;
+    _stats.nodesPushed++;
+
+    if (node.heapIndex == -1) {
+        _heap.push_back(index);
+        node.heapIndex = static_cast<int>(_heap.size()) - 1;
+    }
+    siftUp(node.heapIndex);
+}
+
+int PathSearchContext::popMin() {
+    int top = _heap.front();
+    int last = _heap.back();
+    _heap.pop_back();
+
+    if (!_heap.empty()) {
+        placeAt(0, last);
+        siftDown(0);
+    }
+
+    Node& node = _nodes[top];
+    node.heapIndex = -1;
+    node.closed = true;
+    _stats.nodesExpanded++;
+    return top;
+}
+
+void PathSearchContext::placeAt(int position, int index) {
+    _heap[position] = index;
+    _nodes[index].heapIndex = position;
+}
+
+void PathSearchContext::siftUp(int position) {
+    int index = _heap[position];
+    int f = _nodes[index].f;
+
+    while (position > 0) {
+        int parent = (position - 1) / HEAP_ARITY;
+        if (_nodes[_heap[parent]].f <= f) break;
+        placeAt(position, _heap[parent]);
+        position = parent;
+    }
+    placeAt(position, index);
+}
+
+void PathSearchContext::siftDown(int position) {
+    int size = static_cast<int>(_heap.size());
+    int index = _heap[position];
+    int f = _nodes[index].f;
+
+    while (true) {
+        int firstChild = position * HEAP_ARITY + 1;
+        if (firstChild >= size) break;
+
+        // 在最多4个子节点中找最小的
+        int best = firstChild;
+        int lastChild = firstChild + HEAP_ARITY < size ? firstChild + HEAP_ARITY : size;
+        for (int child = firstChild + 1; child < lastChild; ++child) {
+            if (_nodes[_heap[child]].f < _nodes[_heap[best]].f) best = child;
+        }
+
+        if (_nodes[_heap[best]].f >= f) break;
+        placeAt(position, _heap[best]);
+        position = best;
+    }
+    placeAt(position, index);
+}
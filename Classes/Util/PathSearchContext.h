@@ -0,0 +1,105 @@
+﻿// PathSearchContext.h
+// 寻路搜索上下文声明，提供按代数复用的节点池、带索引的 d 叉堆和每线程的统计信息
+
+#ifndef __PATH_SEARCH_CONTEXT_H__
+#define __PATH_SEARCH_CONTEXT_H__
+
+#include <vector>
+#include <cstdint>
+#include <climits>
+#include <chrono>
+
+/**
+ * @brief 单次/累计的寻路统计
+ */
+struct PathSearchStats {
+    int nodesExpanded;          // 最近一次查询展开（出堆）的节点数
+    int nodesPushed;            // 最近一次查询入堆/降键次数
+    double elapsedMicros;       // 最近一次查询耗时（微秒）
+
+    long long totalQueries;     // 累计查询次数
+    long long totalExpanded;    // 累计展开节点数
+    double totalMicros;         // 累计耗时（微秒）
+
+    PathSearchStats()
+        : nodesExpanded(0)
+        , nodesPushed(0)
+        , elapsedMicros(0.0)
+        , totalQueries(0)
+        , totalExpanded(0)
+        , totalMicros(0.0) {}
+};
+
+/**
+ * @brief 寻路搜索上下文（每线程一份）
+ *
+ * 设计要点：
+ * 1. 节点池：按格子索引的连续数组，每个节点记录所属的搜索代数，
+ *    代数不等于当前代数即视为未访问，开始新查询只需代数 +1，无需清空数组
+ * 2. 开放列表：4 叉最小堆，节点记录自己在堆中的位置，支持 O(log n) 降键，
+ *    堆里不会出现重复节点
+ * 3. 每个线程通过 current() 拿到自己的上下文，多个线程可以同时搜索
+ *
+ * 使用方式：
+ *   auto& ctx = PathSearchContext::current();
+ *   ctx.beginQuery(cellCount);
+ *   ctx.touch(start).g = 0; ctx.pushOrDecrease(start, h);
+ *   while (!ctx.isOpenEmpty()) { int cur = ctx.popMin(); ... }
+ *   ctx.endQuery();
+ */
+class PathSearchContext {
+public:
+    struct Node {
+        int g;                  // 起点到该节点的代价
+        int f;                  // 堆排序键（g + h）
+        int parent;             // 回溯用的前驱格子索引
+        int heapIndex;          // 在堆中的位置，-1 表示不在堆中
+        uint32_t generation;    // 所属搜索代数
+        bool closed;            // 是否已展开
+    };
+
+    // 获取当前线程的上下文
+    static PathSearchContext& current();
+
+    // 需要同时保留多个未完成的搜索（如分帧规划）时，每个搜索自带一个上下文
+    PathSearchContext();
+
+    // 开始一次查询：按需扩容节点池并递增代数
+    void beginQuery(int cellCount);
+
+    // 结束查询：记录耗时并累加统计
+    void endQuery();
+
+    // 取节点；本次查询第一次访问时初始化
+    Node& touch(int index);
+
+    // 节点在本次查询中是否已被访问
+    bool isTouched(int index) const { return _nodes[index].generation == _generation; }
+
+    // 入堆或降键（f 只会变小）
+    void pushOrDecrease(int index, int f);
+
+    // 弹出 f 最小的节点，并标记为已展开
+    int popMin();
+
+    bool isOpenEmpty() const { return _heap.empty(); }
+
+    const PathSearchStats& getStats() const { return _stats; }
+    void resetStats() { _stats = PathSearchStats(); }
+
+private:
+    static const int HEAP_ARITY = 4;
+
+    std::vector<Node> _nodes;
+    std::vector<int> _heap;
+    uint32_t _generation;
+
+    PathSearchStats _stats;
+    std::chrono::steady_clock::time_point _queryStart;
+
+    void siftUp(int position);
+    void siftDown(int position);
+    void placeAt(int position, int index);
+};
+
+#endif // __PATH_SEARCH_CONTEXT_H__
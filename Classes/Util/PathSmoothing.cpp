@@ -0,0 +1,68 @@
+﻿// PathSmoothing.cpp
+// 路径平滑实现：超覆盖视线检测和贪心拉直
+
+#include "PathSmoothing.h"
+#include <cstdlib>
+
+bool PathSmoothing::hasLineOfSight(const PathGridView& grid, int x0, int y0, int x1, int y1, bool allowWalls) {
+    int dx = std::abs(x1 - x0);
+    int dy = std::abs(y1 - y0);
+    int sx = (x1 > x0) ? 1 : -1;
+    int sy = (y1 > y0) ? 1 : -1;
+
+    int x = x0;
+    int y = y0;
+
+    // error > 0：下一次先穿过竖直格线；< 0：先穿过水平格线；== 0：恰好穿过角点
+    int error = dx - dy;
+    dx *= 2;
+    dy *= 2;
+
+    for (int n = 1 + std::abs(x1 - x0) + std::abs(y1 - y0); n > 0; --n) {
+        if (!grid.isPassable(x, y, allowWalls)) return false;
+
+        if (error > 0) {
+            x += sx;
+            error -= dy;
+        } else if (error < 0) {
+            y += sy;
+            error += dx;
+        } else {
+            // 穿过角点：两侧格子都要可通行，然后斜进一格
+            if (!grid.isPassable(x + sx, y, allowWalls) || !grid.isPassable(x, y + sy, allowWalls)) return false;
+            x += sx;
+            y += sy;
+            error += dx - dy;
+            --n;
+        }
+    }
+
+    return true;
+}
+
+void PathSmoothing::stringPull(const PathGridView& grid, const std::vector<int>& cells, bool allowWalls,
+                               std::vector<int>& outCells) {
+    outCells.clear();
+    if (cells.empty()) return;
+
+    int width = grid.width;
+    outCells.push_back(cells[0]);
+
+    size_t anchor = 0;
+    for (size_t k = 1; k < cells.size(); ++k) {
+        // 终点总是保留
+        if (k + 1 == cells.size()) {
+            outCells.push_back(cells[k]);
+            break;
+        }
+
+        // 锚点能直接看到下一格：当前格不是拐点
+        int next = cells[k + 1];
+        if (hasLineOfSight(grid, cells[anchor] % width, cells[anchor] / width, next % width, next / width, allowWalls)) {
+            continue;
+        }
+
+        outCells.push_back(cells[k]);
+        anchor = k;
+    }
+}
@@ -0,0 +1,42 @@
+﻿// PathSmoothing.h
+// 路径平滑声明：在网格上做视线检测（超覆盖 Bresenham），把逐格路径拉直为只含拐点的折线
+
+#ifndef __PATH_SMOOTHING_H__
+#define __PATH_SMOOTHING_H__
+
+#include "AttackPlanSearch.h"
+#include <vector>
+
+/**
+ * @brief 路径拉直（String Pulling）
+ *
+ * 网格搜索返回的是逐格路径，单位照着走会沿 45° 锯齿前进，
+ * 而且每个格子都要生成一组移动动作。
+ *
+ * 做法：从当前锚点出发，只要能直线看到路径上的下一格就继续向后看，
+ * 看不到时把上一格作为拐点保留并设为新锚点。结果只保留起点、拐点和终点。
+ *
+ * 视线检测沿两格中心连线逐格检查线段经过的所有格子（超覆盖），
+ * 线段恰好穿过格子角点时两侧格子都必须可通行，不会比原路径更贴近障碍。
+ * 网格到世界坐标是仿射变换，网格上的直线在世界坐标中仍是直线。
+ *
+ * 本类不依赖引擎，可在任意线程调用。
+ */
+class PathSmoothing {
+public:
+    /**
+     * @brief 两格中心连线上的格子是否全部可通行
+     * @param allowWalls 城墙格是否视为可通行（破墙/炸弹人路线）
+     */
+    static bool hasLineOfSight(const PathGridView& grid, int x0, int y0, int x1, int y1, bool allowWalls);
+
+    /**
+     * @brief 拉直逐格路径
+     * @param cells 逐格的格子索引序列（含起点），相邻两格必须互相可达
+     * @param outCells 输出起点、拐点和终点
+     */
+    static void stringPull(const PathGridView& grid, const std::vector<int>& cells, bool allowWalls,
+                           std::vector<int>& outCells);
+};
+
+#endif // __PATH_SMOOTHING_H__
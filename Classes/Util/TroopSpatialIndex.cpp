@@ -0,0 +1,117 @@
+﻿// TroopSpatialIndex.cpp
+// 兵种空间索引实现：按格计数排序建桶和矩形范围查询
+
+#include "TroopSpatialIndex.h"
+#include "FindPathUtil.h"
+#include "../Sprite/BattleUnitSprite.h"
+#include <algorithm>
+#include <cmath>
+
+USING_NS_CC;
+
+TroopSpatialIndex* TroopSpatialIndex::_instance = nullptr;
+
+TroopSpatialIndex* TroopSpatialIndex::getInstance() {
+    if (!_instance) {
+        _instance = new TroopSpatialIndex();
+    }
+    return _instance;
+}
+
+void TroopSpatialIndex::destroyInstance() {
+    CC_SAFE_DELETE(_instance);
+}
+
+TroopSpatialIndex::TroopSpatialIndex()
+    : _width(0)
+    , _height(0)
+    , _outsideStart(0) {
+}
+
+void TroopSpatialIndex::clear() {
+    _entries.clear();
+    _cellStart.assign(_width * _height + 1, 0);
+    _outsideStart = 0;
+}
+
+void TroopSpatialIndex::rebuild(const std::vector<BattleUnitSprite*>& units) {
+    // 网格尺寸跟随寻路地图（战斗地图可大于 44x44）
+    auto pathfinder = FindPathUtil::getInstance();
+    _width = pathfinder->getMapWidth();
+    _height = pathfinder->getMapHeight();
+    int cellCount = _width * _height;
+
+    _scratch.clear();
+
+    for (size_t i = 0; i < units.size(); ++i) {
+        BattleUnitSprite* unit = units[i];
+        if (!unit || unit->isDead()) continue;
+
+        TroopEntry entry;
+        entry.unit = unit;
+        entry.handle = unit->getHandle();
+        entry.order = static_cast<int>(i);
+        entry.gridPos = unit->getGridPosition();
+        entry.cellX = static_cast<int>(std::floor(entry.gridPos.x));
+        entry.cellY = static_cast<int>(std::floor(entry.gridPos.y));
+        entry.isAir = (unit->getUnitTypeID() == UnitTypeID::BALLOON);
+
+        _scratch.push_back(entry);
+    }
+
+    // 计数排序：先统计每格单位数，再转成起始位置（地图外的单位用最后一个槽）
+    _cellStart.assign(cellCount + 2, 0);
+    auto slotOf = [this, cellCount](const TroopEntry& entry) {
+        if (entry.cellX < 0 || entry.cellX >= _width || entry.cellY < 0 || entry.cellY >= _height) {
+            return cellCount;
+        }
+        return entry.cellY * _width + entry.cellX;
+    };
+
+    for (const auto& entry : _scratch) {
+        _cellStart[slotOf(entry) + 1]++;
+    }
+    for (int slot = 0; slot <= cellCount; ++slot) {
+        _cellStart[slot + 1] += _cellStart[slot];
+    }
+
+    // 同一格内保持单位列表顺序
+    _entries.resize(_scratch.size());
+    _cursor.assign(_cellStart.begin(), _cellStart.end() - 1);
+    for (const auto& entry : _scratch) {
+        _entries[_cursor[slotOf(entry)]++] = entry;
+    }
+
+    _outsideStart = _cellStart[cellCount];
+    _cellStart.resize(cellCount + 1);
+}
+
+void TroopSpatialIndex::queryRect(int minX, int minY, int maxX, int maxY, int layerMask,
+                                  std::vector<const TroopEntry*>& out) const {
+    out.clear();
+
+    auto matches = [layerMask](const TroopEntry& entry) {
+        return (layerMask & (entry.isAir ? LAYER_AIR : LAYER_GROUND)) != 0;
+    };
+
+    int x0 = std::max(minX, 0);
+    int y0 = std::max(minY, 0);
+    int x1 = std::min(maxX, _width - 1);
+    int y1 = std::min(maxY, _height - 1);
+
+    for (int y = y0; x0 <= x1 && y <= y1; ++y) {
+        // 同一行相邻格子在 _entries 中也相邻，整段扫描
+        int begin = _cellStart[y * _width + x0];
+        int end = _cellStart[y * _width + x1 + 1];
+        for (int k = begin; k < end; ++k) {
+            if (matches(_entries[k])) out.push_back(&_entries[k]);
+        }
+    }
+
+    // 地图外的单位逐个判断
+    for (int k = _outsideStart; k < static_cast<int>(_entries.size()); ++k) {
+        const TroopEntry& entry = _entries[k];
+        if (entry.cellX < minX || entry.cellX > maxX || entry.cellY < minY || entry.cellY > maxY) continue;
+        if (matches(entry)) out.push_back(&entry);
+    }
+}
@@ -0,0 +1,81 @@
+﻿// TroopSpatialIndex.h
+// 兵种空间索引声明：每帧把所有单位按所在网格分桶，供防御、陷阱等系统做范围查询
+
+#ifndef __TROOP_SPATIAL_INDEX_H__
+#define __TROOP_SPATIAL_INDEX_H__
+
+#include "cocos2d.h"
+#include "../Model/TroopHandle.h"
+#include <vector>
+
+class BattleUnitSprite;
+
+// 索引中的单位
+struct TroopEntry {
+    BattleUnitSprite* unit;
+    TroopHandle handle;         // 跨帧引用单位时保存句柄而不是指针
+    int order;                  // 在兵种层单位列表中的下标，结果需要稳定顺序时比较
+    cocos2d::Vec2 gridPos;      // 网格坐标（可能是小数）
+    int cellX;                  // 所在格（向下取整）
+    int cellY;
+    bool isAir;                 // 飞行单位（气球兵）
+};
+
+/**
+ * @brief 兵种空间索引（单例）
+ *
+ * 每帧在 BattleScene::update 中调用一次 rebuild()，之后同一帧内的查询都不再遍历全部单位：
+ * 1. 单位按所在格做计数排序，每格的单位在 _entries 中连续存放
+ * 2. queryRect() 只访问矩形内的格子，结果写入调用方提供的缓冲，不复制单位列表
+ *
+ * 地图外的单位（刚投放在边缘）单独存放，每次查询都会检查。
+ * 索引只在构建它的这一帧有效：单位可能在帧之间被移除，跨帧请保存 TroopHandle。
+ */
+class TroopSpatialIndex {
+public:
+    // 查询的单位层
+    enum Layer {
+        LAYER_GROUND = 1,
+        LAYER_AIR = 2,
+        LAYER_ALL = LAYER_GROUND | LAYER_AIR
+    };
+
+    static TroopSpatialIndex* getInstance();
+    static void destroyInstance();
+
+    // 按当前单位列表重建索引（跳过已死亡的单位）
+    void rebuild(const std::vector<BattleUnitSprite*>& units);
+
+    // 清空索引（离开战斗时调用，避免持有已释放的单位）
+    void clear();
+
+    /**
+     * @brief 查询所在格落在矩形 [minX, maxX] x [minY, maxY] 内的单位
+     * @param layerMask Layer 的组合
+     * @param out 结果缓冲（先清空）；指针在下一次 rebuild() 前有效
+     */
+    void queryRect(int minX, int minY, int maxX, int maxY, int layerMask,
+                   std::vector<const TroopEntry*>& out) const;
+
+    // 索引中的全部单位
+    const std::vector<TroopEntry>& getEntries() const { return _entries; }
+
+private:
+    TroopSpatialIndex();
+    ~TroopSpatialIndex() = default;
+
+    static TroopSpatialIndex* _instance;
+
+    int _width;
+    int _height;
+
+    std::vector<TroopEntry> _entries;           // 按格子排序的单位（地图外的排在最后）
+    std::vector<int> _cellStart;                // 每格在 _entries 中的起始位置（长度 = 格数 + 1）
+    int _outsideStart;                          // 地图外单位的起始位置
+
+    // 计数排序用的临时缓冲
+    std::vector<TroopEntry> _scratch;
+    std::vector<int> _cursor;
+};
+
+#endif // __TROOP_SPATIAL_INDEX_H__